@@ -21,7 +21,7 @@
 //
 // ============================================================
 //
-// aids — 2.2.0 — std replacement for C++. Designed to aid developers
+// aids — 3.0.0 — std replacement for C++. Designed to aid developers
 // to a better programming experience.
 //
 // https://github.com/rexim/aids
@@ -30,6 +30,68 @@
 //
 // ChangeLog (https://semver.org/ is implied)
 //
+//   3.0.0  Hash_Set keeps the key that is Niche<Key>::none() in Hash_Set::niche_key
+//          Hash_Map stores Compact_Maybe<Hash_Map_Bucket<Key, Value>> buckets
+//          Hash_Map keeps the key that is Niche<Key>::none() in Hash_Map::niche_bucket
+//          add Hash_Map::for_each(), struct Hash_Map_Bucket
+//          Niche<T>::is_none() is false for every T without a niche
+//          add struct Fixed
+//          profile_now() is available without AIDS_PROFILE
+//          Thread_Pool, parallel_*(), futex_*() and Blocking_Queue require AIDS_THREADS
+//          profile_dump_chrome_trace() escapes the zone names as JSON strings
+//          utf8_as_utf32() and utf8_as_utf16() return Maybe<uint32_t*> and Maybe<uint16_t*>
+//          the allocating conversions accept an empty input even if the allocator returns nullptr for it
+//   2.21.0 add struct Hash_Set, set_union(), set_intersection()
+//          add Hash_Map::remove()
+//   2.20.0 add Hash_Map::get_many(), Hash_Map::get_with_hash(), Hash_Map::insert_with_hash()
+//          add prefetch()
+//   2.19.0 add bytes_to_hex(), hex_to_bytes(), bytes_to_base64(), base64_to_bytes(),
+//          bytes_as_hex(), hex_as_bytes(), bytes_as_base64(), base64_as_bytes(),
+//          all four of the allocating ones return Maybe<String_View>
+//          add print1(Print_Buffer *buffer, Hex_Bytes hex_bytes)
+//          print1(FILE *stream, Hex_Bytes hex_bytes) writes all of the bytes with one fwrite()
+//   2.18.0 add struct Json_Escape
+//          print1(Escape) copies the runs without escapes in bulk with SSE2/AVX2
+//   2.17.0 add struct Print_Buffer, struct Print_Max_Size, print1(Print_Buffer*, ...)
+//          print() and println() write all of their arguments with one fwrite()
+//   2.16.1 Hash_Map grows at 3/4 load instead of when completely full
+//          Hash_Map::insert() of an existing key doesn't change the size anymore
+//   2.16.0 add struct Niche, struct Compact_Maybe, compact_some(), as_maybe(), as_compact_maybe()
+//   2.15.0 add Dynamic_Array::grow(), reserve(), resize(), pop(), insert(), remove_at(),
+//          swap_remove(), clear() and the same for Small_Array
+//          fix Dynamic_Array::concat() not making room for the whole batch
+//   2.14.0 add struct Small_Array
+//   2.13.0 add struct SPSC_Queue, struct MPMC_Queue, struct Blocking_Queue
+//   2.12.0 add struct Thread_Pool, thread_pool_of(), hardware_threads_count()
+//          add parallel_for(), parallel_reduce(), parallel_sort(), merge_path()
+//          add futex_wait(), futex_wake_one(), futex_wake_all()
+//   2.11.0 add sort(), stable_sort(), radix_sort(), msd_radix_sort()
+//          add lower_bound(), upper_bound()
+//   2.10.0 add Hash_Map::stats(), struct Hash_Map_Stats, print1(FILE*, const Hash_Map_Stats&)
+//          add Hash_Map::resizes
+//   2.9.0  add AIDS_PROFILE_ZONE(), profile_dump_chrome_trace(), profile_dump_summary()
+//   2.8.1  Fix -Wdeprecated-declarations warnings in String_View::as_integer()
+//   2.8.0  add size_t utf8_length(String_View view)
+//          add utf8_chop_left(), utf8_chop_right(), utf8_subview()
+//          add unicode_to_upper(), unicode_fold_case()
+//          add utf8_to_upper(), utf8_fold_case(), utf8_as_upper(), utf8_as_folded()
+//          Caps uppercases non-ASCII code points
+//          String_View::operator<() compares bytes as unsigned (code point order)
+//   2.7.0  add utf8_to_utf32(), utf8_to_utf16(), utf32_to_utf8(), utf16_to_utf8()
+//          add utf8_as_utf32(), utf8_as_utf16(), utf32_as_utf8(), utf16_as_utf8()
+//          add utf8_length_as_utf32(), utf8_length_as_utf16()
+//          add utf32_length_as_utf8(), utf16_length_as_utf8()
+//   2.6.0  add bool utf8_validate(String_View view)
+//          add AIDS_DISABLE_SIMD
+//          utf8_get_code() rejects overlong sequences, surrogates and codes above 0x10FFFF
+//          fix utf8_get_code() accepting continuation bytes as lead bytes
+//   2.5.0  add struct Piece_Table
+//   2.4.0  add struct Interner
+//          add unsigned long hash(uint32_t x)
+//          fix Dynamic_Array::expand_capacity() copying only `capacity` bytes
+//          fix Dynamic_Array::expand_capacity() leaking the old data
+//   2.3.0  add struct String
+//          add String_View::as_string(Ator *ator)
 //   2.2.0  add TODO(...) macro
 //          add UNREACHABLE(...) macro
 //          deprecate todo() function
@@ -136,6 +198,7 @@
 #ifndef AIDS_HPP_
 #define AIDS_HPP_
 
+#include <atomic>
 #include <cassert>
 #include <cctype>
 #include <cerrno>
@@ -144,6 +207,23 @@
 #include <cstdlib>
 #include <cstring>
 
+// NOTE: define AIDS_DISABLE_SIMD to force the portable scalar
+// implementations even when the target supports SIMD.
+#ifndef AIDS_DISABLE_SIMD
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define AIDS_SSE2
+#    include <emmintrin.h>
+#  endif
+#  if defined(__SSSE3__) || defined(__AVX2__)
+#    define AIDS_SSSE3
+#    include <tmmintrin.h>
+#  endif
+#  if defined(__AVX2__)
+#    define AIDS_AVX2
+#    include <immintrin.h>
+#  endif
+#endif // AIDS_DISABLE_SIMD
+
 namespace aids
 {
 ////////////////////////////////////////////////////////////
@@ -331,10 +411,177 @@ constexpr Maybe<T> some(T x)
         (lvalue) = maybe_var.unwrap;            \
     } while (0)
 
+// NOTE: Niche<T> names a bit pattern that no valid T ever has. When
+// it exists Compact_Maybe<T> stores the pattern in place of the
+// has_value flag and is exactly as big as T. Specialize it for your
+// own types to opt in:
+//
+//     template <>
+//     struct Niche<Entity_Id> {
+//         static constexpr bool exists = true;
+//         static Entity_Id none() { return {UINT32_MAX}; }
+//         static bool is_none(const Entity_Id &x) { return x.index == UINT32_MAX; }
+//     };
+//
+// Without a niche is_none() is false for every value, so the generic
+// code can check for the niche unconditionally.
+template <typename T>
+struct Niche {
+    static constexpr bool exists = false;
+    static bool is_none(const T &) { return false; }
+};
+
+template <typename T>
+struct Niche<T*> {
+    static constexpr bool exists = true;
+    static T *none() { return nullptr; }
+    static bool is_none(T *const &x) { return x == nullptr; }
+};
+
+// NOTE: quiet NaNs with an unusual payload, compared bitwise since NaN
+// never compares equal to itself. Regular NaNs (0/0, sqrt(-1), ...)
+// are still valid values. The payloads do propagate through the
+// arithmetic on x86 though, so a value computed from none() may end
+// up being none() as well. Don't do math on the Nones.
+const uint32_t NICHE_FLOAT_BITS = 0x7FE1D5A5u;
+const uint64_t NICHE_DOUBLE_BITS = 0x7FFC1D5A5D5A5D5Aull;
+
+template <>
+struct Niche<float> {
+    static constexpr bool exists = true;
+
+    static float none()
+    {
+        float x;
+        memcpy(&x, &NICHE_FLOAT_BITS, sizeof(x));
+        return x;
+    }
+
+    static bool is_none(const float &x)
+    {
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        return bits == NICHE_FLOAT_BITS;
+    }
+};
+
+template <>
+struct Niche<double> {
+    static constexpr bool exists = true;
+
+    static double none()
+    {
+        double x;
+        memcpy(&x, &NICHE_DOUBLE_BITS, sizeof(x));
+        return x;
+    }
+
+    static bool is_none(const double &x)
+    {
+        uint64_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        return bits == NICHE_DOUBLE_BITS;
+    }
+};
+
+// NOTE: Maybe<T> keeps its public has_value/unwrap fields, so it can't
+// borrow a niche. Compact_Maybe<T> is the opt-in replacement for
+// storage heavy places. Zero initialization (`= {}`) means None, same
+// as Maybe<T>.
+template <typename T, bool = Niche<T>::exists>
+struct Compact_Maybe {
+    bool engaged;
+    T value;
+
+    bool has_value() const
+    {
+        return engaged;
+    }
+
+    T &unwrap()
+    {
+        return value;
+    }
+
+    const T &unwrap() const
+    {
+        return value;
+    }
+
+    void set(T x)
+    {
+        engaged = true;
+        value = x;
+    }
+
+    void reset()
+    {
+        engaged = false;
+        value = {};
+    }
+};
+
+template <typename T>
+struct Compact_Maybe<T, true> {
+    T value = Niche<T>::none();
+
+    bool has_value() const
+    {
+        return !Niche<T>::is_none(value);
+    }
+
+    T &unwrap()
+    {
+        return value;
+    }
+
+    const T &unwrap() const
+    {
+        return value;
+    }
+
+    void set(T x)
+    {
+        assert(!Niche<T>::is_none(x));
+        value = x;
+    }
+
+    void reset()
+    {
+        value = Niche<T>::none();
+    }
+};
+
+template <typename T>
+Compact_Maybe<T> compact_some(T x)
+{
+    Compact_Maybe<T> result = {};
+    result.set(x);
+    return result;
+}
+
+template <typename T, bool B>
+Maybe<T> as_maybe(const Compact_Maybe<T, B> &maybe)
+{
+    if (!maybe.has_value()) return {};
+    return some(maybe.unwrap());
+}
+
+template <typename T>
+Compact_Maybe<T> as_compact_maybe(Maybe<T> maybe)
+{
+    Compact_Maybe<T> result = {};
+    if (maybe.has_value) result.set(maybe.unwrap);
+    return result;
+}
+
 ////////////////////////////////////////////////////////////
 // STRING_VIEW
 ////////////////////////////////////////////////////////////
 
+template <typename Ator = Mtor>
+struct String;
+
 struct String_View {
     using Predicate_Char = bool (*)(char);
 
@@ -396,7 +643,7 @@ struct String_View {
 
         if (*view.data == '-') {
             sign = -1;
-            view.chop(1);
+            view.chop_left(1);
         }
 
         while (view.count) {
@@ -404,7 +651,7 @@ struct String_View {
                 return {};
             }
             number = number * 10 + (*view.data - '0');
-            view.chop(1);
+            view.chop_left(1);
         }
 
         return { true, number * sign };
@@ -431,6 +678,9 @@ struct String_View {
         }
         return result;
     }
+
+    template <typename Ator = Mtor>
+    String<Ator> as_string(Ator *ator = &mtor) const;
 };
 
 String_View operator ""_sv(const char *data, size_t count);
@@ -438,6 +688,14 @@ String_View cstr_as_string_view(const char *cstr);
 
 void print1(FILE *stream, String_View view);
 
+// NOTE: no valid view spans the whole address space from nullptr.
+template <>
+struct Niche<String_View> {
+    static constexpr bool exists = true;
+    static String_View none() { return {SIZE_MAX, nullptr}; }
+    static bool is_none(const String_View &x) { return x.count == SIZE_MAX && x.data == nullptr; }
+};
+
 template <typename Ator = Mtor>
 Maybe<String_View> read_file_as_string_view(const char *filename,
         Ator *ator = &mtor)
@@ -478,41 +736,125 @@ template <typename... Args>
 
 template <typename T, typename Ator = Mtor>
 struct Dynamic_Array {
+    static constexpr size_t DYNAMIC_ARRAY_INITIAL_CAPACITY = 256;
+
     size_t capacity;
     size_t size;
     T *data;
 
-    void expand_capacity()
+    void reallocate(size_t new_capacity)
     {
-        size_t new_capacity = data ? 2 * capacity : 256;
         T *new_data = mtor.alloc<T>(new_capacity);
 
-        memcpy(new_data, data, capacity);
+        if (data) {
+            memcpy(new_data, data, size * sizeof(T));
+            mtor.dealloc(data, capacity);
+        }
 
         data = new_data;
         capacity = new_capacity;
     }
 
-    void push(T item)
+    void expand_capacity()
+    {
+        reallocate(data ? 2 * capacity : DYNAMIC_ARRAY_INITIAL_CAPACITY);
+    }
+
+    // NOTE: makes room for new_size elements in one allocation, at
+    // least doubling the capacity so the appends stay amortized O(1)
+    void grow(size_t new_size)
+    {
+        if (new_size > capacity) {
+            reallocate(max(new_size, data ? 2 * capacity : DYNAMIC_ARRAY_INITIAL_CAPACITY));
+        }
+    }
+
+    // NOTE: unlike grow() allocates exactly n elements
+    void reserve(size_t n)
+    {
+        if (n > capacity) {
+            reallocate(n);
+        }
+    }
+
+    // NOTE: the new elements are zero-initialized
+    void resize(size_t new_size)
     {
-        while (size + 1 > capacity) {
-            expand_capacity();
+        grow(new_size);
+        for (size_t i = size; i < new_size; ++i) {
+            data[i] = {};
         }
+        size = new_size;
+    }
 
+    void push(T item)
+    {
+        grow(size + 1);
         memcpy(data + size, &item, sizeof(T));
         size += 1;
     }
 
     void concat(const T *items, size_t items_count)
     {
-        while (size + 1 > capacity) {
-            expand_capacity();
-        }
-
+        grow(size + items_count);
         memcpy(data + size, items, sizeof(T) * items_count);
         size += items_count;
     }
 
+    T pop()
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (size == 0) {
+            panic("Dynamic_Array: pop from empty array");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        size -= 1;
+        return data[size];
+    }
+
+    void insert(size_t index, T item)
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index > size) {
+            panic("Dynamic_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        grow(size + 1);
+        memmove(data + index + 1, data + index, (size - index) * sizeof(T));
+        memcpy(data + index, &item, sizeof(T));
+        size += 1;
+    }
+
+    // NOTE: keeps the order of the rest of the elements
+    void remove_at(size_t index)
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index >= size) {
+            panic("Dynamic_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        memmove(data + index, data + index + 1, (size - index - 1) * sizeof(T));
+        size -= 1;
+    }
+
+    // NOTE: O(1), moves the last element into the hole
+    void swap_remove(size_t index)
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index >= size) {
+            panic("Dynamic_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        size -= 1;
+        data[index] = data[size];
+    }
+
+    // NOTE: keeps the capacity
+    void clear()
+    {
+        size = 0;
+    }
+
     bool contains(T item)
     {
         for (size_t i = 0; i < size; ++i) {
@@ -554,924 +896,6194 @@ void destroy(Dynamic_Array<T> dynamic_array)
 }
 
 ////////////////////////////////////////////////////////////
-// ARGS
+// SMALL ARRAY
 ////////////////////////////////////////////////////////////
 
-struct Args {
-    int argc;
-    char **argv;
-
-    char *shift();
-    bool empty();
-};
-
-////////////////////////////////////////////////////////////
-// SPRINT
-////////////////////////////////////////////////////////////
+// NOTE: Small_Array keeps up to N elements inline and only goes to
+// the allocator when it grows beyond that. heap == nullptr means the
+// elements are in storage, so zero-initialized Small_Array is a valid
+// empty array and copying one never leaves a pointer into the
+// original behind. items() points to wherever the elements are now.
+//
+//     Small_Array<int, 8> xs = {};
+//     defer(destroy(xs));
+//     xs.push(69);
+template <typename T, size_t N, typename Ator = Mtor>
+struct Small_Array {
+    static_assert(N > 0, "Small_Array needs at least one inline element");
 
-struct String_Buffer {
     size_t capacity;
-    char *data;
     size_t size;
+    T *heap;
+    T storage[N];
 
-    String_View view() const;
-};
-
-void sprint1(String_Buffer *buffer, const char *cstr);
-void sprint1(String_Buffer *buffer, String_View view);
-void sprint1(String_Buffer *buffer, char c);
-void sprint1(String_Buffer *buffer, float f);
-void sprint1(String_Buffer *buffer, unsigned long long x);
-void sprint1(String_Buffer *buffer, unsigned int x);
-void sprint1(String_Buffer *buffer, long unsigned int x);
-void sprint1(String_Buffer *buffer, int x);
-void sprint1(String_Buffer *buffer, long int x);
-void sprint1(String_Buffer *buffer, bool b);
+    bool is_inline() const
+    {
+        return heap == nullptr;
+    }
 
-template <typename ... Types>
-void sprint(String_Buffer *buffer, Types... args)
-{
-    (sprint1(buffer, args), ...);
-}
+    T *items()
+    {
+        return heap ? heap : storage;
+    }
 
-template <typename T>
-void sprint1(String_Buffer *buffer, Maybe<T> maybe)
-{
-    if (!maybe.has_value) {
-        sprint(buffer, "None");
-    } else {
-        sprint(buffer, "Some(", maybe.unwrap, ")");
+    const T *items() const
+    {
+        return heap ? heap : storage;
     }
-}
 
-template <typename ... Types>
-void sprintln(String_Buffer *buffer, Types... args)
-{
-    (sprint1(buffer, args), ...);
-    sprint1(buffer, '\n');
-}
+    size_t items_capacity() const
+    {
+        return heap ? capacity : N;
+    }
 
-struct Pad {
-    size_t n;
-    char c;
-};
+    void reallocate(size_t new_capacity, Ator *ator = &mtor)
+    {
+        T *new_heap = ator->template alloc<T>(new_capacity);
+        memcpy(new_heap, items(), size * sizeof(T));
 
-void sprint1(String_Buffer *buffer, Pad pad);
+        if (heap) {
+            ator->dealloc(heap, capacity);
+        }
 
-struct Caps {
-    String_View unwrap;
-};
+        heap = new_heap;
+        capacity = new_capacity;
+    }
 
-void sprint1(String_Buffer *buffer, Caps caps);
-void sprint1(String_Buffer *buffer, String_Buffer another_buffer);
+    void expand_capacity(size_t new_capacity, Ator *ator = &mtor)
+    {
+        if (new_capacity > items_capacity()) {
+            reallocate(max(new_capacity, 2 * items_capacity()), ator);
+        }
+    }
 
-struct Escape {
-    String_View unwrap;
-};
+    void reserve(size_t n, Ator *ator = &mtor)
+    {
+        if (n > items_capacity()) {
+            reallocate(n, ator);
+        }
+    }
 
-////////////////////////////////////////////////////////////
-// PRINT
-////////////////////////////////////////////////////////////
+    void resize(size_t new_size, Ator *ator = &mtor)
+    {
+        expand_capacity(new_size, ator);
+        T *xs = items();
+        for (size_t i = size; i < new_size; ++i) {
+            xs[i] = {};
+        }
+        size = new_size;
+    }
 
-void print1(FILE *stream, const char *s);
-void print1(FILE *stream, char *s);
-void print1(FILE *stream, char c);
-void print1(FILE *stream, float f);
-void print1(FILE *stream, unsigned long long x);
-void print1(FILE *stream, long unsigned int x);
-void print1(FILE *stream, unsigned int x);
-void print1(FILE *stream, int x);
-void print1(FILE *stream, long int x);
+    void push(T item, Ator *ator = &mtor)
+    {
+        expand_capacity(size + 1, ator);
+        memcpy(items() + size, &item, sizeof(T));
+        size += 1;
+    }
 
-template <typename ... Types>
-void print(FILE *stream, Types... args)
-{
-    (print1(stream, args), ...);
-}
+    void concat(const T *new_items, size_t items_count, Ator *ator = &mtor)
+    {
+        expand_capacity(size + items_count, ator);
+        memcpy(items() + size, new_items, sizeof(T) * items_count);
+        size += items_count;
+    }
 
-void print1(FILE *stream, bool b);
+    T pop()
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (size == 0) {
+            panic("Small_Array: pop from empty array");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        size -= 1;
+        return items()[size];
+    }
 
-template <typename T>
-void print1(FILE *stream, Maybe<T> maybe)
-{
-    if (!maybe.has_value) {
-        print(stream, "None");
-    } else {
-        print(stream, "Some(", maybe.unwrap, ")");
+    void insert(size_t index, T item, Ator *ator = &mtor)
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index > size) {
+            panic("Small_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        expand_capacity(size + 1, ator);
+        T *xs = items();
+        memmove(xs + index + 1, xs + index, (size - index) * sizeof(T));
+        memcpy(xs + index, &item, sizeof(T));
+        size += 1;
     }
-}
 
-template <typename ... Types>
-void println(FILE *stream, Types... args)
+    void remove_at(size_t index)
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index >= size) {
+            panic("Small_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        T *xs = items();
+        memmove(xs + index, xs + index + 1, (size - index - 1) * sizeof(T));
+        size -= 1;
+    }
+
+    void swap_remove(size_t index)
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index >= size) {
+            panic("Small_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        T *xs = items();
+        size -= 1;
+        xs[index] = xs[size];
+    }
+
+    // NOTE: keeps the heap storage if there is one
+    void clear()
+    {
+        size = 0;
+    }
+
+    bool contains(T item) const
+    {
+        const T *xs = items();
+        for (size_t i = 0; i < size; ++i) {
+            if (item == xs[i]) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    T &operator[](size_t index)
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index >= size) {
+            panic("Small_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        return items()[index];
+    }
+
+    const T &operator[](size_t index) const
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index >= size) {
+            panic("Small_Array: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        return items()[index];
+    }
+};
+
+template <typename T, size_t N, typename Ator = Mtor>
+void destroy(Small_Array<T, N, Ator> small_array, Ator *ator = &mtor)
 {
-    (print1(stream, args), ...);
-    print1(stream, '\n');
+    if (small_array.heap) {
+        ator->dealloc(small_array.heap, small_array.capacity);
+    }
 }
 
-template <typename... Args>
-[[noreturn]] void panic(Args... args)
+////////////////////////////////////////////////////////////
+// SORTING
+////////////////////////////////////////////////////////////
+
+// NOTE: all of the sorts accept either a pointer and a count or a
+// Dynamic_Array, and order the elements ascending according to less
+// (operator< by default).
+//
+// - sort() is an unstable introsort: quicksort with median-of-three
+//   pivots that falls back to heapsort when the recursion gets too
+//   deep and to insertion sort on small ranges. O(n log n) worst case
+//   and no allocations.
+// - stable_sort() is a bottom-up merge sort over insertion sorted
+//   runs. It allocates a temporary buffer of count elements.
+// - radix_sort() is a stable LSD radix sort for integers or for
+//   elements with an unsigned integer key (see radix_sort(data, count,
+//   key)). The passes over the bytes that are the same in all of the
+//   keys are skipped. It allocates a temporary buffer of count
+//   elements.
+// - msd_radix_sort() is a stable MSD radix sort for elements with a
+//   String_View key. It orders the keys the same way as
+//   String_View::operator< does (bytewise unsigned, a prefix goes
+//   first). radix_sort() of String_Views uses it. It allocates a
+//   temporary buffer of count elements.
+//
+// lower_bound() returns the index of the first element that is not
+// less than value, upper_bound() returns the index of the first
+// element that is greater than value. Both are count if there is no
+// such element.
+
+template <typename T>
+struct Less {
+    bool operator()(const T &a, const T &b) const
+    {
+        return a < b;
+    }
+};
+
+constexpr size_t SORT_INSERTION_THRESHOLD = 16;
+
+template <typename T, typename Less_Than>
+void sort_insertion(T *data, size_t count, Less_Than less)
 {
-    println(stderr, args...);
-    exit(1);
+    for (size_t i = 1; i < count; ++i) {
+        if (less(data[i], data[i - 1])) {
+            T x = data[i];
+            size_t j = i;
+            do {
+                data[j] = data[j - 1];
+                j -= 1;
+            } while (j > 0 && less(x, data[j - 1]));
+            data[j] = x;
+        }
+    }
 }
 
-#define UNREACHABLE(...) panic(__FILE__, ":", __LINE__, ": unreachable: ", __VA_ARGS__);
-
-template <typename... Args>
-[[noreturn]] [[deprecated("Use UNREACHABLE macro instead")]] void unreachable(Args... args)
+template <typename T, typename Less_Than>
+void sort_heap_sift_down(T *data, size_t count, size_t root, Less_Than less)
 {
-    panic("Unreachable: ", args...);
+    while (true) {
+        size_t child = 2 * root + 1;
+        if (child >= count) {
+            break;
+        }
+
+        if (child + 1 < count && less(data[child], data[child + 1])) {
+            child += 1;
+        }
+
+        if (!less(data[root], data[child])) {
+            break;
+        }
+
+        swap(&data[root], &data[child]);
+        root = child;
+    }
 }
 
-#define TODO(...) panic(__FILE__, ":", __LINE__, ": TODO: ", __VA_ARGS__)
+template <typename T, typename Less_Than>
+void sort_heap(T *data, size_t count, Less_Than less)
+{
+    for (size_t i = count / 2; i > 0; --i) {
+        sort_heap_sift_down(data, count, i - 1, less);
+    }
 
-template <typename... Args>
-[[noreturn]] [[deprecated("Use TODO macro instead")]] void todo(Args... args)
+    for (size_t i = count; i > 1; --i) {
+        swap(&data[0], &data[i - 1]);
+        sort_heap_sift_down(data, i - 1, 0, less);
+    }
+}
+
+template <typename T, typename Less_Than>
+void sort_introsort(T *data, size_t count, size_t depth, Less_Than less)
 {
-    panic("TODO: ", args...);
+    while (count > SORT_INSERTION_THRESHOLD) {
+        if (depth == 0) {
+            sort_heap(data, count, less);
+            return;
+        }
+        depth -= 1;
+
+        // NOTE: after sorting the first, the middle and the last
+        // elements the median is the pivot and goes to data[0]. The
+        // smallest and the largest of them bound the scans below.
+        const size_t mid = count / 2;
+        if (less(data[mid], data[0])) swap(&data[mid], &data[0]);
+        if (less(data[count - 1], data[mid])) swap(&data[count - 1], &data[mid]);
+        if (less(data[mid], data[0])) swap(&data[mid], &data[0]);
+        swap(&data[0], &data[mid]);
+
+        size_t i = 0;
+        size_t j = count;
+        while (true) {
+            do {
+                i += 1;
+            } while (less(data[i], data[0]));
+
+            do {
+                j -= 1;
+            } while (less(data[0], data[j]));
+
+            if (i >= j) {
+                break;
+            }
+
+            swap(&data[i], &data[j]);
+        }
+        swap(&data[0], &data[j]);
+
+        // NOTE: recurse into the smaller part, loop over the bigger
+        // one, so the stack depth is O(log n).
+        if (j < count - j - 1) {
+            sort_introsort(data, j, depth, less);
+            data += j + 1;
+            count -= j + 1;
+        } else {
+            sort_introsort(data + j + 1, count - j - 1, depth, less);
+            count = j;
+        }
+    }
+
+    sort_insertion(data, count, less);
 }
 
-template <typename T, typename... Args>
-T unwrap_or_panic(Maybe<T> maybe, Args... args)
+template <typename T, typename Less_Than>
+void sort(T *data, size_t count, Less_Than less)
 {
-    if (!maybe.has_value) {
-        panic(args...);
+    size_t depth = 0;
+    for (size_t n = count; n > 1; n >>= 1) {
+        depth += 2;
     }
+    sort_introsort(data, count, depth, less);
+}
 
-    return maybe.unwrap;
+template <typename T>
+void sort(T *data, size_t count)
+{
+    sort(data, count, Less<T> {});
 }
 
-void print1(FILE *stream, Escape escape);
-void print1(FILE *stream, Pad pad);
-void print1(FILE *stream, Caps caps);
-void print1(FILE *stream, String_Buffer buffer);
+template <typename T, typename Less_Than, typename Ator = Mtor>
+void stable_sort(T *data, size_t count, Less_Than less, Ator *ator = &mtor)
+{
+    const size_t RUN_SIZE = 32;
 
-////////////////////////////////////////////////////////////
-// UTF-8
-////////////////////////////////////////////////////////////
+    for (size_t i = 0; i < count; i += RUN_SIZE) {
+        sort_insertion(data + i, min(RUN_SIZE, count - i), less);
+    }
 
-struct Utf8_Char {
-    uint8_t bytes[4];
-    size_t count;
+    if (count <= RUN_SIZE) {
+        return;
+    }
 
-    String_View view();
-};
+    T *buffer = ator->template alloc<T>(count);
+    T *from = data;
+    T *to = buffer;
 
-void print1(FILE *stream, Utf8_Char uchar);
+    for (size_t width = RUN_SIZE; width < count; width *= 2) {
+        for (size_t begin = 0; begin < count; begin += 2 * width) {
+            const size_t mid = min(begin + width, count);
+            const size_t end = min(begin + 2 * width, count);
 
-Utf8_Char code_to_utf8(uint32_t code);
-Maybe<uint32_t> utf8_get_code(String_View view, size_t *size);
+            size_t i = begin;
+            size_t j = mid;
+            size_t k = begin;
+            while (i < mid && j < end) {
+                to[k++] = less(from[j], from[i]) ? from[j++] : from[i++];
+            }
+            while (i < mid) to[k++] = from[i++];
+            while (j < end) to[k++] = from[j++];
+        }
 
-template <typename T>
-struct Hex {
-    T unwrap;
-};
+        swap(&from, &to);
+    }
 
-void print1(FILE *stream, Hex<uint32_t> hex);
-void print1(FILE *stream, Hex<char> hex);
+    if (from != data) {
+        memcpy(data, from, sizeof(T) * count);
+    }
 
-template <typename T>
-struct HEX {
-    T unwrap;
-};
+    ator->dealloc(buffer, count);
+}
 
-void print1(FILE *stream, HEX<uint32_t> hex);
-void print1(FILE *stream, HEX<char> hex);
+template <typename T, typename Ator = Mtor>
+void stable_sort(T *data, size_t count, Ator *ator = &mtor)
+{
+    stable_sort(data, count, Less<T> {}, ator);
+}
 
-struct Hex_Bytes {
-    String_View unwrap;
-};
+// NOTE: key(element) has to return an unsigned integer type
+template <typename T, typename Key, typename Ator = Mtor>
+void radix_sort(T *data, size_t count, Key key, Ator *ator = &mtor)
+{
+    constexpr size_t KEY_SIZE = sizeof(key(*data));
+    static_assert(KEY_SIZE <= sizeof(uint64_t), "radix_sort() keys are at most 64 bits");
 
-void print1(FILE *stream, Hex_Bytes hex_bytes);
+    if (count <= 1) {
+        return;
+    }
 
-struct Newline {};
+    size_t counts[KEY_SIZE][256] = {};
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t k = (uint64_t) key(data[i]);
+        for (size_t byte = 0; byte < KEY_SIZE; ++byte) {
+            counts[byte][(k >> (byte * 8)) & 0xFF] += 1;
+        }
+    }
 
-void print1(FILE *stream, Newline);
+    T *buffer = ator->template alloc<T>(count);
+    T *from = data;
+    T *to = buffer;
+
+    for (size_t byte = 0; byte < KEY_SIZE; ++byte) {
+        size_t offsets[256];
+        size_t offset = 0;
+        bool trivial = false;
+        for (size_t digit = 0; digit < 256; ++digit) {
+            trivial = trivial || counts[byte][digit] == count;
+            offsets[digit] = offset;
+            offset += counts[byte][digit];
+        }
 
-////////////////////////////////////////////////////////////
-// Hash_Map
-////////////////////////////////////////////////////////////
+        if (trivial) {
+            continue;
+        }
 
-// NOTE: stolen from http://www.cse.yorku.ca/~oz/hash.html
-unsigned long hash(String_View str);
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t k = (uint64_t) key(from[i]);
+            to[offsets[(k >> (byte * 8)) & 0xFF]++] = from[i];
+        }
 
-template <typename Key, typename Value>
-struct Hash_Map {
-    struct Bucket {
-        Key key;
-        Value value;
+        swap(&from, &to);
+    }
+
+    if (from != data) {
+        memcpy(data, from, sizeof(T) * count);
+    }
+
+    ator->dealloc(buffer, count);
+}
+
+// NOTE: the signed integers are flipped into unsigned ones of the same
+// size that preserve the order
+template <typename T>
+struct Radix_Key;
+
+#define AIDS_RADIX_KEY(Signed, Unsigned)                                \
+    template <> struct Radix_Key<Unsigned> {                            \
+        Unsigned operator()(Unsigned x) const { return x; }             \
+    };                                                                  \
+    template <> struct Radix_Key<Signed> {                              \
+        Unsigned operator()(Signed x) const                             \
+        {                                                               \
+            return (Unsigned) ((Unsigned) x ^ ((Unsigned) 1 << (sizeof(Unsigned) * 8 - 1))); \
+        }                                                               \
     };
 
-    Maybe<Bucket> *buckets;
-    size_t capacity;
-    size_t size;
+AIDS_RADIX_KEY(signed char, unsigned char)
+AIDS_RADIX_KEY(short, unsigned short)
+AIDS_RADIX_KEY(int, unsigned int)
+AIDS_RADIX_KEY(long, unsigned long)
+AIDS_RADIX_KEY(long long, unsigned long long)
 
-    void extend_capacity()
-    {
-        const size_t HASH_MAP_INITIAL_CAPACITY = 256;
+#undef AIDS_RADIX_KEY
 
-        if (buckets == nullptr) {
-            assert(capacity == 0);
-            assert(size == 0);
+template <typename T, typename Ator = Mtor>
+void radix_sort(T *data, size_t count, Ator *ator = &mtor)
+{
+    radix_sort(data, count, Radix_Key<T> {}, ator);
+}
 
-            buckets = mtor.alloc<Maybe<Bucket>>(HASH_MAP_INITIAL_CAPACITY);
-            capacity = HASH_MAP_INITIAL_CAPACITY;
-            size = 0;
-        } else {
-            Hash_Map<Key, Value> new_hash_map = {
-                mtor.alloc<Maybe<Bucket>>(capacity * 2),
-                                       capacity * 2,
-                                       0
-            };
+// NOTE: key(element) has to return a String_View
+template <typename T, typename Key, typename Ator = Mtor>
+void msd_radix_sort(T *data, size_t count, Key key, Ator *ator = &mtor)
+{
+    const size_t MSD_INSERTION_THRESHOLD = 32;
 
-            for (size_t i = 0; i < capacity; ++i) {
-                if (buckets[i].has_value) {
-                    new_hash_map.insert(
-                        buckets[i].unwrap.key,
-                        buckets[i].unwrap.value);
-                }
-            }
+    struct Bucket {
+        size_t begin;
+        size_t count;
+        size_t depth;
+    };
 
-            mtor.dealloc(buckets, capacity);
+    auto less = [&key](const T &a, const T &b) {
+        return key(a) < key(b);
+    };
 
-            *this = new_hash_map;
-        }
+    if (count <= MSD_INSERTION_THRESHOLD) {
+        sort_insertion(data, count, less);
+        return;
     }
 
-    void insert(Key key, Value value)
-    {
-        if (size >= capacity) {
-            extend_capacity();
+    T *buffer = ator->template alloc<T>(count);
+    Dynamic_Array<Bucket> stack = {};
+    stack.push({0, count, 0});
+
+    while (stack.size > 0) {
+        Bucket bucket = stack.data[--stack.size];
+        T *items = data + bucket.begin;
+
+        if (bucket.count <= MSD_INSERTION_THRESHOLD) {
+            sort_insertion(items, bucket.count, less);
+            continue;
         }
 
-        auto hk = hash(key) & (capacity - 1);
-        while (buckets[hk].has_value && buckets[hk].unwrap.key != key) {
-            hk = (hk + 1) & (capacity - 1);
+        // NOTE: counts[0] are the keys that end at depth, they go
+        // first. counts[byte + 1] are the keys with that byte at depth.
+        size_t counts[257] = {};
+        for (size_t i = 0; i < bucket.count; ++i) {
+            const String_View k = key(items[i]);
+            counts[k.count > bucket.depth ? (uint8_t) k.data[bucket.depth] + 1 : 0] += 1;
         }
-        buckets[hk].has_value = true;
-        buckets[hk].unwrap.key = key;
-        buckets[hk].unwrap.value = value;
-        size += 1;
-    }
 
-    Maybe<Value*> get(Key key)
-    {
-        auto hk = hash(key) & (capacity - 1);
-        for (size_t i = 0;
-                i < capacity
-                && buckets[hk].has_value
-                && buckets[hk].unwrap.key != key;
-                ++i) {
-            hk = (hk + 1) & (capacity - 1);
+        size_t offsets[257];
+        size_t offset = 0;
+        bool trivial = false;
+        for (size_t digit = 0; digit < 257; ++digit) {
+            trivial = trivial || counts[digit] == bucket.count;
+            offsets[digit] = offset;
+            offset += counts[digit];
         }
 
-        if (buckets && buckets[hk].has_value && buckets[hk].unwrap.key == key) {
-            return some(&buckets[hk].unwrap.value);
-        } else {
-            return {};
+        if (trivial) {
+            if (counts[0] != bucket.count) {
+                bucket.depth += 1;
+                stack.push(bucket);
+            }
+            continue;
         }
-    }
 
-    bool contains(Key key)
-    {
-        return get(key).has_value;
-    }
+        for (size_t i = 0; i < bucket.count; ++i) {
+            const String_View k = key(items[i]);
+            buffer[offsets[k.count > bucket.depth ? (uint8_t) k.data[bucket.depth] + 1 : 0]++] = items[i];
+        }
+        memcpy(items, buffer, sizeof(T) * bucket.count);
 
-    Value *operator[](Key key)
-    {
-        {
-            Maybe<Value*> maybe_value = get(key);
-            if (!maybe_value.has_value) {
-                insert(key, {});
-            } else {
-                return maybe_value.unwrap;
+        size_t begin = bucket.begin + counts[0];
+        for (size_t digit = 1; digit < 257; ++digit) {
+            if (counts[digit] > 1) {
+                stack.push({begin, counts[digit], bucket.depth + 1});
             }
+            begin += counts[digit];
         }
-        Maybe<Value*> maybe_value = get(key);
-        assert(maybe_value.has_value);
-        return maybe_value.unwrap;
     }
-};
 
-template <typename Key, typename Value>
-void destroy(Hash_Map<Key, Value> hash_map)
+    destroy(stack);
+    ator->dealloc(buffer, count);
+}
+
+template <typename Ator = Mtor>
+void radix_sort(String_View *data, size_t count, Ator *ator = &mtor)
 {
-    if (hash_map.buckets) {
-        mtor.dealloc(hash_map.buckets, hash_map.capacity);
+    msd_radix_sort(data, count, [](String_View view) {
+        return view;
+    }, ator);
+}
+
+template <typename T, typename U, typename Less_Than>
+size_t lower_bound(const T *data, size_t count, const U &value, Less_Than less)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    const T *base = data;
+    while (count > 1) {
+        const size_t half = count / 2;
+        base = less(base[half - 1], value) ? base + half : base;
+        count -= half;
     }
+    return (size_t) (base - data) + less(*base, value);
 }
+
+template <typename T, typename U>
+size_t lower_bound(const T *data, size_t count, const U &value)
+{
+    return lower_bound(data, count, value, [](const T &a, const U &b) {
+        return a < b;
+    });
 }
 
-#endif  // AIDS_HPP_
+template <typename T, typename U, typename Less_Than>
+size_t upper_bound(const T *data, size_t count, const U &value, Less_Than less)
+{
+    return lower_bound(data, count, value, [&less](const T &a, const U &b) {
+        return !less(b, a);
+    });
+}
+
+template <typename T, typename U>
+size_t upper_bound(const T *data, size_t count, const U &value)
+{
+    return upper_bound(data, count, value, [](const U &a, const T &b) {
+        return a < b;
+    });
+}
+
+template <typename T, typename Less_Than>
+void sort(Dynamic_Array<T> *array, Less_Than less)
+{
+    sort(array->data, array->size, less);
+}
+
+template <typename T>
+void sort(Dynamic_Array<T> *array)
+{
+    sort(array->data, array->size);
+}
+
+template <typename T, typename Less_Than, typename Ator = Mtor>
+void stable_sort(Dynamic_Array<T> *array, Less_Than less, Ator *ator = &mtor)
+{
+    stable_sort(array->data, array->size, less, ator);
+}
+
+template <typename T>
+void stable_sort(Dynamic_Array<T> *array)
+{
+    stable_sort(array->data, array->size);
+}
+
+template <typename T, typename Key, typename Ator = Mtor>
+void radix_sort(Dynamic_Array<T> *array, Key key, Ator *ator = &mtor)
+{
+    radix_sort(array->data, array->size, key, ator);
+}
+
+template <typename T>
+void radix_sort(Dynamic_Array<T> *array)
+{
+    radix_sort(array->data, array->size);
+}
+
+template <typename T, typename Key, typename Ator = Mtor>
+void msd_radix_sort(Dynamic_Array<T> *array, Key key, Ator *ator = &mtor)
+{
+    msd_radix_sort(array->data, array->size, key, ator);
+}
+
+template <typename T, typename U, typename Less_Than>
+size_t lower_bound(const Dynamic_Array<T> &array, const U &value, Less_Than less)
+{
+    return lower_bound(array.data, array.size, value, less);
+}
+
+template <typename T, typename U>
+size_t lower_bound(const Dynamic_Array<T> &array, const U &value)
+{
+    return lower_bound(array.data, array.size, value);
+}
+
+template <typename T, typename U, typename Less_Than>
+size_t upper_bound(const Dynamic_Array<T> &array, const U &value, Less_Than less)
+{
+    return upper_bound(array.data, array.size, value, less);
+}
+
+template <typename T, typename U>
+size_t upper_bound(const Dynamic_Array<T> &array, const U &value)
+{
+    return upper_bound(array.data, array.size, value);
+}
+
+////////////////////////////////////////////////////////////
+// STRING
+////////////////////////////////////////////////////////////
+
+// NOTE: String is the owning counterpart of String_View. Strings of
+// up to String::SMALL_CAPACITY bytes are stored inline and never
+// touch the allocator. Zero-initialized String is a valid empty
+// string:
+//
+//     String<> s = {};
+//     defer(destroy(s));
+//     s.append("Hello, World"_sv);
+//
+// The small/large tag is the last byte of the struct. For large
+// strings that byte is the most significant byte of
+// large.capacity, which is why String only supports little-endian
+// targets for now.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "aids::String does not support big-endian targets"
+#endif
+
+template <typename Ator>
+struct String {
+    static constexpr size_t SMALL_CAPACITY = 23;
+    static constexpr uint8_t SMALL_FLAG = 0x80;
+
+    union {
+        struct {
+            char data[SMALL_CAPACITY];
+            uint8_t count;
+        } small;
+
+        struct {
+            char *data;
+            size_t count;
+            size_t capacity;
+        } large;
+    };
+
+    bool is_small() const
+    {
+        return small.count & SMALL_FLAG;
+    }
+
+    size_t count() const
+    {
+        return is_small() ? (size_t) (small.count & ~SMALL_FLAG) : large.count;
+    }
+
+    size_t capacity() const
+    {
+        return is_small() ? SMALL_CAPACITY : large.capacity;
+    }
+
+    String_View view() const
+    {
+        if (is_small()) {
+            return {(size_t) (small.count & ~SMALL_FLAG), small.data};
+        } else {
+            return {large.count, large.data};
+        }
+    }
+
+    // NOTE: moves the content into a new large buffer of
+    // new_capacity bytes followed by the suffix. The suffix is copied
+    // before the old buffer is released, so it may point into this
+    // very string.
+    void expand_capacity(size_t new_capacity, String_View suffix, Ator *ator)
+    {
+        String_View old = view();
+        assert(new_capacity >= old.count + suffix.count);
+
+        char *new_data = ator->template alloc<char>(new_capacity);
+        if (new_data == nullptr) {
+            panic("String: out of memory");
+        }
+        memcpy(new_data, old.data, old.count);
+        if (suffix.count > 0) {
+            memcpy(new_data + old.count, suffix.data, suffix.count);
+        }
+
+        if (!is_small() && large.data != nullptr) {
+            ator->dealloc(large.data, large.capacity);
+        }
+
+        large.data = new_data;
+        large.count = old.count + suffix.count;
+        large.capacity = new_capacity;
+        small.count = 0;
+    }
+
+    void reserve(size_t n, Ator *ator = &mtor)
+    {
+        make_small_if_empty();
+
+        if (n > capacity()) {
+            expand_capacity(max(n, 2 * capacity()), {}, ator);
+        }
+    }
+
+    void append(String_View that, Ator *ator = &mtor)
+    {
+        make_small_if_empty();
+
+        size_t n = count();
+        if (n + that.count > capacity()) {
+            expand_capacity(max(n + that.count, 2 * capacity()), that, ator);
+        } else if (is_small()) {
+            memcpy(small.data + n, that.data, that.count);
+            small.count = (uint8_t) ((n + that.count) | SMALL_FLAG);
+        } else {
+            memcpy(large.data + n, that.data, that.count);
+            large.count = n + that.count;
+        }
+    }
+
+    void push(char c, Ator *ator = &mtor)
+    {
+        append({1, &c}, ator);
+    }
+
+    // NOTE: keeps the capacity
+    void clear()
+    {
+        if (is_small()) {
+            small.count = SMALL_FLAG;
+        } else {
+            large.count = 0;
+        }
+    }
+
+    String copy(Ator *ator = &mtor) const
+    {
+        return view().as_string(ator);
+    }
+
+    char operator[](size_t index) const
+    {
+#ifndef AIDS_DISABLE_RANGE_CHECKS
+        if (index >= count()) {
+            panic("String: index out-of-bounds");
+        }
+#endif // AIDS_DISABLE_RANGE_CHECKS
+        return view().data[index];
+    }
+
+    bool operator==(String_View that) const
+    {
+        return view() == that;
+    }
+
+    bool operator!=(String_View that) const
+    {
+        return view() != that;
+    }
+
+    bool operator==(const String &that) const
+    {
+        return view() == that.view();
+    }
+
+    bool operator!=(const String &that) const
+    {
+        return view() != that.view();
+    }
+
+    void make_small_if_empty()
+    {
+        if (!is_small() && large.data == nullptr) {
+            small.count = SMALL_FLAG;
+        }
+    }
+};
+
+template <typename Ator>
+String<Ator> String_View::as_string(Ator *ator) const
+{
+    String<Ator> result = {};
+    result.append(*this, ator);
+    return result;
+}
+
+template <typename Ator>
+void destroy(String<Ator> string, Ator *ator = &mtor)
+{
+    if (!string.is_small() && string.large.data != nullptr) {
+        ator->dealloc(string.large.data, string.large.capacity);
+    }
+}
+
+template <typename Ator>
+void print1(FILE *stream, const String<Ator> &string)
+{
+    print1(stream, string.view());
+}
+
+struct String_Buffer;
+void sprint1(String_Buffer *buffer, String_View view);
+
+template <typename Ator>
+void sprint1(String_Buffer *buffer, const String<Ator> &string)
+{
+    sprint1(buffer, string.view());
+}
+
+////////////////////////////////////////////////////////////
+// ARGS
+////////////////////////////////////////////////////////////
+
+struct Args {
+    int argc;
+    char **argv;
+
+    char *shift();
+    bool empty();
+};
+
+////////////////////////////////////////////////////////////
+// SPRINT
+////////////////////////////////////////////////////////////
+
+struct String_Buffer {
+    size_t capacity;
+    char *data;
+    size_t size;
+
+    String_View view() const;
+};
+
+void sprint1(String_Buffer *buffer, const char *cstr);
+void sprint1(String_Buffer *buffer, String_View view);
+void sprint1(String_Buffer *buffer, char c);
+void sprint1(String_Buffer *buffer, float f);
+void sprint1(String_Buffer *buffer, unsigned long long x);
+void sprint1(String_Buffer *buffer, unsigned int x);
+void sprint1(String_Buffer *buffer, long unsigned int x);
+void sprint1(String_Buffer *buffer, int x);
+void sprint1(String_Buffer *buffer, long int x);
+void sprint1(String_Buffer *buffer, bool b);
+
+template <typename ... Types>
+void sprint(String_Buffer *buffer, Types... args)
+{
+    (sprint1(buffer, args), ...);
+}
+
+template <typename T>
+void sprint1(String_Buffer *buffer, Maybe<T> maybe)
+{
+    if (!maybe.has_value) {
+        sprint(buffer, "None");
+    } else {
+        sprint(buffer, "Some(", maybe.unwrap, ")");
+    }
+}
+
+template <typename T, bool B>
+void sprint1(String_Buffer *buffer, Compact_Maybe<T, B> maybe)
+{
+    sprint1(buffer, as_maybe(maybe));
+}
+
+template <typename ... Types>
+void sprintln(String_Buffer *buffer, Types... args)
+{
+    (sprint1(buffer, args), ...);
+    sprint1(buffer, '\n');
+}
+
+struct Pad {
+    size_t n;
+    char c;
+};
+
+void sprint1(String_Buffer *buffer, Pad pad);
+
+// NOTE: x with precision digits after the point, right-aligned to
+// width characters ("%*.*f")
+struct Fixed {
+    double unwrap;
+    int precision;
+    int width = 0;
+};
+
+void sprint1(String_Buffer *buffer, Fixed fixed);
+
+struct Caps {
+    String_View unwrap;
+};
+
+void sprint1(String_Buffer *buffer, Caps caps);
+void sprint1(String_Buffer *buffer, String_Buffer another_buffer);
+
+struct Escape {
+    String_View unwrap;
+};
+
+// NOTE: the contents of a JSON string (RFC 8259): quotes, backslashes
+// and control bytes are escaped, everything else goes as is.
+struct Json_Escape {
+    String_View unwrap;
+};
+
+////////////////////////////////////////////////////////////
+// PRINT
+////////////////////////////////////////////////////////////
+
+void print1(FILE *stream, const char *s);
+void print1(FILE *stream, char *s);
+void print1(FILE *stream, char c);
+void print1(FILE *stream, float f);
+void print1(FILE *stream, unsigned long long x);
+void print1(FILE *stream, long unsigned int x);
+void print1(FILE *stream, unsigned int x);
+void print1(FILE *stream, int x);
+void print1(FILE *stream, long int x);
+
+void print1(FILE *stream, bool b);
+
+// NOTE: print() and println() format all of their arguments into a
+// Print_Buffer and hand it to the stream with a single fwrite(), so
+// a line never gets interleaved with the output of other threads.
+// Short output stays in the inline storage on the stack, long output
+// spills to the heap. A type becomes printable without going through
+// the FILE* by defining print1(Print_Buffer*, T):
+//
+//     void print1(Print_Buffer *buffer, Vec2 v)
+//     {
+//         print(buffer, "(", v.x, ", ", v.y, ")");
+//     }
+//
+// Types that only have print1(FILE*, T) still work: the buffer is
+// flushed right before them and the stream stays locked until the
+// whole print() is done.
+struct Print_Buffer {
+    static constexpr size_t INLINE_CAPACITY = 512;
+
+    FILE *stream;
+    char *heap;
+    size_t size;
+    size_t capacity;
+    bool locked;
+    char storage[INLINE_CAPACITY];
+
+    char *items()
+    {
+        return heap ? heap : storage;
+    }
+
+    size_t items_capacity() const
+    {
+        return heap ? capacity : INLINE_CAPACITY;
+    }
+
+    // NOTE: makes room for n more bytes and returns where they go.
+    // Nothing is written until size is moved past them.
+    char *reserve(size_t n);
+    void write(const char *data, size_t n);
+    void flush();
+    void lock();
+
+    // NOTE: the inline storage is not initialized on purpose, zeroing
+    // it would cost more than most of the prints.
+    void start(FILE *stream, size_t expected_size);
+    void finish();
+};
+
+// NOTE: the longest text print1() produces for a T, 0 if it is not
+// bounded. print() reserves the sum of them upfront.
+template <typename T>
+struct Print_Max_Size {
+    static constexpr size_t value = 0;
+};
+
+#define AIDS_PRINT_MAX_SIZE(Type, size)                 \
+    template <>                                         \
+    struct Print_Max_Size<Type> {                       \
+        static constexpr size_t value = size;           \
+    }
+
+AIDS_PRINT_MAX_SIZE(char, 1);
+AIDS_PRINT_MAX_SIZE(bool, 5);
+AIDS_PRINT_MAX_SIZE(int, 11);
+AIDS_PRINT_MAX_SIZE(long int, 20);
+AIDS_PRINT_MAX_SIZE(unsigned int, 10);
+AIDS_PRINT_MAX_SIZE(long unsigned int, 20);
+AIDS_PRINT_MAX_SIZE(unsigned long long, 20);
+// NOTE: "%f" of -FLT_MAX
+AIDS_PRINT_MAX_SIZE(float, 47);
+
+void print1(Print_Buffer *buffer, const char *s);
+void print1(Print_Buffer *buffer, char *s);
+void print1(Print_Buffer *buffer, char c);
+void print1(Print_Buffer *buffer, float f);
+void print1(Print_Buffer *buffer, unsigned long long x);
+void print1(Print_Buffer *buffer, long unsigned int x);
+void print1(Print_Buffer *buffer, unsigned int x);
+void print1(Print_Buffer *buffer, int x);
+void print1(Print_Buffer *buffer, long int x);
+void print1(Print_Buffer *buffer, bool b);
+void print1(Print_Buffer *buffer, String_View view);
+
+template <typename T>
+auto print1_buffered(Print_Buffer *buffer, const T &x, int) -> decltype(print1(buffer, x), void())
+{
+    print1(buffer, x);
+}
+
+template <typename T>
+void print1_buffered(Print_Buffer *buffer, const T &x, long)
+{
+    buffer->lock();
+    buffer->flush();
+    print1(buffer->stream, x);
+}
+
+template <typename ... Types>
+void print(Print_Buffer *buffer, Types... args)
+{
+    (print1_buffered(buffer, args, 0), ...);
+}
+
+template <typename ... Types>
+void print(FILE *stream, Types... args)
+{
+    Print_Buffer buffer;
+    buffer.start(stream, (Print_Max_Size<Types>::value + ... + 0));
+    (print1_buffered(&buffer, args, 0), ...);
+    buffer.finish();
+}
+
+template <typename Ator>
+void print1(Print_Buffer *buffer, const String<Ator> &string)
+{
+    print1(buffer, string.view());
+}
+
+template <typename T>
+void print1(Print_Buffer *buffer, Maybe<T> maybe)
+{
+    if (!maybe.has_value) {
+        print(buffer, "None");
+    } else {
+        print(buffer, "Some(", maybe.unwrap, ")");
+    }
+}
+
+template <typename T, bool B>
+void print1(Print_Buffer *buffer, Compact_Maybe<T, B> maybe)
+{
+    print1(buffer, as_maybe(maybe));
+}
+
+template <typename T>
+void print1(FILE *stream, Maybe<T> maybe)
+{
+    if (!maybe.has_value) {
+        print(stream, "None");
+    } else {
+        print(stream, "Some(", maybe.unwrap, ")");
+    }
+}
+
+template <typename T, bool B>
+void print1(FILE *stream, Compact_Maybe<T, B> maybe)
+{
+    print1(stream, as_maybe(maybe));
+}
+
+template <typename ... Types>
+void println(FILE *stream, Types... args)
+{
+    Print_Buffer buffer;
+    buffer.start(stream, (Print_Max_Size<Types>::value + ... + 1));
+    (print1_buffered(&buffer, args, 0), ...);
+    print1(&buffer, '\n');
+    buffer.finish();
+}
+
+template <typename ... Types>
+void println(Print_Buffer *buffer, Types... args)
+{
+    (print1_buffered(buffer, args, 0), ...);
+    print1(buffer, '\n');
+}
+
+template <typename... Args>
+[[noreturn]] void panic(Args... args)
+{
+    println(stderr, args...);
+    exit(1);
+}
+
+#define UNREACHABLE(...) panic(__FILE__, ":", __LINE__, ": unreachable: ", __VA_ARGS__);
+
+template <typename... Args>
+[[noreturn]] [[deprecated("Use UNREACHABLE macro instead")]] void unreachable(Args... args)
+{
+    panic("Unreachable: ", args...);
+}
+
+#define TODO(...) panic(__FILE__, ":", __LINE__, ": TODO: ", __VA_ARGS__)
+
+template <typename... Args>
+[[noreturn]] [[deprecated("Use TODO macro instead")]] void todo(Args... args)
+{
+    panic("TODO: ", args...);
+}
+
+template <typename T, typename... Args>
+T unwrap_or_panic(Maybe<T> maybe, Args... args)
+{
+    if (!maybe.has_value) {
+        panic(args...);
+    }
+
+    return maybe.unwrap;
+}
+
+template <typename T, bool B, typename... Args>
+T unwrap_or_panic(Compact_Maybe<T, B> maybe, Args... args)
+{
+    if (!maybe.has_value()) {
+        panic(args...);
+    }
+
+    return maybe.unwrap();
+}
+
+void print1(FILE *stream, Escape escape);
+void print1(FILE *stream, Pad pad);
+void print1(FILE *stream, Fixed fixed);
+void print1(FILE *stream, Caps caps);
+void print1(FILE *stream, String_Buffer buffer);
+void print1(FILE *stream, Json_Escape escape);
+void print1(Print_Buffer *buffer, Escape escape);
+void print1(Print_Buffer *buffer, Json_Escape escape);
+void print1(Print_Buffer *buffer, Pad pad);
+void print1(Print_Buffer *buffer, Fixed fixed);
+void print1(Print_Buffer *buffer, Caps caps);
+void print1(Print_Buffer *buffer, String_Buffer another_buffer);
+
+////////////////////////////////////////////////////////////
+// UTF-8
+////////////////////////////////////////////////////////////
+
+struct Utf8_Char {
+    uint8_t bytes[4];
+    size_t count;
+
+    String_View view();
+};
+
+void print1(FILE *stream, Utf8_Char uchar);
+void print1(Print_Buffer *buffer, Utf8_Char uchar);
+
+Utf8_Char code_to_utf8(uint32_t code);
+Maybe<uint32_t> utf8_get_code(String_View view, size_t *size);
+
+// NOTE: checks the whole view against the well-formed UTF-8 byte
+// sequences of the Unicode Standard (Table 3-7). The same sequences
+// are accepted by utf8_get_code() one code point at a time.
+bool utf8_validate(String_View view);
+
+// NOTE: bulk transcoding between UTF-8, UTF-32 and UTF-16. The
+// functions writing into caller-provided buffers expect them to be
+// big enough. The *_length_as_*() functions compute the exact amount
+// of units the conversion of a well-formed input produces and never
+// underestimate it for an ill-formed one. The conversions return the
+// amount of written units, or None if the input is not well-formed
+// (including the surrogate codes in UTF-32 and the unpaired
+// surrogates in UTF-16).
+size_t utf8_length_as_utf32(String_View view);
+size_t utf8_length_as_utf16(String_View view);
+size_t utf32_length_as_utf8(const uint32_t *codes, size_t count);
+size_t utf16_length_as_utf8(const uint16_t *units, size_t count);
+
+Maybe<size_t> utf8_to_utf32(String_View view, uint32_t *output);
+Maybe<size_t> utf8_to_utf16(String_View view, uint16_t *output);
+Maybe<size_t> utf32_to_utf8(const uint32_t *codes, size_t count, char *output);
+Maybe<size_t> utf16_to_utf8(const uint16_t *units, size_t count, char *output);
+
+// NOTE: the allocating counterparts of the conversions above. They
+// return None if the input is not well-formed or the allocation fails.
+// An empty input is a valid empty result. The result has to be
+// released with ator->dealloc(result, *count) or destroy() for the
+// String_View.
+template <typename Ator = Mtor>
+Maybe<uint32_t*> utf8_as_utf32(String_View view, size_t *count, Ator *ator = &mtor)
+{
+    size_t capacity = utf8_length_as_utf32(view);
+    uint32_t *result = ator->template alloc<uint32_t>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = utf8_to_utf32(view, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    *count = n.unwrap;
+    return some(result);
+}
+
+template <typename Ator = Mtor>
+Maybe<uint16_t*> utf8_as_utf16(String_View view, size_t *count, Ator *ator = &mtor)
+{
+    size_t capacity = utf8_length_as_utf16(view);
+    uint16_t *result = ator->template alloc<uint16_t>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = utf8_to_utf16(view, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    *count = n.unwrap;
+    return some(result);
+}
+
+template <typename Ator = Mtor>
+Maybe<String_View> utf32_as_utf8(const uint32_t *codes, size_t count, Ator *ator = &mtor)
+{
+    size_t capacity = utf32_length_as_utf8(codes, count);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = utf32_to_utf8(codes, count, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    return some(String_View {n.unwrap, result});
+}
+
+template <typename Ator = Mtor>
+Maybe<String_View> utf16_as_utf8(const uint16_t *units, size_t count, Ator *ator = &mtor)
+{
+    size_t capacity = utf16_length_as_utf8(units, count);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = utf16_to_utf8(units, count, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    return some(String_View {n.unwrap, result});
+}
+
+// NOTE: the amount of code points in a well-formed UTF-8 view
+size_t utf8_length(String_View view);
+
+// NOTE: the code point counterparts of String_View::chop_left(),
+// String_View::chop_right() and String_View::subview(). They never
+// split a multibyte sequence. The bytes of an ill-formed sequence
+// count as separate code points.
+String_View utf8_chop_left(String_View *view, size_t n);
+String_View utf8_chop_right(String_View *view, size_t n);
+String_View utf8_subview(String_View view, size_t start, size_t count);
+
+// NOTE: the simple (1:1) case mappings of the Unicode Character
+// Database: Simple_Uppercase_Mapping and Simple_Case_Folding.
+uint32_t unicode_to_upper(uint32_t code);
+uint32_t unicode_fold_case(uint32_t code);
+
+// NOTE: the simple case mappings may change the length of the UTF-8
+// encoding, for instance U+0250 (2 bytes) becomes U+2C6F (3 bytes).
+// The output buffer of utf8_to_upper() and utf8_fold_case() must be at
+// least utf8_case_mapping_capacity() bytes long. They return the size
+// of the output or None if the view is not well-formed.
+size_t utf8_case_mapping_capacity(String_View view);
+Maybe<size_t> utf8_to_upper(String_View view, char *output);
+Maybe<size_t> utf8_fold_case(String_View view, char *output);
+
+template <typename Ator = Mtor>
+Maybe<String_View> utf8_as_upper(String_View view, Ator *ator = &mtor)
+{
+    size_t capacity = utf8_case_mapping_capacity(view);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = utf8_to_upper(view, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    return some(String_View {n.unwrap, result});
+}
+
+template <typename Ator = Mtor>
+Maybe<String_View> utf8_as_folded(String_View view, Ator *ator = &mtor)
+{
+    size_t capacity = utf8_case_mapping_capacity(view);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = utf8_fold_case(view, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    return some(String_View {n.unwrap, result});
+}
+
+template <typename T>
+struct Hex {
+    T unwrap;
+};
+
+void print1(FILE *stream, Hex<uint32_t> hex);
+void print1(FILE *stream, Hex<char> hex);
+
+template <typename T>
+struct HEX {
+    T unwrap;
+};
+
+void print1(FILE *stream, HEX<uint32_t> hex);
+void print1(FILE *stream, HEX<char> hex);
+
+struct Hex_Bytes {
+    String_View unwrap;
+};
+
+void print1(FILE *stream, Hex_Bytes hex_bytes);
+void print1(Print_Buffer *buffer, Hex_Bytes hex_bytes);
+
+// NOTE: bulk hex (lowercase) and base64 (RFC 4648, with padding)
+// encoding of arbitrary bytes. The same pattern as the UTF
+// transcoding: the *_length_as_*() functions compute the size of the
+// caller-provided output buffer, the conversions return the amount of
+// written bytes. The decoding accepts both cases of the hex digits,
+// the padded and unpadded base64, and returns None on anything else.
+size_t bytes_length_as_hex(String_View bytes);
+size_t hex_length_as_bytes(String_View hex);
+size_t bytes_to_hex(String_View bytes, char *output);
+Maybe<size_t> hex_to_bytes(String_View hex, char *output);
+
+size_t bytes_length_as_base64(String_View bytes);
+size_t base64_length_as_bytes(String_View base64);
+size_t bytes_to_base64(String_View bytes, char *output);
+Maybe<size_t> base64_to_bytes(String_View base64, char *output);
+
+template <typename Ator = Mtor>
+Maybe<String_View> bytes_as_hex(String_View bytes, Ator *ator = &mtor)
+{
+    size_t capacity = bytes_length_as_hex(bytes);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    return some(String_View {bytes_to_hex(bytes, result), result});
+}
+
+template <typename Ator = Mtor>
+Maybe<String_View> hex_as_bytes(String_View hex, Ator *ator = &mtor)
+{
+    size_t capacity = hex_length_as_bytes(hex);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = hex_to_bytes(hex, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    return some(String_View {n.unwrap, result});
+}
+
+template <typename Ator = Mtor>
+Maybe<String_View> bytes_as_base64(String_View bytes, Ator *ator = &mtor)
+{
+    size_t capacity = bytes_length_as_base64(bytes);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    return some(String_View {bytes_to_base64(bytes, result), result});
+}
+
+template <typename Ator = Mtor>
+Maybe<String_View> base64_as_bytes(String_View base64, Ator *ator = &mtor)
+{
+    size_t capacity = base64_length_as_bytes(base64);
+    char *result = ator->template alloc<char>(capacity);
+    if (result == nullptr && capacity > 0) {
+        return {};
+    }
+
+    auto n = base64_to_bytes(base64, result);
+    if (!n.has_value) {
+        ator->dealloc(result, capacity);
+        return {};
+    }
+
+    return some(String_View {n.unwrap, result});
+}
+
+struct Newline {};
+
+void print1(FILE *stream, Newline);
+void print1(Print_Buffer *buffer, Newline);
+
+////////////////////////////////////////////////////////////
+// Hash_Map
+////////////////////////////////////////////////////////////
+
+// NOTE: stolen from http://www.cse.yorku.ca/~oz/hash.html
+unsigned long hash(String_View str);
+unsigned long hash(uint32_t x);
+
+template <typename Ator>
+unsigned long hash(const String<Ator> &string)
+{
+    return hash(string.view());
+}
+
+// NOTE: the probe length is the amount of buckets Hash_Map::get()
+// looks at: 1 for a key in its home bucket, displacement + 1
+// otherwise. The miss probe length is averaged over all of the
+// possible home buckets of a missing key. The last bucket of the
+// displacement histogram also counts all the bigger displacements.
+struct Hash_Map_Stats {
+    static constexpr size_t DISPLACEMENT_HISTOGRAM_SIZE = 16;
+
+    size_t size;
+    size_t capacity;
+    size_t resizes;
+    float load_factor;
+    float average_probe_length;
+    size_t max_probe_length;
+    float average_miss_probe_length;
+    size_t displacement_histogram[DISPLACEMENT_HISTOGRAM_SIZE];
+};
+
+void print1(FILE *stream, const Hash_Map_Stats &stats);
+
+// NOTE: a hint to start loading the cache line of address in the
+// background. It never faults, any address is fine.
+inline void prefetch(const void *address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(AIDS_SSE2)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void) address;
+#endif
+}
+
+// NOTE: the linear probing shared by Hash_Map and Hash_Set. The
+// capacity of the slots is a power of two and at least one slot is
+// always empty. key_of(slot) is a pointer to the key of an occupied
+// slot, nullptr for an empty one.
+//
+// hash_table_probe() finds the slot of key or the empty slot that
+// ends its run, the one where key would be inserted. It returns
+// capacity if there is neither.
+template <typename Slot, typename Key, typename Key_Of>
+size_t hash_table_probe(const Slot *slots, size_t capacity, const Key &key, unsigned long h, Key_Of key_of)
+{
+    size_t i = h & (capacity - 1);
+    for (size_t n = 0; n < capacity; ++n) {
+        const Key *slot_key = key_of(slots[i]);
+        if (slot_key == nullptr || *slot_key == key) {
+            return i;
+        }
+        i = (i + 1) & (capacity - 1);
+    }
+    return capacity;
+}
+
+// NOTE: empties the slot i and shifts the rest of its run back, so
+// every key stays reachable from its home slot without tombstones.
+// A key moves into the hole only if the hole is between its home
+// slot and where it is now.
+template <typename Slot, typename Key_Of>
+void hash_table_erase(Slot *slots, size_t capacity, size_t i, Key_Of key_of)
+{
+    slots[i] = {};
+    for (size_t j = (i + 1) & (capacity - 1);
+            key_of(slots[j]) != nullptr;
+            j = (j + 1) & (capacity - 1)) {
+        const size_t home = hash(*key_of(slots[j])) & (capacity - 1);
+        if (((j - home) & (capacity - 1)) >= ((j - i) & (capacity - 1))) {
+            slots[i] = slots[j];
+            slots[j] = {};
+            i = j;
+        }
+    }
+}
+
+template <typename Key, typename Value>
+struct Hash_Map_Bucket {
+    Key key;
+    Value value;
+};
+
+// NOTE: a bucket borrows the niche of its key, so the empty buckets of
+// a Hash_Map take no extra space when the key has a niche.
+template <typename Key, typename Value>
+struct Niche<Hash_Map_Bucket<Key, Value>> {
+    static constexpr bool exists = Niche<Key>::exists;
+
+    static Hash_Map_Bucket<Key, Value> none()
+    {
+        return {Niche<Key>::none(), {}};
+    }
+
+    static bool is_none(const Hash_Map_Bucket<Key, Value> &x)
+    {
+        return Niche<Key>::is_none(x.key);
+    }
+};
+
+// NOTE: the key that is Niche<Key>::none() can't live in the buckets,
+// so its bucket is kept in niche_bucket instead. size counts it too.
+template <typename Key, typename Value>
+struct Hash_Map {
+    typedef Hash_Map_Bucket<Key, Value> Bucket;
+
+    Compact_Maybe<Bucket> *buckets;
+    size_t capacity;
+    size_t size;
+    size_t resizes;
+    Maybe<Bucket> niche_bucket;
+
+    static const Key *bucket_key(const Compact_Maybe<Bucket> &bucket)
+    {
+        return bucket.has_value() ? &bucket.unwrap().key : nullptr;
+    }
+
+    void extend_capacity()
+    {
+        const size_t HASH_MAP_INITIAL_CAPACITY = 256;
+
+        if (buckets == nullptr) {
+            assert(capacity == 0);
+            assert(size == (niche_bucket.has_value ? 1u : 0u));
+
+            buckets = mtor.alloc<Compact_Maybe<Bucket>>(HASH_MAP_INITIAL_CAPACITY);
+            capacity = HASH_MAP_INITIAL_CAPACITY;
+        } else {
+            Hash_Map<Key, Value> new_hash_map = {
+                mtor.alloc<Compact_Maybe<Bucket>>(capacity * 2),
+                                       capacity * 2,
+                                       niche_bucket.has_value ? 1u : 0u,
+                                       resizes + 1,
+                                       niche_bucket
+            };
+
+            for (size_t i = 0; i < capacity; ++i) {
+                if (buckets[i].has_value()) {
+                    new_hash_map.insert(
+                        buckets[i].unwrap().key,
+                        buckets[i].unwrap().value);
+                }
+            }
+
+            mtor.dealloc(buckets, capacity);
+
+            *this = new_hash_map;
+        }
+    }
+
+    // NOTE: the load factor is kept at or below 3/4. Linear probing
+    // degrades quickly past that, and a completely full table makes
+    // every miss look at all of the buckets.
+    void insert(Key key, Value value)
+    {
+        insert_with_hash(key, hash(key), value);
+    }
+
+    // NOTE: h has to be hash(key), for the callers that already know it
+    void insert_with_hash(Key key, unsigned long h, Value value)
+    {
+        if (Niche<Key>::is_none(key)) {
+            if (!niche_bucket.has_value) {
+                size += 1;
+            }
+            niche_bucket = some(Bucket {key, value});
+            return;
+        }
+
+        if ((size + 1) * 4 > capacity * 3) {
+            extend_capacity();
+        }
+
+        auto hk = hash_table_probe(buckets, capacity, key, h, bucket_key);
+        if (!buckets[hk].has_value()) {
+            size += 1;
+        }
+        buckets[hk].set({key, value});
+    }
+
+    // NOTE: returns false if there was no such key
+    bool remove(Key key)
+    {
+        if (Niche<Key>::is_none(key)) {
+            if (!niche_bucket.has_value) {
+                return false;
+            }
+            niche_bucket = {};
+            size -= 1;
+            return true;
+        }
+
+        auto hk = hash_table_probe(buckets, capacity, key, hash(key), bucket_key);
+        if (hk == capacity || !buckets[hk].has_value()) {
+            return false;
+        }
+
+        hash_table_erase(buckets, capacity, hk, bucket_key);
+        size -= 1;
+        return true;
+    }
+
+    Maybe<Value*> get(Key key)
+    {
+        return get_with_hash(key, hash(key));
+    }
+
+    Maybe<Value*> get_with_hash(Key key, unsigned long h)
+    {
+        if (Niche<Key>::is_none(key)) {
+            if (niche_bucket.has_value) {
+                return some(&niche_bucket.unwrap.value);
+            } else {
+                return {};
+            }
+        }
+
+        auto hk = hash_table_probe(buckets, capacity, key, h, bucket_key);
+        if (hk < capacity && buckets[hk].has_value()) {
+            return some(&buckets[hk].unwrap().value);
+        } else {
+            return {};
+        }
+    }
+
+    // NOTE: out[i] = get(keys[i]) for the n keys. The keys go in
+    // batches: the whole batch is hashed and its home buckets are
+    // prefetched before any of them is probed, so the cache misses of
+    // a batch overlap instead of waiting for each other. A batch is
+    // about as many misses as a core keeps in flight.
+    void get_many(const Key *keys, size_t n, Maybe<Value*> *out)
+    {
+        const size_t HASH_MAP_BATCH = 16;
+        unsigned long hashes[HASH_MAP_BATCH];
+
+        for (size_t begin = 0; begin < n; begin += HASH_MAP_BATCH) {
+            const size_t count = min(n - begin, HASH_MAP_BATCH);
+            for (size_t i = 0; i < count; ++i) {
+                hashes[i] = hash(keys[begin + i]);
+                if (buckets) {
+                    prefetch(buckets + (hashes[i] & (capacity - 1)));
+                }
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                out[begin + i] = get_with_hash(keys[begin + i], hashes[i]);
+            }
+        }
+    }
+
+    bool contains(Key key)
+    {
+        return get(key).has_value;
+    }
+
+    // NOTE: f(key, value) for every key of the map in no particular
+    // order. value is a reference that f can update.
+    template <typename F>
+    void for_each(F f)
+    {
+        if (niche_bucket.has_value) {
+            f(niche_bucket.unwrap.key, niche_bucket.unwrap.value);
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            if (buckets[i].has_value()) {
+                f(buckets[i].unwrap().key, buckets[i].unwrap().value);
+            }
+        }
+    }
+
+    Hash_Map_Stats stats() const
+    {
+        Hash_Map_Stats result = {};
+        result.size = size;
+        result.capacity = capacity;
+        result.resizes = resizes;
+
+        if (capacity == 0) {
+            return result;
+        }
+
+        size_t occupied = 0;
+        size_t total_probe_length = 0;
+        Maybe<size_t> empty = {};
+        for (size_t i = 0; i < capacity; ++i) {
+            if (!buckets[i].has_value()) {
+                empty = some(i);
+                continue;
+            }
+
+            const size_t home = hash(buckets[i].unwrap().key) & (capacity - 1);
+            const size_t displacement = (i - home) & (capacity - 1);
+            occupied += 1;
+            total_probe_length += displacement + 1;
+            result.max_probe_length = max(result.max_probe_length, displacement + 1);
+            result.displacement_histogram[
+                min(displacement, Hash_Map_Stats::DISPLACEMENT_HISTOGRAM_SIZE - 1)] += 1;
+        }
+
+        result.load_factor = (float) occupied / (float) capacity;
+        if (occupied > 0) {
+            result.average_probe_length = (float) total_probe_length / (float) occupied;
+        }
+
+        if (!empty.has_value) {
+            // NOTE: get() gives up after looking at every bucket
+            result.average_miss_probe_length = (float) capacity;
+        } else {
+            // NOTE: walking backwards from an empty bucket, a miss
+            // starting at bucket i looks at the run of occupied
+            // buckets after it plus the empty bucket that ends it.
+            size_t total_miss_probe_length = 0;
+            size_t run = 0;
+            for (size_t j = 0; j < capacity; ++j) {
+                const size_t i = (empty.unwrap - j) & (capacity - 1);
+                run = buckets[i].has_value() ? run + 1 : 0;
+                total_miss_probe_length += run + 1;
+            }
+            result.average_miss_probe_length =
+                (float) total_miss_probe_length / (float) capacity;
+        }
+
+        return result;
+    }
+
+    Value *operator[](Key key)
+    {
+        {
+            Maybe<Value*> maybe_value = get(key);
+            if (!maybe_value.has_value) {
+                insert(key, {});
+            } else {
+                return maybe_value.unwrap;
+            }
+        }
+        Maybe<Value*> maybe_value = get(key);
+        assert(maybe_value.has_value);
+        return maybe_value.unwrap;
+    }
+};
+
+template <typename Key, typename Value>
+void destroy(Hash_Map<Key, Value> hash_map)
+{
+    if (hash_map.buckets) {
+        mtor.dealloc(hash_map.buckets, hash_map.capacity);
+    }
+}
+
+// NOTE: Hash_Set is a Hash_Map without the values. The slots are
+// Compact_Maybe<Key>, so the keys with a Niche (String_View, pointers)
+// take no more space than the keys themselves. Same as in Hash_Map,
+// the key that is Niche<Key>::none() is kept aside in niche_key.
+template <typename Key>
+struct Hash_Set {
+    Compact_Maybe<Key> *slots;
+    size_t capacity;
+    size_t size;
+    size_t resizes;
+    Maybe<Key> niche_key;
+
+    static const Key *slot_key(const Compact_Maybe<Key> &slot)
+    {
+        return slot.has_value() ? &slot.unwrap() : nullptr;
+    }
+
+    void extend_capacity()
+    {
+        const size_t HASH_SET_INITIAL_CAPACITY = 256;
+
+        if (slots == nullptr) {
+            assert(capacity == 0);
+            assert(size == (niche_key.has_value ? 1u : 0u));
+
+            slots = mtor.alloc<Compact_Maybe<Key>>(HASH_SET_INITIAL_CAPACITY);
+            capacity = HASH_SET_INITIAL_CAPACITY;
+        } else {
+            Hash_Set<Key> new_hash_set = {
+                mtor.alloc<Compact_Maybe<Key>>(capacity * 2),
+                capacity * 2,
+                niche_key.has_value ? 1u : 0u,
+                resizes + 1,
+                niche_key
+            };
+
+            for (size_t i = 0; i < capacity; ++i) {
+                if (slots[i].has_value()) {
+                    new_hash_set.insert(slots[i].unwrap());
+                }
+            }
+
+            mtor.dealloc(slots, capacity);
+
+            *this = new_hash_set;
+        }
+    }
+
+    // NOTE: returns true if the key was not in the set yet
+    bool insert(Key key)
+    {
+        return insert_with_hash(key, hash(key));
+    }
+
+    bool insert_with_hash(Key key, unsigned long h)
+    {
+        if (Niche<Key>::is_none(key)) {
+            if (niche_key.has_value) {
+                return false;
+            }
+            niche_key = some(key);
+            size += 1;
+            return true;
+        }
+
+        if ((size + 1) * 4 > capacity * 3) {
+            extend_capacity();
+        }
+
+        auto i = hash_table_probe(slots, capacity, key, h, slot_key);
+        if (slots[i].has_value()) {
+            return false;
+        }
+
+        slots[i].set(key);
+        size += 1;
+        return true;
+    }
+
+    // NOTE: returns false if there was no such key
+    bool remove(Key key)
+    {
+        if (Niche<Key>::is_none(key)) {
+            if (!niche_key.has_value) {
+                return false;
+            }
+            niche_key = {};
+            size -= 1;
+            return true;
+        }
+
+        auto i = hash_table_probe(slots, capacity, key, hash(key), slot_key);
+        if (i == capacity || !slots[i].has_value()) {
+            return false;
+        }
+
+        hash_table_erase(slots, capacity, i, slot_key);
+        size -= 1;
+        return true;
+    }
+
+    bool contains(Key key) const
+    {
+        return contains_with_hash(key, hash(key));
+    }
+
+    bool contains_with_hash(Key key, unsigned long h) const
+    {
+        if (Niche<Key>::is_none(key)) {
+            return niche_key.has_value;
+        }
+
+        auto i = hash_table_probe(slots, capacity, key, h, slot_key);
+        return i < capacity && slots[i].has_value();
+    }
+
+    // NOTE: copies the slots as they are, without rehashing the keys
+    Hash_Set<Key> copy() const
+    {
+        Hash_Set<Key> result = *this;
+        if (slots) {
+            result.slots = mtor.alloc<Compact_Maybe<Key>>(capacity);
+            for (size_t i = 0; i < capacity; ++i) {
+                result.slots[i] = slots[i];
+            }
+        }
+        return result;
+    }
+
+    // NOTE: f(key) for every key of the set in no particular order
+    template <typename F>
+    void for_each(F f) const
+    {
+        if (niche_key.has_value) {
+            f(niche_key.unwrap);
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            if (slots[i].has_value()) {
+                f(slots[i].unwrap());
+            }
+        }
+    }
+};
+
+template <typename Key>
+void destroy(Hash_Set<Key> hash_set)
+{
+    if (hash_set.slots) {
+        mtor.dealloc(hash_set.slots, hash_set.capacity);
+    }
+}
+
+// NOTE: both of them only walk the smaller of the sets and look its
+// keys up in the bigger one. The result has to be destroyed.
+template <typename Key>
+Hash_Set<Key> set_union(const Hash_Set<Key> &a, const Hash_Set<Key> &b)
+{
+    const Hash_Set<Key> &smaller = a.size < b.size ? a : b;
+    const Hash_Set<Key> &bigger = a.size < b.size ? b : a;
+
+    Hash_Set<Key> result = bigger.copy();
+    smaller.for_each([&](const Key &key) {
+        result.insert(key);
+    });
+    return result;
+}
+
+template <typename Key>
+Hash_Set<Key> set_intersection(const Hash_Set<Key> &a, const Hash_Set<Key> &b)
+{
+    const Hash_Set<Key> &smaller = a.size < b.size ? a : b;
+    const Hash_Set<Key> &bigger = a.size < b.size ? b : a;
+
+    Hash_Set<Key> result = {};
+    smaller.for_each([&](const Key &key) {
+        if (bigger.contains(key)) {
+            result.insert(key);
+        }
+    });
+    return result;
+}
+
+////////////////////////////////////////////////////////////
+// INTERNER
+////////////////////////////////////////////////////////////
+
+struct Interned_View {
+    String_View view;
+    unsigned long hash;
+
+    bool operator==(const Interned_View &that) const;
+    bool operator!=(const Interned_View &that) const;
+};
+
+unsigned long hash(Interned_View interned_view);
+
+// NOTE: Interner deduplicates String_Views into its own storage and
+// hands out dense ids starting from 0. The bytes of the interned
+// views never move, so Interner::view() stays valid until the
+// Interner is destroyed. Zero-initialized Interner is ready to use.
+struct Interner {
+    Hash_Map<Interned_View, uint32_t> ids;
+    Dynamic_Array<String_View> views;
+    Dynamic_Array<unsigned long> hashes;
+    Dynamic_Array<String_View> chunks;
+    size_t chunk_size;
+
+    uint32_t intern(String_View view);
+    Maybe<uint32_t> find(String_View view);
+    String_View view(uint32_t id) const;
+    unsigned long hash_of(uint32_t id) const;
+    size_t count() const;
+};
+
+void destroy(Interner interner);
+
+////////////////////////////////////////////////////////////
+// PIECE TABLE
+////////////////////////////////////////////////////////////
+
+// NOTE: Piece_Table is a text buffer for editing large texts in
+// place. The text is a sequence of pieces, each of them a String_View
+// either into the original buffer (see piece_table_of()) or into the
+// append-only add buffer that keeps copies of the inserted texts. The
+// pieces are kept in a treap ordered by their position in the text,
+// so Piece_Table::insert(), Piece_Table::remove() and the line queries
+// are O(log n) in the amount of pieces. The pieces are never longer
+// than PIECE_TABLE_MAX_PIECE_SIZE, which bounds the scanning the line
+// queries have to do inside of a single piece.
+struct Piece_Table {
+    static constexpr size_t PIECE_TABLE_MAX_PIECE_SIZE = 4 * 1024;
+
+    struct Node {
+        String_View piece;
+        size_t piece_lines;
+        size_t length;
+        size_t lines;
+        uint32_t priority;
+        Node *left;
+        Node *right;
+    };
+
+    Node *root;
+    Dynamic_Array<String_View> add_chunks;
+    size_t add_size;
+    uint32_t seed;
+
+    void insert(size_t position, String_View text);
+    void remove(size_t position, size_t count);
+
+    size_t count() const;
+    size_t lines_count() const;
+    Maybe<size_t> line_start(size_t line) const;
+    size_t line_of(size_t position) const;
+
+    template <typename F>
+    void for_each_piece(F f) const
+    {
+        for_each_piece(root, f);
+    }
+
+    template <typename F>
+    void for_each_piece(const Node *node, F f) const
+    {
+        if (node) {
+            for_each_piece(node->left, f);
+            f(node->piece);
+            for_each_piece(node->right, f);
+        }
+    }
+
+    Node *new_node(String_View piece);
+    Node *merge(Node *a, Node *b);
+    void split(Node *node, size_t position, Node **left, Node **right);
+    Node *append_pieces(Node *node, String_View text);
+};
+
+// NOTE: the Piece_Table references the original buffer without
+// copying it, so it has to outlive the Piece_Table.
+Piece_Table piece_table_of(String_View original);
+void destroy(Piece_Table piece_table);
+void print1(FILE *stream, const Piece_Table &piece_table);
+
+////////////////////////////////////////////////////////////
+// PROFILE
+////////////////////////////////////////////////////////////
+
+// NOTE: AIDS_PROFILE_ZONE("name") measures the rest of the enclosing
+// scope. The zones are recorded only if AIDS_PROFILE is defined,
+// otherwise they expand to nothing. Every thread records its zones
+// into its own ring buffer of AIDS_PROFILE_CAPACITY events, so the
+// oldest events are overwritten when the buffer is full.
+//
+//     void update(void)
+//     {
+//         AIDS_PROFILE_ZONE("update");
+//         ...
+//     }
+//
+// The recorded zones can be dumped with profile_dump_chrome_trace()
+// (chrome://tracing or https://ui.perfetto.dev/ can open the result)
+// or profile_dump_summary(). Dump them when no other thread is
+// recording zones. The name of a zone is not copied, so it has to
+// outlive the profile (a string literal is the safest bet).
+
+// NOTE: nanoseconds of a monotonic clock. It is available even without
+// AIDS_PROFILE for timing things by hand.
+uint64_t profile_now(void);
+
+#ifdef AIDS_PROFILE
+
+#ifndef AIDS_PROFILE_CAPACITY
+#define AIDS_PROFILE_CAPACITY (16 * 1024)
+#endif
+
+static_assert((AIDS_PROFILE_CAPACITY & (AIDS_PROFILE_CAPACITY - 1)) == 0,
+              "AIDS_PROFILE_CAPACITY must be a power of two");
+
+struct Profile_Zone {
+    const char *name;
+    uint64_t begin;
+};
+
+struct Profile_Event {
+    const char *name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct Profile_Thread {
+    Profile_Event *events;
+    uint64_t count;
+    uint32_t id;
+    Profile_Thread *next;
+};
+
+Profile_Zone profile_zone_begin(const char *name);
+void profile_zone_end(Profile_Zone zone);
+
+#define AIDS_PROFILE_ZONE_1(name, zone)                                 \
+    ::aids::Profile_Zone zone = ::aids::profile_zone_begin(name);       \
+    defer(::aids::profile_zone_end(zone))
+#define AIDS_PROFILE_ZONE(name) AIDS_PROFILE_ZONE_1(name, DEFER_3(_profile_zone_))
+
+void profile_dump_chrome_trace(FILE *stream);
+void profile_dump_summary(FILE *stream);
+
+#else
+
+#define AIDS_PROFILE_ZONE(name)
+
+inline void profile_dump_chrome_trace(FILE *)
+{
+}
+
+inline void profile_dump_summary(FILE *)
+{
+}
+
+#endif // AIDS_PROFILE
+
+////////////////////////////////////////////////////////////
+// THREADS
+////////////////////////////////////////////////////////////
+
+// NOTE: the threads are compiled only if AIDS_THREADS is defined,
+// since they need pthread (-lpthread) on POSIX and WaitOnAddress()
+// (synchronization.lib) on Windows.
+#ifdef AIDS_THREADS
+
+// NOTE: futex_wait() blocks while *word == expected, until one of
+// futex_wake_*() is called on the same word. It may return spuriously,
+// so the callers always recheck the word in a loop. Linux uses the
+// futex syscall, Windows uses WaitOnAddress() and the rest of the
+// platforms fall back to a mutex and a condition variable.
+void futex_wait(std::atomic<uint32_t> *word, uint32_t expected);
+void futex_wake_one(std::atomic<uint32_t> *word);
+void futex_wake_all(std::atomic<uint32_t> *word);
+
+size_t hardware_threads_count(void);
+
+// NOTE: index of the thread of a Thread_Pool that runs a task. The
+// thread that called parallel_for() is 0, the workers are 1 and up.
+typedef void (*Thread_Pool_Task)(void *context, size_t thread, size_t begin, size_t end);
+
+// NOTE: Thread_Pool runs parallel_for() and the algorithms built on
+// top of it. The range of a parallel_for() is cut into chunks of grain
+// elements, and the chunks are split evenly between the threads. A
+// thread that runs out of chunks steals half of the remaining chunks
+// of another thread. The thread calling parallel_for() participates
+// as well and returns when all of the chunks are done.
+//
+//     Thread_Pool pool = thread_pool_of(hardware_threads_count());
+//     defer(destroy(pool));
+//     parallel_for(pool, 0, n, 1024, [&](size_t begin, size_t end) {
+//         for (size_t i = begin; i < end; ++i) { ... }
+//     });
+//
+// Zero-initialized Thread_Pool runs everything on the calling thread.
+// A pool runs one parallel_for() at a time, nested or concurrent calls
+// on a busy pool run on the calling thread instead.
+struct Thread_Pool {
+    struct Impl;
+    Impl *impl;
+
+    size_t threads_count() const;
+    void run(size_t begin, size_t end, size_t grain,
+             Thread_Pool_Task task, void *context) const;
+};
+
+// NOTE: threads_count includes the calling thread, so the pool starts
+// threads_count - 1 workers.
+Thread_Pool thread_pool_of(size_t threads_count);
+void destroy(Thread_Pool pool);
+
+// NOTE: f(begin, end) processes the elements of one chunk
+template <typename F>
+void parallel_for(Thread_Pool pool, size_t begin, size_t end, size_t grain, F f)
+{
+    pool.run(begin, end, grain, [](void *context, size_t, size_t chunk_begin, size_t chunk_end) {
+        (*static_cast<F*>(context))(chunk_begin, chunk_end);
+    }, &f);
+}
+
+// NOTE: map(begin, end) reduces one chunk, reduce(a, b) combines the
+// results. reduce has to be associative and commutative, since the
+// chunks are combined in no particular order.
+template <typename T, typename Map, typename Reduce>
+T parallel_reduce(Thread_Pool pool, size_t begin, size_t end, size_t grain,
+                  T identity, Map map, Reduce reduce)
+{
+    struct Context {
+        T *partials;
+        size_t stride;
+        Map *map;
+        Reduce *reduce;
+    };
+
+    // NOTE: the partial results of the threads are a cache line apart
+    const size_t stride = (64 + sizeof(T) - 1) / sizeof(T);
+    const size_t threads = pool.threads_count();
+    Context context = {mtor.alloc<T>(threads * stride, identity), stride, &map, &reduce};
+
+    pool.run(begin, end, grain, [](void *raw, size_t thread, size_t chunk_begin, size_t chunk_end) {
+        Context *context = static_cast<Context*>(raw);
+        T *partial = &context->partials[thread * context->stride];
+        *partial = (*context->reduce)(*partial, (*context->map)(chunk_begin, chunk_end));
+    }, &context);
+
+    T result = identity;
+    for (size_t i = 0; i < threads; ++i) {
+        result = reduce(result, context.partials[i * stride]);
+    }
+    mtor.dealloc(context.partials, threads * stride);
+    return result;
+}
+
+// NOTE: finds how many of the first d elements of the stable merge of
+// a and b come from a
+template <typename T, typename Less_Than>
+size_t merge_path(const T *a, size_t a_count, const T *b, size_t b_count, size_t d, Less_Than less)
+{
+    size_t lo = d > b_count ? d - b_count : 0;
+    size_t hi = min(d, a_count);
+    while (lo < hi) {
+        const size_t i = lo + (hi - lo) / 2;
+        if (!less(b[d - i - 1], a[i])) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+// NOTE: sorts runs of the array with sort() in parallel and merges
+// them pairwise. Every merge is split into independent pieces with
+// merge_path(), so the last merges are parallel as well. It allocates
+// a temporary buffer of count elements.
+template <typename T, typename Less_Than, typename Ator = Mtor>
+void parallel_sort(Thread_Pool pool, T *data, size_t count, Less_Than less, Ator *ator = &mtor)
+{
+    const size_t PARALLEL_SORT_THRESHOLD = 16 * 1024;
+    const size_t threads = pool.threads_count();
+
+    if (threads <= 1 || count < PARALLEL_SORT_THRESHOLD) {
+        sort(data, count, less);
+        return;
+    }
+
+    size_t runs = 1;
+    while (runs < threads) {
+        runs *= 2;
+    }
+
+    auto run_begin = [count, runs](size_t run) {
+        return run * count / runs;
+    };
+
+    parallel_for(pool, 0, runs, 1, [&](size_t begin, size_t end) {
+        for (size_t run = begin; run < end; ++run) {
+            sort(data + run_begin(run), run_begin(run + 1) - run_begin(run), less);
+        }
+    });
+
+    T *buffer = ator->template alloc<T>(count);
+    T *from = data;
+    T *to = buffer;
+
+    for (size_t width = 1; width < runs; width *= 2) {
+        const size_t pairs = runs / (2 * width);
+        const size_t pieces = max((size_t) 1, 2 * threads / pairs);
+
+        parallel_for(pool, 0, pairs * pieces, 1, [&](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; ++task) {
+                const size_t pair = task / pieces;
+                const size_t piece = task % pieces;
+
+                const size_t a_begin = run_begin(2 * pair * width);
+                const size_t b_begin = run_begin((2 * pair + 1) * width);
+                const size_t b_end = run_begin((2 * pair + 2) * width);
+                const T *a = from + a_begin;
+                const T *b = from + b_begin;
+                const size_t a_count = b_begin - a_begin;
+                const size_t b_count = b_end - b_begin;
+
+                const size_t d0 = piece * (a_count + b_count) / pieces;
+                const size_t d1 = (piece + 1) * (a_count + b_count) / pieces;
+                size_t i = merge_path(a, a_count, b, b_count, d0, less);
+                size_t j = d0 - i;
+                const size_t i_end = merge_path(a, a_count, b, b_count, d1, less);
+                const size_t j_end = d1 - i_end;
+
+                T *out = to + a_begin + d0;
+                while (i < i_end && j < j_end) {
+                    *out++ = less(b[j], a[i]) ? b[j++] : a[i++];
+                }
+                while (i < i_end) *out++ = a[i++];
+                while (j < j_end) *out++ = b[j++];
+            }
+        });
+
+        swap(&from, &to);
+    }
+
+    if (from != data) {
+        parallel_for(pool, 0, count, PARALLEL_SORT_THRESHOLD, [&](size_t begin, size_t end) {
+            memcpy(data + begin, from + begin, sizeof(T) * (end - begin));
+        });
+    }
+
+    ator->dealloc(buffer, count);
+}
+
+template <typename T>
+void parallel_sort(Thread_Pool pool, T *data, size_t count)
+{
+    parallel_sort(pool, data, count, Less<T> {});
+}
+
+template <typename T, typename Less_Than, typename Ator = Mtor>
+void parallel_sort(Thread_Pool pool, Dynamic_Array<T> *array, Less_Than less, Ator *ator = &mtor)
+{
+    parallel_sort(pool, array->data, array->size, less, ator);
+}
+
+template <typename T>
+void parallel_sort(Thread_Pool pool, Dynamic_Array<T> *array)
+{
+    parallel_sort(pool, array->data, array->size);
+}
+
+#endif // AIDS_THREADS
+
+////////////////////////////////////////////////////////////
+// QUEUES
+////////////////////////////////////////////////////////////
+
+// NOTE: bounded lock-free ring buffer queues. Zero-initialized queues
+// are valid empty queues. They are too big to be copied around, so
+// keep them in static storage or inside of another struct, and keep
+// in mind that malloc() does not respect their cache line alignment.
+//
+// - SPSC_Queue is wait-free and supports exactly one producer thread
+//   and one consumer thread.
+// - MPMC_Queue supports any amount of producers and consumers. It is
+//   Dmitry Vyukov's bounded MPMC queue: every cell has a sequence
+//   number that tells whether it's ready to be written or read on the
+//   current lap, so the producers and the consumers only contend on
+//   the position they claim.
+//
+// push() returns false if the queue is full, pop() returns None if it
+// is empty. push_many() and pop_many() move as many items as they can
+// in one go and return the amount they moved. Blocking_Queue wraps any
+// of them to wait instead, it needs AIDS_THREADS.
+
+const size_t QUEUE_CACHE_LINE = 64;
+
+#ifdef _MSC_VER
+#pragma warning(push)
+// NOTE: structure was padded due to alignment specifier
+#pragma warning(disable: 4324)
+#endif // _MSC_VER
+
+template <typename T, size_t Capacity>
+struct SPSC_Queue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SPSC_Queue capacity must be a power of two");
+
+    typedef T Item;
+
+    // NOTE: each side keeps a cached copy of the other side's position
+    // and rereads the shared one only when the cached one says the
+    // queue is full (or empty).
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> head;
+    size_t cached_tail;
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> tail;
+    size_t cached_head;
+    alignas(QUEUE_CACHE_LINE) T items[Capacity];
+
+    size_t push_many(const T *new_items, size_t count)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (Capacity - (t - cached_head) < count) {
+            cached_head = head.load(std::memory_order_acquire);
+        }
+
+        count = min(count, Capacity - (t - cached_head));
+        for (size_t i = 0; i < count; ++i) {
+            items[(t + i) & (Capacity - 1)] = new_items[i];
+        }
+
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t pop_many(T *popped_items, size_t count)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (cached_tail - h < count) {
+            cached_tail = tail.load(std::memory_order_acquire);
+        }
+
+        count = min(count, cached_tail - h);
+        for (size_t i = 0; i < count; ++i) {
+            popped_items[i] = items[(h + i) & (Capacity - 1)];
+        }
+
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    bool push(T item)
+    {
+        return push_many(&item, 1) == 1;
+    }
+
+    Maybe<T> pop()
+    {
+        Maybe<T> result = {};
+        result.has_value = pop_many(&result.unwrap, 1) == 1;
+        return result;
+    }
+};
+
+template <typename T, size_t Capacity>
+struct MPMC_Queue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "MPMC_Queue capacity must be a power of two");
+
+    typedef T Item;
+
+    // NOTE: the sequence of the cell i is stored as sequence - i, so
+    // the zero-initialized cells have the initial sequence numbers of
+    // Vyukov's queue. The cell at position pos is ready to be written
+    // when its sequence is pos and ready to be read when it is pos + 1.
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> enqueue_position;
+    alignas(QUEUE_CACHE_LINE) std::atomic<size_t> dequeue_position;
+    alignas(QUEUE_CACHE_LINE) Cell cells[Capacity];
+
+    size_t sequence(size_t position) const
+    {
+        const size_t index = position & (Capacity - 1);
+        return cells[index].sequence.load(std::memory_order_acquire) + index;
+    }
+
+    void set_sequence(size_t position, size_t value)
+    {
+        const size_t index = position & (Capacity - 1);
+        cells[index].sequence.store(value - index, std::memory_order_release);
+    }
+
+    // NOTE: the cells that are ready for the claimed positions stay
+    // ready until whoever claimed them is done, so it's enough to check
+    // them before claiming the whole run with one compare-exchange.
+    size_t push_many(const T *items, size_t count)
+    {
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        while (true) {
+            size_t ready = 0;
+            while (ready < count && sequence(position + ready) == position + ready) {
+                ready += 1;
+            }
+
+            if (ready == 0) {
+                const size_t current = enqueue_position.load(std::memory_order_relaxed);
+                if (current == position) {
+                    return 0;
+                }
+                position = current;
+                continue;
+            }
+
+            if (enqueue_position.compare_exchange_weak(position, position + ready,
+                    std::memory_order_relaxed)) {
+                for (size_t i = 0; i < ready; ++i) {
+                    cells[(position + i) & (Capacity - 1)].item = items[i];
+                    set_sequence(position + i, position + i + 1);
+                }
+                return ready;
+            }
+        }
+    }
+
+    size_t pop_many(T *items, size_t count)
+    {
+        size_t position = dequeue_position.load(std::memory_order_relaxed);
+        while (true) {
+            size_t ready = 0;
+            while (ready < count && sequence(position + ready) == position + ready + 1) {
+                ready += 1;
+            }
+
+            if (ready == 0) {
+                const size_t current = dequeue_position.load(std::memory_order_relaxed);
+                if (current == position) {
+                    return 0;
+                }
+                position = current;
+                continue;
+            }
+
+            if (dequeue_position.compare_exchange_weak(position, position + ready,
+                    std::memory_order_relaxed)) {
+                for (size_t i = 0; i < ready; ++i) {
+                    items[i] = cells[(position + i) & (Capacity - 1)].item;
+                    set_sequence(position + i, position + i + Capacity);
+                }
+                return ready;
+            }
+        }
+    }
+
+    bool push(T item)
+    {
+        return push_many(&item, 1) == 1;
+    }
+
+    Maybe<T> pop()
+    {
+        Maybe<T> result = {};
+        result.has_value = pop_many(&result.unwrap, 1) == 1;
+        return result;
+    }
+};
+
+// NOTE: waits on a futex when the queue is full (or empty). The
+// waiting counters let push() and pop() skip the wake up syscall when
+// nobody is waiting. After close() push() fails right away and pop()
+// fails once the queue is drained, which lets the consumers of a
+// pipeline stage know that the producers are done.
+#ifdef AIDS_THREADS
+template <typename Queue>
+struct Blocking_Queue {
+    typedef typename Queue::Item Item;
+
+    Queue queue;
+    alignas(QUEUE_CACHE_LINE) std::atomic<uint32_t> pushes;
+    std::atomic<uint32_t> push_waiters;
+    alignas(QUEUE_CACHE_LINE) std::atomic<uint32_t> pops;
+    std::atomic<uint32_t> pop_waiters;
+    std::atomic<bool> closed;
+
+    void notify(std::atomic<uint32_t> *counter, std::atomic<uint32_t> *waiters)
+    {
+        counter->fetch_add(1);
+        if (waiters->load() > 0) {
+            futex_wake_all(counter);
+        }
+    }
+
+    bool push(Item item)
+    {
+        while (true) {
+            if (closed.load()) {
+                return false;
+            }
+
+            if (queue.push(item)) {
+                notify(&pushes, &pop_waiters);
+                return true;
+            }
+
+            push_waiters.fetch_add(1);
+            const uint32_t seen = pops.load();
+            if (queue.push(item)) {
+                push_waiters.fetch_sub(1);
+                notify(&pushes, &pop_waiters);
+                return true;
+            }
+            if (!closed.load()) {
+                futex_wait(&pops, seen);
+            }
+            push_waiters.fetch_sub(1);
+        }
+    }
+
+    Maybe<Item> pop()
+    {
+        while (true) {
+            Maybe<Item> item = queue.pop();
+            if (item.has_value) {
+                notify(&pops, &push_waiters);
+                return item;
+            }
+
+            if (closed.load()) {
+                // NOTE: the items pushed right before close()
+                item = queue.pop();
+                if (item.has_value) {
+                    notify(&pops, &push_waiters);
+                }
+                return item;
+            }
+
+            pop_waiters.fetch_add(1);
+            const uint32_t seen = pushes.load();
+            item = queue.pop();
+            if (item.has_value) {
+                pop_waiters.fetch_sub(1);
+                notify(&pops, &push_waiters);
+                return item;
+            }
+            if (!closed.load()) {
+                futex_wait(&pushes, seen);
+            }
+            pop_waiters.fetch_sub(1);
+        }
+    }
+
+    void close()
+    {
+        closed.store(true);
+        pushes.fetch_add(1);
+        pops.fetch_add(1);
+        futex_wake_all(&pushes);
+        futex_wake_all(&pops);
+    }
+};
+#endif // AIDS_THREADS
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif // _MSC_VER
+}
+
+#endif  // AIDS_HPP_
+
+#ifdef AIDS_IMPLEMENTATION
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif // _WIN32
+
+#ifdef AIDS_THREADS
+#  ifdef _WIN32
+#    ifdef _MSC_VER
+#      pragma comment(lib, "synchronization.lib")
+#    endif
+#  else
+#    include <pthread.h>
+#    include <unistd.h>
+#    ifdef __linux__
+#      include <linux/futex.h>
+#      include <sys/syscall.h>
+#    endif
+#  endif // _WIN32
+#endif // AIDS_THREADS
+
+namespace aids
+{
+
+Mtor mtor;
+
+[[nodiscard]]
+String_View String_View::trim_begin(void) const
+{
+    String_View view = *this;
+
+    while (view.count != 0 && isspace(*view.data)) {
+        view.data  += 1;
+        view.count -= 1;
+    }
+    return view;
+}
+
+[[nodiscard]]
+String_View String_View::trim_end(void) const
+{
+    String_View view = *this;
+
+    while (view.count != 0 && isspace(*(view.data + view.count - 1))) {
+        view.count -= 1;
+    }
+    return view;
+}
+
+[[nodiscard]]
+String_View String_View::trim(void) const
+{
+    return trim_begin().trim_end();
+}
+
+String_View String_View::chop_left(size_t n)
+{
+    if (n > count) {
+        n = count;
+    }
+
+    String_View result = {n, data};
+    data  += n;
+    count -= n;
+
+    return result;
+}
+
+String_View String_View::chop_right(size_t n)
+{
+    if (n > count) {
+        n = count;
+    }
+
+    String_View result = {n, data + count - n};
+
+    count -= n;
+
+    return result;
+}
+
+void String_View::chop_back(size_t n)
+{
+    count -= n < count ? n : count;
+}
+
+void String_View::chop(size_t n)
+{
+    if (n > count) {
+        data += count;
+        count = 0;
+    } else {
+        data  += n;
+        count -= n;
+    }
+}
+
+void String_View::grow(size_t n)
+{
+    count += n;
+}
+
+String_View String_View::chop_while(Predicate_Char predicate)
+{
+    size_t size = 0;
+    while (size < count && predicate(data[size])) {
+        size += 1;
+    }
+
+    auto result = subview(0, size);
+    chop_left(size);
+    return result;
+}
+
+String_View String_View::chop_by_delim(char delim)
+{
+    assert(data);
+
+    size_t i = 0;
+    while (i < count && data[i] != delim) i++;
+    String_View result = {i, data};
+    chop_left(i + 1);
+
+    return result;
+}
+
+String_View String_View::chop_word(void)
+{
+    *this = trim_begin();
+
+    size_t i = 0;
+    while (i < count && !isspace(data[i])) i++;
+
+    String_View result = { i, data };
+
+    count -= i;
+    data  += i;
+
+    return result;
+}
+
+Maybe<float> String_View::as_float() const
+{
+    char buffer[300] = {};
+    memcpy(buffer, data, min(sizeof(buffer) - 1, count));
+    char *endptr = NULL;
+    float result = strtof(buffer, &endptr);
+
+    if (buffer > endptr || (size_t) (endptr - buffer) != count) {
+        return {};
+    }
+
+    return some(result);
+}
+
+String_View String_View::subview(size_t start, size_t count) const
+{
+    if (start + count <= this->count) {
+        return {count, data + start};
+    }
+
+    return {};
+}
+
+// NOTE: memcmp() compares the bytes as unsigned char, which for
+// UTF-8 is the same as comparing the code points.
+bool String_View::operator<(String_View b) const
+{
+    size_t n = min(count, b.count);
+    int result = n > 0 ? memcmp(data, b.data, n) : 0;
+    if (result != 0) {
+        return result < 0;
+    }
+
+    return count < b.count;
+}
+
+bool String_View::operator==(String_View view) const
+{
+    if (this->count != view.count) return false;
+    return memcmp(this->data, view.data, this->count) == 0;
+}
+
+bool String_View::operator!=(String_View view) const
+{
+    return !(*this == view);
+}
+
+bool String_View::has_prefix(String_View prefix) const
+{
+    return prefix.count <= this->count
+           && this->subview(0, prefix.count) == prefix;
+}
+
+bool String_View::has_suffix(String_View suffix) const
+{
+    return suffix.count <= this->count
+           && this->subview(this->count - suffix.count, suffix.count) == suffix;
+}
+
+size_t String_View::count_chars(char x) const
+{
+    size_t result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (data[i] == x) {
+            result += 1;
+        }
+    }
+    return result;
+}
+
+String_View operator ""_sv(const char *data, size_t count)
+{
+    return {count, data};
+}
+
+String_View cstr_as_string_view(const char *cstr)
+{
+    return {strlen(cstr), cstr};
+}
+
+void print1(FILE *stream, String_View view)
+{
+    fwrite(view.data, 1, view.count, stream);
+}
+
+void destroy(String_View sv)
+{
+    mtor.dealloc(sv.data, sv.count);
+}
+
+char *Args::shift()
+{
+    char *result = *argv;
+    argv += 1;
+    argc -= 1;
+    return result;
+}
+
+bool Args::empty()
+{
+    return argc == 0;
+}
+
+String_View String_Buffer::view() const
+{
+    return {size, data};
+}
+
+void sprint1(String_Buffer *buffer, const char *cstr)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%s", cstr);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, String_View view)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%.*s", (int) view.count, view.data);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, char c)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%c", c);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, float f)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%f", f);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, unsigned long long x)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%llu", x);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, unsigned int x)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%u", x);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, long unsigned int x)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%lu", x);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, int x)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%d", x);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, long int x)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%ld", x);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+void sprint1(String_Buffer *buffer, bool b)
+{
+    sprint1(buffer, b ? "true" : "false");
+}
+
+void sprint1(String_Buffer *buffer, Pad pad)
+{
+    for (size_t i = 0; i < pad.n; ++i) {
+        sprint1(buffer, pad.c);
+    }
+}
+
+void sprint1(String_Buffer *buffer, Fixed fixed)
+{
+    int n = snprintf(
+                buffer->data + buffer->size,
+                buffer->capacity - buffer->size,
+                "%*.*f", fixed.width, fixed.precision, fixed.unwrap);
+    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+}
+
+template <typename Sink>
+static void utf8_caps_chunks(String_View view, Sink sink);
+
+void sprint1(String_Buffer *buffer, Caps caps)
+{
+    utf8_caps_chunks(caps.unwrap, [buffer](String_View chunk) {
+        sprint1(buffer, chunk);
+    });
+}
+
+void sprint1(String_Buffer *buffer, String_Buffer another_buffer)
+{
+    sprint1(buffer, another_buffer.view());
+}
+
+////////////////////////////////////////////////////////////
+// PRINT
+////////////////////////////////////////////////////////////
+
+void print1(FILE *stream, const char *s)
+{
+    fwrite(s, 1, strlen(s), stream);
+}
+
+void print1(FILE *stream, char *s)
+{
+    fwrite(s, 1, strlen(s), stream);
+}
+
+void print1(FILE *stream, char c)
+{
+    fputc(c, stream);
+}
+
+void print1(FILE *stream, float f)
+{
+    fprintf(stream, "%f", f);
+}
+
+void print1(FILE *stream, unsigned long long x)
+{
+    fprintf(stream, "%llu", x);
+}
+
+void print1(FILE *stream, long unsigned int x)
+{
+    fprintf(stream, "%lu", x);
+}
+
+void print1(FILE *stream, unsigned int x)
+{
+    fprintf(stream, "%u", x);
+}
+
+void print1(FILE *stream, int x)
+{
+    fprintf(stream, "%d", x);
+}
+
+void print1(FILE *stream, long int x)
+{
+    fprintf(stream, "%ld", x);
+}
+
+void print1(FILE *stream, bool b)
+{
+    print1(stream, b ? "true" : "false");
+}
+
+void print1(FILE *stream, Escape escape)
+{
+    print(stream, escape);
+}
+
+void print1(FILE *stream, Json_Escape escape)
+{
+    print(stream, escape);
+}
+
+void print1(FILE *stream, Pad pad)
+{
+    for (size_t i = 0; i < pad.n; ++i) {
+        fputc(pad.c, stream);
+    }
+}
+
+void print1(FILE *stream, Fixed fixed)
+{
+    fprintf(stream, "%*.*f", fixed.width, fixed.precision, fixed.unwrap);
+}
+
+void print1(FILE *stream, Caps caps)
+{
+    utf8_caps_chunks(caps.unwrap, [stream](String_View chunk) {
+        print1(stream, chunk);
+    });
+}
+
+void print1(FILE *stream, String_Buffer buffer)
+{
+    print1(stream, buffer.view());
+}
+
+char *Print_Buffer::reserve(size_t n)
+{
+    if (size + n > items_capacity()) {
+        const size_t new_capacity = max(size + n, 2 * items_capacity());
+        char *new_heap = mtor.alloc<char>(new_capacity);
+        memcpy(new_heap, items(), size);
+        if (heap) {
+            mtor.dealloc(heap, capacity);
+        }
+        heap = new_heap;
+        capacity = new_capacity;
+    }
+
+    return items() + size;
+}
+
+void Print_Buffer::write(const char *data, size_t n)
+{
+    memcpy(reserve(n), data, n);
+    size += n;
+}
+
+void Print_Buffer::flush()
+{
+    if (size > 0) {
+        fwrite(items(), 1, size, stream);
+        size = 0;
+    }
+}
+
+void Print_Buffer::lock()
+{
+    if (!locked) {
+#ifdef _WIN32
+        _lock_file(stream);
+#else
+        flockfile(stream);
+#endif // _WIN32
+        locked = true;
+    }
+}
+
+void Print_Buffer::start(FILE *stream, size_t expected_size)
+{
+    this->stream = stream;
+    heap = nullptr;
+    size = 0;
+    capacity = 0;
+    locked = false;
+    reserve(expected_size);
+}
+
+void Print_Buffer::finish()
+{
+    flush();
+    if (locked) {
+#ifdef _WIN32
+        _unlock_file(stream);
+#else
+        funlockfile(stream);
+#endif // _WIN32
+        locked = false;
+    }
+    if (heap) {
+        mtor.dealloc(heap, capacity);
+    }
+    heap = nullptr;
+}
+
+// NOTE: the digits are produced backwards from the end of digits
+static void print_buffer_decimal(Print_Buffer *buffer, unsigned long long x, bool negative)
+{
+    char digits[Print_Max_Size<unsigned long long>::value + 1];
+    size_t begin = sizeof(digits);
+    do {
+        digits[--begin] = (char) ('0' + x % 10);
+        x /= 10;
+    } while (x > 0);
+
+    if (negative) {
+        digits[--begin] = '-';
+    }
+
+    buffer->write(digits + begin, sizeof(digits) - begin);
+}
+
+void print1(Print_Buffer *buffer, const char *s)
+{
+    buffer->write(s, strlen(s));
+}
+
+void print1(Print_Buffer *buffer, char *s)
+{
+    buffer->write(s, strlen(s));
+}
+
+void print1(Print_Buffer *buffer, char c)
+{
+    *buffer->reserve(1) = c;
+    buffer->size += 1;
+}
+
+void print1(Print_Buffer *buffer, float f)
+{
+    const size_t n = Print_Max_Size<float>::value + 1;
+    const int size = snprintf(buffer->reserve(n), n, "%f", f);
+    if (size > 0) {
+        buffer->size += min((size_t) size, n - 1);
+    }
+}
+
+void print1(Print_Buffer *buffer, unsigned long long x)
+{
+    print_buffer_decimal(buffer, x, false);
+}
+
+void print1(Print_Buffer *buffer, long unsigned int x)
+{
+    print_buffer_decimal(buffer, x, false);
+}
+
+void print1(Print_Buffer *buffer, unsigned int x)
+{
+    print_buffer_decimal(buffer, x, false);
+}
+
+void print1(Print_Buffer *buffer, int x)
+{
+    print_buffer_decimal(buffer, x < 0 ? 0ull - (unsigned long long) x : (unsigned long long) x, x < 0);
+}
+
+void print1(Print_Buffer *buffer, long int x)
+{
+    print_buffer_decimal(buffer, x < 0 ? 0ull - (unsigned long long) x : (unsigned long long) x, x < 0);
+}
+
+void print1(Print_Buffer *buffer, bool b)
+{
+    print1(buffer, b ? "true" : "false");
+}
+
+void print1(Print_Buffer *buffer, String_View view)
+{
+    buffer->write(view.data, view.count);
+}
+
+#if defined(AIDS_SSE2)
+// NOTE: skips the whole 16-byte blocks in which the predicate is 0
+// for every byte. The exact position of the first byte to escape is
+// left for the scalar loop.
+template <typename Predicate>
+static void escape_skip_sse2(const uint8_t *bytes, size_t count, size_t *i, Predicate predicate)
+{
+    for (; *i + 16 <= count; *i += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + *i));
+        if (_mm_movemask_epi8(predicate(input)) != 0) {
+            break;
+        }
+    }
+}
+#endif // AIDS_SSE2
+
+#if defined(AIDS_AVX2)
+template <typename Predicate>
+static void escape_skip_avx2(const uint8_t *bytes, size_t count, size_t *i, Predicate predicate)
+{
+    for (; *i + 32 <= count; *i += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + *i));
+        if (_mm256_movemask_epi8(predicate(input)) != 0) {
+            break;
+        }
+    }
+}
+#endif // AIDS_AVX2
+
+// NOTE: '\a'..'\r' are the only bytes below 7 after subtracting '\a'
+static bool escape_needed(uint8_t c)
+{
+    return (uint8_t) (c - '\a') <= '\r' - '\a';
+}
+
+// NOTE: the amount of leading bytes that are printed as is
+static size_t escape_prefix(String_View view)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+    size_t i = 0;
+
+#if defined(AIDS_AVX2)
+    escape_skip_avx2(bytes, view.count, &i, [](__m256i input) {
+        const __m256i shifted = _mm256_sub_epi8(input, _mm256_set1_epi8('\a'));
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\a')), shifted);
+    });
+#endif // AIDS_AVX2
+
+#if defined(AIDS_SSE2)
+    escape_skip_sse2(bytes, view.count, &i, [](__m128i input) {
+        const __m128i shifted = _mm_sub_epi8(input, _mm_set1_epi8('\a'));
+        return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\a')), shifted);
+    });
+#endif // AIDS_SSE2
+
+    while (i < view.count && !escape_needed(bytes[i])) {
+        i += 1;
+    }
+
+    return i;
+}
+
+static bool json_escape_needed(uint8_t c)
+{
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+static size_t json_escape_prefix(String_View view)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+    size_t i = 0;
+
+#if defined(AIDS_AVX2)
+    escape_skip_avx2(bytes, view.count, &i, [](__m256i input) {
+        const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(input, _mm256_set1_epi8(0x1F)), input);
+        const __m256i quote = _mm256_cmpeq_epi8(input, _mm256_set1_epi8('"'));
+        const __m256i backslash = _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\\'));
+        return _mm256_or_si256(control, _mm256_or_si256(quote, backslash));
+    });
+#endif // AIDS_AVX2
+
+#if defined(AIDS_SSE2)
+    escape_skip_sse2(bytes, view.count, &i, [](__m128i input) {
+        const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(input, _mm_set1_epi8(0x1F)), input);
+        const __m128i quote = _mm_cmpeq_epi8(input, _mm_set1_epi8('"'));
+        const __m128i backslash = _mm_cmpeq_epi8(input, _mm_set1_epi8('\\'));
+        return _mm_or_si128(control, _mm_or_si128(quote, backslash));
+    });
+#endif // AIDS_SSE2
+
+    while (i < view.count && !json_escape_needed(bytes[i])) {
+        i += 1;
+    }
+
+    return i;
+}
+
+void print1(Print_Buffer *buffer, Escape escape)
+{
+    String_View view = escape.unwrap;
+    for (;;) {
+        const size_t n = escape_prefix(view);
+        buffer->write(view.data, n);
+        if (n == view.count) {
+            break;
+        }
+
+        const char escaped[2] = {'\\', "abtnvfr"[view.data[n] - '\a']};
+        buffer->write(escaped, sizeof(escaped));
+        view.chop_left(n + 1);
+    }
+}
+
+void print1(Print_Buffer *buffer, Json_Escape escape)
+{
+    String_View view = escape.unwrap;
+    for (;;) {
+        const size_t n = json_escape_prefix(view);
+        buffer->write(view.data, n);
+        if (n == view.count) {
+            break;
+        }
+
+        const uint8_t c = (uint8_t) view.data[n];
+        switch (c) {
+        case '"':
+            buffer->write("\\\"", 2);
+            break;
+        case '\\':
+            buffer->write("\\\\", 2);
+            break;
+        case '\b':
+            buffer->write("\\b", 2);
+            break;
+        case '\f':
+            buffer->write("\\f", 2);
+            break;
+        case '\n':
+            buffer->write("\\n", 2);
+            break;
+        case '\r':
+            buffer->write("\\r", 2);
+            break;
+        case '\t':
+            buffer->write("\\t", 2);
+            break;
+        default: {
+            const char *digits = "0123456789abcdef";
+            const char escaped[6] = {'\\', 'u', '0', '0', digits[c >> 4], digits[c & 0xF]};
+            buffer->write(escaped, sizeof(escaped));
+        }
+        }
+        view.chop_left(n + 1);
+    }
+}
+
+void print1(Print_Buffer *buffer, Pad pad)
+{
+    memset(buffer->reserve(pad.n), pad.c, pad.n);
+    buffer->size += pad.n;
+}
+
+void print1(Print_Buffer *buffer, Fixed fixed)
+{
+    const int size = snprintf(nullptr, 0, "%*.*f", fixed.width, fixed.precision, fixed.unwrap);
+    if (size > 0) {
+        snprintf(buffer->reserve((size_t) size + 1), (size_t) size + 1,
+                 "%*.*f", fixed.width, fixed.precision, fixed.unwrap);
+        buffer->size += (size_t) size;
+    }
+}
+
+void print1(Print_Buffer *buffer, Caps caps)
+{
+    utf8_caps_chunks(caps.unwrap, [buffer](String_View chunk) {
+        print1(buffer, chunk);
+    });
+}
+
+void print1(Print_Buffer *buffer, String_Buffer another_buffer)
+{
+    print1(buffer, another_buffer.view());
+}
+
+////////////////////////////////////////////////////////////
+// UTF-8
+////////////////////////////////////////////////////////////
+
+String_View Utf8_Char::view()
+{
+    String_View result = {
+        count,
+        reinterpret_cast<const char *>(bytes)
+    };
+
+    return result;
+}
+
+void print1(FILE *stream, Utf8_Char uchar)
+{
+    print(stream, String_View {uchar.count, reinterpret_cast<const char*>(uchar.bytes)});
+}
+
+void print1(Print_Buffer *buffer, Utf8_Char uchar)
+{
+    buffer->write(reinterpret_cast<const char*>(uchar.bytes), uchar.count);
+}
+
+Utf8_Char code_to_utf8(uint32_t code)
+{
+    if (/*0x0000 <= code && */code <= 0x007F) {
+        // 0xxxxxxx
+        // 1 byte
+        return Utf8_Char {
+            {(uint8_t) code, 0, 0, 0},
+            1,
+        };
+    } else if (0x0080 <= code && code <= 0x07FF) {
+        // 110xxxxx 10xxxxxx
+        // 2 bytes
+        return Utf8_Char {
+            {
+                (uint8_t) (((code & 0b00111111000000) >> 6) | 0b11000000),
+                (uint8_t) (((code & 0b00000000111111) >> 0) | 0b10000000),
+                0,
+                0
+            },
+            2
+        };
+    } else if (0x0800 <= code && code <= 0xFFFF) {
+        // 3 bytes
+        // 1110xxxx 10xxxxxx 10xxxxxx
+        return Utf8_Char {
+            {
+                (uint8_t) (((code & 0b1111000000000000) >> 12) | 0b11100000),
+                (uint8_t) (((code & 0b0000111111000000) >> 6)  | 0b10000000),
+                (uint8_t) (((code & 0b0000000000111111) >> 0)  | 0b10000000),
+                0
+            },
+            3
+        };
+    } else if (0x10000 <= code && code <= 0x10FFFF) {
+        // 4 bytes
+        // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+        return Utf8_Char {
+            {
+                (uint8_t) (((code & 0b111000000000000000000) >> 18) | 0b11110000),
+                (uint8_t) (((code & 0b000111111000000000000) >> 12) | 0b10000000),
+                (uint8_t) (((code & 0b000000000111111000000) >> 6)  | 0b10000000),
+                (uint8_t) (((code & 0b000000000000000111111) >> 0)  | 0b10000000),
+            },
+            4
+        };
+    }
+
+    panic("The code ", code, " point is too big");
+}
+
+// NOTE: decodes a single code point from the beginning of the bytes.
+// Returns the size of the sequence or 0 if it's not well-formed.
+static inline size_t utf8_decode_one(const uint8_t *bytes, size_t count, uint32_t *code)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    if (bytes[0] < 0x80) {
+        // 0xxxxxxx
+        *code = bytes[0];
+        return 1;
+    }
+
+    // NOTE: the ranges of the second byte are narrowed down for some
+    // of the lead bytes to reject overlong sequences (E0, F0), the
+    // UTF-16 surrogates (ED) and the codes above 0x10FFFF (F4).
+    size_t n = 0;
+    uint32_t result = 0;
+    uint8_t low = 0x80;
+    uint8_t high = 0xBF;
+
+    if (0xC2 <= bytes[0] && bytes[0] <= 0xDF) {
+        // 110xxxxx 10xxxxxx
+        n = 2;
+        result = bytes[0] & 0x1F;
+    } else if (0xE0 <= bytes[0] && bytes[0] <= 0xEF) {
+        // 1110xxxx 10xxxxxx 10xxxxxx
+        n = 3;
+        result = bytes[0] & 0x0F;
+        if (bytes[0] == 0xE0) low = 0xA0;
+        if (bytes[0] == 0xED) high = 0x9F;
+    } else if (0xF0 <= bytes[0] && bytes[0] <= 0xF4) {
+        // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+        n = 4;
+        result = bytes[0] & 0x07;
+        if (bytes[0] == 0xF0) low = 0x90;
+        if (bytes[0] == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+
+    if (count < n || bytes[1] < low || high < bytes[1]) {
+        return 0;
+    }
+    result = (result << 6) | (bytes[1] & 0x3F);
+
+    for (size_t i = 2; i < n; ++i) {
+        if ((bytes[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        result = (result << 6) | (bytes[i] & 0x3F);
+    }
+
+    *code = result;
+    return n;
+}
+
+// NOTE: encodes a single code point. Returns the size of the sequence
+// or 0 if the code is a surrogate or is above 0x10FFFF.
+static inline size_t utf8_encode_one(uint32_t code, uint8_t *bytes)
+{
+    if (code < 0x80) {
+        bytes[0] = (uint8_t) code;
+        return 1;
+    } else if (code < 0x800) {
+        bytes[0] = (uint8_t) (0xC0 | (code >> 6));
+        bytes[1] = (uint8_t) (0x80 | (code & 0x3F));
+        return 2;
+    } else if (code < 0x10000) {
+        if (0xD800 <= code && code <= 0xDFFF) {
+            return 0;
+        }
+        bytes[0] = (uint8_t) (0xE0 | (code >> 12));
+        bytes[1] = (uint8_t) (0x80 | ((code >> 6) & 0x3F));
+        bytes[2] = (uint8_t) (0x80 | (code & 0x3F));
+        return 3;
+    } else if (code <= 0x10FFFF) {
+        bytes[0] = (uint8_t) (0xF0 | (code >> 18));
+        bytes[1] = (uint8_t) (0x80 | ((code >> 12) & 0x3F));
+        bytes[2] = (uint8_t) (0x80 | ((code >> 6) & 0x3F));
+        bytes[3] = (uint8_t) (0x80 | (code & 0x3F));
+        return 4;
+    }
+
+    return 0;
+}
+
+Maybe<uint32_t> utf8_get_code(String_View view, size_t *size)
+{
+    uint32_t code = 0;
+    size_t n = utf8_decode_one(reinterpret_cast<const uint8_t*>(view.data), view.count, &code);
+    if (n == 0) {
+        return {};
+    }
+
+    *size = n;
+    return some(code);
+}
+
+#if defined(AIDS_SSSE3)
+
+// NOTE: the lookup algorithm from "Validating UTF-8 In Less Than One
+// Instruction Per Byte" by John Keiser and Daniel Lemire
+// (https://arxiv.org/abs/2010.03090). Every pair of adjacent bytes is
+// classified by three 16-entry tables indexed by the high and low
+// nibbles of the first byte and the high nibble of the second one.
+// The bits of the tables correspond to the error kinds below, and a
+// pair is invalid when all three lookups agree on at least one of
+// them. The third and fourth bytes of the 3- and 4-byte sequences are
+// checked separately by looking two and three bytes back.
+const uint8_t UTF8_TOO_SHORT      = 1 << 0; // 11______ 0_______, 11______ 11______
+const uint8_t UTF8_TOO_LONG       = 1 << 1; // 0_______ 10______
+const uint8_t UTF8_OVERLONG_3     = 1 << 2; // 11100000 100_____
+const uint8_t UTF8_TOO_LARGE      = 1 << 3; // 11110100 1001____, 11110100 101_____, 111101__ 1001____, ...
+const uint8_t UTF8_SURROGATE      = 1 << 4; // 11101101 101_____
+const uint8_t UTF8_OVERLONG_2     = 1 << 5; // 1100000_ 10______
+const uint8_t UTF8_TOO_LARGE_1000 = 1 << 6; // 11110101 1000____, 1111011_ 1000____, 11111___ 1000____
+const uint8_t UTF8_OVERLONG_4     = 1 << 6; // 11110000 1000____
+const uint8_t UTF8_TWO_CONTS      = 1 << 7; // 10______ 10______
+const uint8_t UTF8_CARRY          = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS;
+
+const uint8_t utf8_byte_1_high_table[16] = {
+    // 0_______ ________
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    // 10______ ________
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    // 1100____ ________
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    // 1101____ ________
+    UTF8_TOO_SHORT,
+    // 1110____ ________
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    // 1111____ ________
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+
+const uint8_t utf8_byte_1_low_table[16] = {
+    // ____0000 ________
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    // ____0001 ________
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    // ____001_ ________
+    UTF8_CARRY,
+    UTF8_CARRY,
+    // ____0100 ________
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    // ____0101 ________
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    // ____011_ ________
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    // ____1___ ________
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    // ____1101 ________
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+};
+
+const uint8_t utf8_byte_2_high_table[16] = {
+    // ________ 0_______
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    // ________ 1000____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    // ________ 1001____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+    // ________ 101_____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    // ________ 11______
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+
+#if defined(AIDS_AVX2)
+
+// NOTE: the last bytes of a block that can't end a block without
+// being followed by continuation bytes are bigger than these.
+const uint8_t utf8_incomplete_table[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+static __m256i utf8_lookup_table_avx2(const uint8_t table[16])
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+static bool utf8_validate_avx2(const uint8_t *bytes, size_t count)
+{
+    const __m256i byte_1_high_table = utf8_lookup_table_avx2(utf8_byte_1_high_table);
+    const __m256i byte_1_low_table  = utf8_lookup_table_avx2(utf8_byte_1_low_table);
+    const __m256i byte_2_high_table = utf8_lookup_table_avx2(utf8_byte_2_high_table);
+    const __m256i incomplete = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf8_incomplete_table));
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+
+    // NOTE: the tail is validated as a zero-padded block and one more
+    // zero block follows it, so a sequence cut off at the very end is
+    // reported as too short.
+    uint8_t tail[32] = {};
+    size_t blocks = count / 32 + 1;
+
+    for (size_t block = 0; block <= blocks; ++block) {
+        __m256i input;
+        if (block + 1 < blocks) {
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + block * 32));
+        } else if (block + 1 == blocks) {
+            memcpy(tail, bytes + block * 32, count % 32);
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail));
+        } else {
+            input = _mm256_setzero_si256();
+        }
+
+        if (_mm256_movemask_epi8(input) == 0) {
+            // NOTE: ASCII fast path
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_incomplete = _mm256_setzero_si256();
+        } else {
+            __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(input, shifted, 16 - 1);
+            __m256i prev2 = _mm256_alignr_epi8(input, shifted, 16 - 2);
+            __m256i prev3 = _mm256_alignr_epi8(input, shifted, 16 - 3);
+
+            __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble_mask));
+            __m256i byte_1_low  = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble_mask));
+            __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask));
+            __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+            __m256i is_third_byte  = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char) (0xE0 - 0x80)));
+            __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char) (0xF0 - 0x80)));
+            __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8((char) 0x80));
+
+            error = _mm256_or_si256(error, _mm256_xor_si256(must_be_continuation, special_cases));
+            prev_incomplete = _mm256_subs_epu8(input, incomplete);
+        }
+
+        prev_input = input;
+    }
+
+    return _mm256_testz_si256(error, error);
+}
+
+#else
+
+// NOTE: the last bytes of a block that can't end a block without
+// being followed by continuation bytes are bigger than these.
+const uint8_t utf8_incomplete_table[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+static bool utf8_validate_ssse3(const uint8_t *bytes, size_t count)
+{
+    const __m128i byte_1_high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8_byte_1_high_table));
+    const __m128i byte_1_low_table  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8_byte_1_low_table));
+    const __m128i byte_2_high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8_byte_2_high_table));
+    const __m128i incomplete = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8_incomplete_table));
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+
+    // NOTE: the tail is validated as a zero-padded block and one more
+    // zero block follows it, so a sequence cut off at the very end is
+    // reported as too short.
+    uint8_t tail[16] = {};
+    size_t blocks = count / 16 + 1;
+
+    for (size_t block = 0; block <= blocks; ++block) {
+        __m128i input;
+        if (block + 1 < blocks) {
+            input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + block * 16));
+        } else if (block + 1 == blocks) {
+            memcpy(tail, bytes + block * 16, count % 16);
+            input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail));
+        } else {
+            input = _mm_setzero_si128();
+        }
+
+        if (_mm_movemask_epi8(input) == 0) {
+            // NOTE: ASCII fast path
+            error = _mm_or_si128(error, prev_incomplete);
+            prev_incomplete = _mm_setzero_si128();
+        } else {
+            __m128i prev1 = _mm_alignr_epi8(input, prev_input, 16 - 1);
+            __m128i prev2 = _mm_alignr_epi8(input, prev_input, 16 - 2);
+            __m128i prev3 = _mm_alignr_epi8(input, prev_input, 16 - 3);
+
+            __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask));
+            __m128i byte_1_low  = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, nibble_mask));
+            __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask));
+            __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+            __m128i is_third_byte  = _mm_subs_epu8(prev2, _mm_set1_epi8((char) (0xE0 - 0x80)));
+            __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char) (0xF0 - 0x80)));
+            __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char) 0x80));
+
+            error = _mm_or_si128(error, _mm_xor_si128(must_be_continuation, special_cases));
+            prev_incomplete = _mm_subs_epu8(input, incomplete);
+        }
+
+        prev_input = input;
+    }
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif // AIDS_AVX2
+
+#else
+
+static bool utf8_validate_scalar(const uint8_t *bytes, size_t count)
+{
+    size_t i = 0;
+    while (i < count) {
+        // NOTE: ASCII fast path
+#if defined(AIDS_SSE2)
+        if (i + 16 <= count &&
+                _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i))) == 0) {
+            i += 16;
+            continue;
+        }
+#else
+        if (i + 8 <= count) {
+            uint64_t word = 0;
+            memcpy(&word, bytes + i, sizeof(word));
+            if ((word & 0x8080808080808080) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+#endif // AIDS_SSE2
+
+        uint32_t code = 0;
+        size_t size = utf8_decode_one(bytes + i, count - i, &code);
+        if (size == 0) {
+            return false;
+        }
+        i += size;
+    }
+
+    return true;
+}
+
+#endif // AIDS_SSSE3
+
+bool utf8_validate(String_View view)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+#if defined(AIDS_AVX2)
+    return utf8_validate_avx2(bytes, view.count);
+#elif defined(AIDS_SSSE3)
+    return utf8_validate_ssse3(bytes, view.count);
+#else
+    return utf8_validate_scalar(bytes, view.count);
+#endif
+}
+
+#if defined(AIDS_SSE2)
+// NOTE: counts the bytes of the whole 16-byte blocks for which the
+// predicate produced 0xFF and advances *i past them. The per-byte
+// counters are flushed into a size_t every 255 blocks so they never
+// overflow.
+template <typename Predicate>
+static size_t utf8_count_bytes_sse2(const uint8_t *bytes, size_t count, size_t *i, Predicate predicate)
+{
+    size_t result = 0;
+    while (*i + 16 <= count) {
+        __m128i counters = _mm_setzero_si128();
+        for (size_t j = 0; j < 255 && *i + 16 <= count; ++j, *i += 16) {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + *i));
+            counters = _mm_sub_epi8(counters, predicate(input));
+        }
+        __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        result += (size_t) _mm_cvtsi128_si32(sums) + (size_t) _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+    return result;
+}
+#endif // AIDS_SSE2
+
+size_t utf8_length_as_utf32(String_View view)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+    size_t result = 0;
+    size_t i = 0;
+
+#if defined(AIDS_SSE2)
+    result += utf8_count_bytes_sse2(bytes, view.count, &i, [](__m128i input) {
+        // NOTE: the continuation bytes 10xxxxxx are the only ones below -64 as int8_t
+        return _mm_cmpgt_epi8(input, _mm_set1_epi8(-65));
+    });
+#endif // AIDS_SSE2
+
+    for (; i < view.count; ++i) {
+        result += (bytes[i] & 0xC0) != 0x80;
+    }
+
+    return result;
+}
+
+size_t utf8_length_as_utf16(String_View view)
+{
+    // NOTE: every 4-byte sequence becomes a surrogate pair
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+    size_t result = utf8_length_as_utf32(view);
+    size_t i = 0;
+
+#if defined(AIDS_SSE2)
+    result += utf8_count_bytes_sse2(bytes, view.count, &i, [](__m128i input) {
+        return _mm_cmpeq_epi8(_mm_max_epu8(input, _mm_set1_epi8((char) 0xF0)), input);
+    });
+#endif // AIDS_SSE2
+
+    for (; i < view.count; ++i) {
+        result += bytes[i] >= 0xF0;
+    }
+
+    return result;
+}
+
+size_t utf32_length_as_utf8(const uint32_t *codes, size_t count)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        result += (size_t) (1 + (codes[i] >= 0x80) + (codes[i] >= 0x800) + (codes[i] >= 0x10000));
+    }
+    return result;
+}
+
+size_t utf16_length_as_utf8(const uint16_t *units, size_t count)
+{
+    // NOTE: each half of a surrogate pair contributes 2 of the 4 bytes
+    size_t result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        result += (size_t) (1 + (units[i] >= 0x80) + (units[i] >= 0x800 && (units[i] < 0xD800 || units[i] > 0xDFFF)));
+    }
+    return result;
+}
+
+// NOTE: the ASCII fast paths copy 16 bytes per step with SSE2 and 8
+// bytes per step otherwise. They return how many bytes were copied.
+static size_t utf8_ascii_to_utf32(const uint8_t *bytes, size_t count, uint32_t *output)
+{
+    size_t i = 0;
+#if defined(AIDS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    while (i + 16 <= count) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        if (_mm_movemask_epi8(input) != 0) {
+            break;
+        }
+        __m128i low  = _mm_unpacklo_epi8(input, zero);
+        __m128i high = _mm_unpackhi_epi8(input, zero);
+        __m128i *out = reinterpret_cast<__m128i*>(output + i);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+        i += 16;
+    }
+#else
+    while (i + 8 <= count) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, sizeof(word));
+        if ((word & 0x8080808080808080) != 0) {
+            break;
+        }
+        for (size_t j = 0; j < 8; ++j) {
+            output[i + j] = bytes[i + j];
+        }
+        i += 8;
+    }
+#endif // AIDS_SSE2
+    return i;
+}
+
+static size_t utf8_ascii_to_utf16(const uint8_t *bytes, size_t count, uint16_t *output)
+{
+    size_t i = 0;
+#if defined(AIDS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    while (i + 16 <= count) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        if (_mm_movemask_epi8(input) != 0) {
+            break;
+        }
+        __m128i *out = reinterpret_cast<__m128i*>(output + i);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(input, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(input, zero));
+        i += 16;
+    }
+#else
+    while (i + 8 <= count) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, sizeof(word));
+        if ((word & 0x8080808080808080) != 0) {
+            break;
+        }
+        for (size_t j = 0; j < 8; ++j) {
+            output[i + j] = bytes[i + j];
+        }
+        i += 8;
+    }
+#endif // AIDS_SSE2
+    return i;
+}
+
+Maybe<size_t> utf8_to_utf32(String_View view, uint32_t *output)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+    size_t count = view.count;
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i < count) {
+        if (bytes[i] < 0x80) {
+            size_t ascii = utf8_ascii_to_utf32(bytes + i, count - i, output + n);
+            if (ascii == 0) {
+                output[n++] = bytes[i++];
+            } else {
+                i += ascii;
+                n += ascii;
+            }
+            continue;
+        }
+
+        size_t size = utf8_decode_one(bytes + i, count - i, output + n);
+        if (size == 0) {
+            return {};
+        }
+        i += size;
+        n += 1;
+    }
+
+    return some(n);
+}
+
+Maybe<size_t> utf8_to_utf16(String_View view, uint16_t *output)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+    size_t count = view.count;
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i < count) {
+        if (bytes[i] < 0x80) {
+            size_t ascii = utf8_ascii_to_utf16(bytes + i, count - i, output + n);
+            if (ascii == 0) {
+                output[n++] = bytes[i++];
+            } else {
+                i += ascii;
+                n += ascii;
+            }
+            continue;
+        }
+
+        uint32_t code = 0;
+        size_t size = utf8_decode_one(bytes + i, count - i, &code);
+        if (size == 0) {
+            return {};
+        }
+        i += size;
+
+        if (code < 0x10000) {
+            output[n++] = (uint16_t) code;
+        } else {
+            code -= 0x10000;
+            output[n++] = (uint16_t) (0xD800 | (code >> 10));
+            output[n++] = (uint16_t) (0xDC00 | (code & 0x3FF));
+        }
+    }
+
+    return some(n);
+}
+
+Maybe<size_t> utf32_to_utf8(const uint32_t *codes, size_t count, char *output)
+{
+    uint8_t *bytes = reinterpret_cast<uint8_t*>(output);
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i < count) {
+#if defined(AIDS_SSE2)
+        if (i + 16 <= count) {
+            const __m128i *in = reinterpret_cast<const __m128i*>(codes + i);
+            __m128i a = _mm_loadu_si128(in + 0);
+            __m128i b = _mm_loadu_si128(in + 1);
+            __m128i c = _mm_loadu_si128(in + 2);
+            __m128i d = _mm_loadu_si128(in + 3);
+            __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            __m128i non_ascii = _mm_and_si128(all, _mm_set1_epi32(~0x7F));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(non_ascii, _mm_setzero_si128())) == 0xFFFF) {
+                __m128i ab = _mm_packs_epi32(a, b);
+                __m128i cd = _mm_packs_epi32(c, d);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + n), _mm_packus_epi16(ab, cd));
+                i += 16;
+                n += 16;
+                continue;
+            }
+        }
+#endif // AIDS_SSE2
+
+        size_t size = utf8_encode_one(codes[i], bytes + n);
+        if (size == 0) {
+            return {};
+        }
+        i += 1;
+        n += size;
+    }
+
+    return some(n);
+}
+
+Maybe<size_t> utf16_to_utf8(const uint16_t *units, size_t count, char *output)
+{
+    uint8_t *bytes = reinterpret_cast<uint8_t*>(output);
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i < count) {
+#if defined(AIDS_SSE2)
+        if (i + 16 <= count) {
+            const __m128i *in = reinterpret_cast<const __m128i*>(units + i);
+            __m128i a = _mm_loadu_si128(in + 0);
+            __m128i b = _mm_loadu_si128(in + 1);
+            __m128i non_ascii = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(~0x7F));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii, _mm_setzero_si128())) == 0xFFFF) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + n), _mm_packus_epi16(a, b));
+                i += 16;
+                n += 16;
+                continue;
+            }
+        }
+#endif // AIDS_SSE2
+
+        uint32_t code = units[i];
+        i += 1;
+
+        if (0xD800 <= code && code <= 0xDBFF) {
+            if (i >= count || units[i] < 0xDC00 || 0xDFFF < units[i]) {
+                return {};
+            }
+            code = 0x10000 + (((code - 0xD800) << 10) | (units[i] - 0xDC00));
+            i += 1;
+        }
+
+        size_t size = utf8_encode_one(code, bytes + n);
+        if (size == 0) {
+            return {};
+        }
+        n += size;
+    }
+
+    return some(n);
+}
+
+size_t utf8_length(String_View view)
+{
+    return utf8_length_as_utf32(view);
+}
+
+static size_t utf8_sequence_size(const uint8_t *bytes, size_t count)
+{
+    uint32_t code = 0;
+    size_t size = utf8_decode_one(bytes, count, &code);
+    return size == 0 ? 1 : size;
+}
+
+String_View utf8_chop_left(String_View *view, size_t n)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view->data);
+    size_t i = 0;
+    while (n > 0 && i < view->count) {
+        i += bytes[i] < 0x80 ? 1 : utf8_sequence_size(bytes + i, view->count - i);
+        n -= 1;
+    }
+    return view->chop_left(i);
+}
+
+String_View utf8_chop_right(String_View *view, size_t n)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view->data);
+    size_t i = view->count;
+    while (n > 0 && i > 0) {
+        // NOTE: step back over at most 3 continuation bytes and make
+        // sure they actually belong to the sequence we landed on.
+        size_t start = i - 1;
+        while (start > 0 && i - start < 4 && (bytes[start] & 0xC0) == 0x80) {
+            start -= 1;
+        }
+        if (utf8_sequence_size(bytes + start, view->count - start) == i - start) {
+            i = start;
+        } else {
+            i -= 1;
+        }
+        n -= 1;
+    }
+    return view->chop_right(view->count - i);
+}
+
+String_View utf8_subview(String_View view, size_t start, size_t count)
+{
+    utf8_chop_left(&view, start);
+    return utf8_chop_left(&view, count);
+}
+
+struct Unicode_Case_Range {
+    uint32_t first;
+    uint32_t last;
+    int32_t delta;
+    uint32_t stride;
+};
+
+// NOTE: generated from Unicode 14.0.0 UnicodeData.txt and
+// CaseFolding.txt (statuses C and S). A range maps every stride-th
+// code point from first to last by adding delta to it.
+const Unicode_Case_Range unicode_upper_ranges[] = {
+    {0x0061, 0x007A, -32, 1},
+    {0x00B5, 0x00B5, 743, 1},
+    {0x00E0, 0x00F6, -32, 1},
+    {0x00F8, 0x00FE, -32, 1},
+    {0x00FF, 0x00FF, 121, 1},
+    {0x0101, 0x012F, -1, 2},
+    {0x0131, 0x0131, -232, 1},
+    {0x0133, 0x0137, -1, 2},
+    {0x013A, 0x0148, -1, 2},
+    {0x014B, 0x0177, -1, 2},
+    {0x017A, 0x017E, -1, 2},
+    {0x017F, 0x017F, -300, 1},
+    {0x0180, 0x0180, 195, 1},
+    {0x0183, 0x0185, -1, 2},
+    {0x0188, 0x0188, -1, 1},
+    {0x018C, 0x018C, -1, 1},
+    {0x0192, 0x0192, -1, 1},
+    {0x0195, 0x0195, 97, 1},
+    {0x0199, 0x0199, -1, 1},
+    {0x019A, 0x019A, 163, 1},
+    {0x019E, 0x019E, 130, 1},
+    {0x01A1, 0x01A5, -1, 2},
+    {0x01A8, 0x01A8, -1, 1},
+    {0x01AD, 0x01AD, -1, 1},
+    {0x01B0, 0x01B0, -1, 1},
+    {0x01B4, 0x01B6, -1, 2},
+    {0x01B9, 0x01B9, -1, 1},
+    {0x01BD, 0x01BD, -1, 1},
+    {0x01BF, 0x01BF, 56, 1},
+    {0x01C5, 0x01C5, -1, 1},
+    {0x01C6, 0x01C6, -2, 1},
+    {0x01C8, 0x01C8, -1, 1},
+    {0x01C9, 0x01C9, -2, 1},
+    {0x01CB, 0x01CB, -1, 1},
+    {0x01CC, 0x01CC, -2, 1},
+    {0x01CE, 0x01DC, -1, 2},
+    {0x01DD, 0x01DD, -79, 1},
+    {0x01DF, 0x01EF, -1, 2},
+    {0x01F2, 0x01F2, -1, 1},
+    {0x01F3, 0x01F3, -2, 1},
+    {0x01F5, 0x01F5, -1, 1},
+    {0x01F9, 0x021F, -1, 2},
+    {0x0223, 0x0233, -1, 2},
+    {0x023C, 0x023C, -1, 1},
+    {0x023F, 0x0240, 10815, 1},
+    {0x0242, 0x0242, -1, 1},
+    {0x0247, 0x024F, -1, 2},
+    {0x0250, 0x0250, 10783, 1},
+    {0x0251, 0x0251, 10780, 1},
+    {0x0252, 0x0252, 10782, 1},
+    {0x0253, 0x0253, -210, 1},
+    {0x0254, 0x0254, -206, 1},
+    {0x0256, 0x0257, -205, 1},
+    {0x0259, 0x0259, -202, 1},
+    {0x025B, 0x025B, -203, 1},
+    {0x025C, 0x025C, 42319, 1},
+    {0x0260, 0x0260, -205, 1},
+    {0x0261, 0x0261, 42315, 1},
+    {0x0263, 0x0263, -207, 1},
+    {0x0265, 0x0265, 42280, 1},
+    {0x0266, 0x0266, 42308, 1},
+    {0x0268, 0x0268, -209, 1},
+    {0x0269, 0x0269, -211, 1},
+    {0x026A, 0x026A, 42308, 1},
+    {0x026B, 0x026B, 10743, 1},
+    {0x026C, 0x026C, 42305, 1},
+    {0x026F, 0x026F, -211, 1},
+    {0x0271, 0x0271, 10749, 1},
+    {0x0272, 0x0272, -213, 1},
+    {0x0275, 0x0275, -214, 1},
+    {0x027D, 0x027D, 10727, 1},
+    {0x0280, 0x0280, -218, 1},
+    {0x0282, 0x0282, 42307, 1},
+    {0x0283, 0x0283, -218, 1},
+    {0x0287, 0x0287, 42282, 1},
+    {0x0288, 0x0288, -218, 1},
+    {0x0289, 0x0289, -69, 1},
+    {0x028A, 0x028B, -217, 1},
+    {0x028C, 0x028C, -71, 1},
+    {0x0292, 0x0292, -219, 1},
+    {0x029D, 0x029D, 42261, 1},
+    {0x029E, 0x029E, 42258, 1},
+    {0x0345, 0x0345, 84, 1},
+    {0x0371, 0x0373, -1, 2},
+    {0x0377, 0x0377, -1, 1},
+    {0x037B, 0x037D, 130, 1},
+    {0x03AC, 0x03AC, -38, 1},
+    {0x03AD, 0x03AF, -37, 1},
+    {0x03B1, 0x03C1, -32, 1},
+    {0x03C2, 0x03C2, -31, 1},
+    {0x03C3, 0x03CB, -32, 1},
+    {0x03CC, 0x03CC, -64, 1},
+    {0x03CD, 0x03CE, -63, 1},
+    {0x03D0, 0x03D0, -62, 1},
+    {0x03D1, 0x03D1, -57, 1},
+    {0x03D5, 0x03D5, -47, 1},
+    {0x03D6, 0x03D6, -54, 1},
+    {0x03D7, 0x03D7, -8, 1},
+    {0x03D9, 0x03EF, -1, 2},
+    {0x03F0, 0x03F0, -86, 1},
+    {0x03F1, 0x03F1, -80, 1},
+    {0x03F2, 0x03F2, 7, 1},
+    {0x03F3, 0x03F3, -116, 1},
+    {0x03F5, 0x03F5, -96, 1},
+    {0x03F8, 0x03F8, -1, 1},
+    {0x03FB, 0x03FB, -1, 1},
+    {0x0430, 0x044F, -32, 1},
+    {0x0450, 0x045F, -80, 1},
+    {0x0461, 0x0481, -1, 2},
+    {0x048B, 0x04BF, -1, 2},
+    {0x04C2, 0x04CE, -1, 2},
+    {0x04CF, 0x04CF, -15, 1},
+    {0x04D1, 0x052F, -1, 2},
+    {0x0561, 0x0586, -48, 1},
+    {0x10D0, 0x10FA, 3008, 1},
+    {0x10FD, 0x10FF, 3008, 1},
+    {0x13F8, 0x13FD, -8, 1},
+    {0x1C80, 0x1C80, -6254, 1},
+    {0x1C81, 0x1C81, -6253, 1},
+    {0x1C82, 0x1C82, -6244, 1},
+    {0x1C83, 0x1C84, -6242, 1},
+    {0x1C85, 0x1C85, -6243, 1},
+    {0x1C86, 0x1C86, -6236, 1},
+    {0x1C87, 0x1C87, -6181, 1},
+    {0x1C88, 0x1C88, 35266, 1},
+    {0x1D79, 0x1D79, 35332, 1},
+    {0x1D7D, 0x1D7D, 3814, 1},
+    {0x1D8E, 0x1D8E, 35384, 1},
+    {0x1E01, 0x1E95, -1, 2},
+    {0x1E9B, 0x1E9B, -59, 1},
+    {0x1EA1, 0x1EFF, -1, 2},
+    {0x1F00, 0x1F07, 8, 1},
+    {0x1F10, 0x1F15, 8, 1},
+    {0x1F20, 0x1F27, 8, 1},
+    {0x1F30, 0x1F37, 8, 1},
+    {0x1F40, 0x1F45, 8, 1},
+    {0x1F51, 0x1F57, 8, 2},
+    {0x1F60, 0x1F67, 8, 1},
+    {0x1F70, 0x1F71, 74, 1},
+    {0x1F72, 0x1F75, 86, 1},
+    {0x1F76, 0x1F77, 100, 1},
+    {0x1F78, 0x1F79, 128, 1},
+    {0x1F7A, 0x1F7B, 112, 1},
+    {0x1F7C, 0x1F7D, 126, 1},
+    {0x1F80, 0x1F87, 8, 1},
+    {0x1F90, 0x1F97, 8, 1},
+    {0x1FA0, 0x1FA7, 8, 1},
+    {0x1FB0, 0x1FB1, 8, 1},
+    {0x1FB3, 0x1FB3, 9, 1},
+    {0x1FBE, 0x1FBE, -7205, 1},
+    {0x1FC3, 0x1FC3, 9, 1},
+    {0x1FD0, 0x1FD1, 8, 1},
+    {0x1FE0, 0x1FE1, 8, 1},
+    {0x1FE5, 0x1FE5, 7, 1},
+    {0x1FF3, 0x1FF3, 9, 1},
+    {0x214E, 0x214E, -28, 1},
+    {0x2170, 0x217F, -16, 1},
+    {0x2184, 0x2184, -1, 1},
+    {0x24D0, 0x24E9, -26, 1},
+    {0x2C30, 0x2C5F, -48, 1},
+    {0x2C61, 0x2C61, -1, 1},
+    {0x2C65, 0x2C65, -10795, 1},
+    {0x2C66, 0x2C66, -10792, 1},
+    {0x2C68, 0x2C6C, -1, 2},
+    {0x2C73, 0x2C73, -1, 1},
+    {0x2C76, 0x2C76, -1, 1},
+    {0x2C81, 0x2CE3, -1, 2},
+    {0x2CEC, 0x2CEE, -1, 2},
+    {0x2CF3, 0x2CF3, -1, 1},
+    {0x2D00, 0x2D25, -7264, 1},
+    {0x2D27, 0x2D27, -7264, 1},
+    {0x2D2D, 0x2D2D, -7264, 1},
+    {0xA641, 0xA66D, -1, 2},
+    {0xA681, 0xA69B, -1, 2},
+    {0xA723, 0xA72F, -1, 2},
+    {0xA733, 0xA76F, -1, 2},
+    {0xA77A, 0xA77C, -1, 2},
+    {0xA77F, 0xA787, -1, 2},
+    {0xA78C, 0xA78C, -1, 1},
+    {0xA791, 0xA793, -1, 2},
+    {0xA794, 0xA794, 48, 1},
+    {0xA797, 0xA7A9, -1, 2},
+    {0xA7B5, 0xA7C3, -1, 2},
+    {0xA7C8, 0xA7CA, -1, 2},
+    {0xA7D1, 0xA7D1, -1, 1},
+    {0xA7D7, 0xA7D9, -1, 2},
+    {0xA7F6, 0xA7F6, -1, 1},
+    {0xAB53, 0xAB53, -928, 1},
+    {0xAB70, 0xABBF, -38864, 1},
+    {0xFF41, 0xFF5A, -32, 1},
+    {0x10428, 0x1044F, -40, 1},
+    {0x104D8, 0x104FB, -40, 1},
+    {0x10597, 0x105A1, -39, 1},
+    {0x105A3, 0x105B1, -39, 1},
+    {0x105B3, 0x105B9, -39, 1},
+    {0x105BB, 0x105BC, -39, 1},
+    {0x10CC0, 0x10CF2, -64, 1},
+    {0x118C0, 0x118DF, -32, 1},
+    {0x16E60, 0x16E7F, -32, 1},
+    {0x1E922, 0x1E943, -34, 1},
+};
+const Unicode_Case_Range unicode_fold_ranges[] = {
+    {0x0041, 0x005A, 32, 1},
+    {0x00B5, 0x00B5, 775, 1},
+    {0x00C0, 0x00D6, 32, 1},
+    {0x00D8, 0x00DE, 32, 1},
+    {0x0100, 0x012E, 1, 2},
+    {0x0132, 0x0136, 1, 2},
+    {0x0139, 0x0147, 1, 2},
+    {0x014A, 0x0176, 1, 2},
+    {0x0178, 0x0178, -121, 1},
+    {0x0179, 0x017D, 1, 2},
+    {0x017F, 0x017F, -268, 1},
+    {0x0181, 0x0181, 210, 1},
+    {0x0182, 0x0184, 1, 2},
+    {0x0186, 0x0186, 206, 1},
+    {0x0187, 0x0187, 1, 1},
+    {0x0189, 0x018A, 205, 1},
+    {0x018B, 0x018B, 1, 1},
+    {0x018E, 0x018E, 79, 1},
+    {0x018F, 0x018F, 202, 1},
+    {0x0190, 0x0190, 203, 1},
+    {0x0191, 0x0191, 1, 1},
+    {0x0193, 0x0193, 205, 1},
+    {0x0194, 0x0194, 207, 1},
+    {0x0196, 0x0196, 211, 1},
+    {0x0197, 0x0197, 209, 1},
+    {0x0198, 0x0198, 1, 1},
+    {0x019C, 0x019C, 211, 1},
+    {0x019D, 0x019D, 213, 1},
+    {0x019F, 0x019F, 214, 1},
+    {0x01A0, 0x01A4, 1, 2},
+    {0x01A6, 0x01A6, 218, 1},
+    {0x01A7, 0x01A7, 1, 1},
+    {0x01A9, 0x01A9, 218, 1},
+    {0x01AC, 0x01AC, 1, 1},
+    {0x01AE, 0x01AE, 218, 1},
+    {0x01AF, 0x01AF, 1, 1},
+    {0x01B1, 0x01B2, 217, 1},
+    {0x01B3, 0x01B5, 1, 2},
+    {0x01B7, 0x01B7, 219, 1},
+    {0x01B8, 0x01B8, 1, 1},
+    {0x01BC, 0x01BC, 1, 1},
+    {0x01C4, 0x01C4, 2, 1},
+    {0x01C5, 0x01C5, 1, 1},
+    {0x01C7, 0x01C7, 2, 1},
+    {0x01C8, 0x01C8, 1, 1},
+    {0x01CA, 0x01CA, 2, 1},
+    {0x01CB, 0x01DB, 1, 2},
+    {0x01DE, 0x01EE, 1, 2},
+    {0x01F1, 0x01F1, 2, 1},
+    {0x01F2, 0x01F4, 1, 2},
+    {0x01F6, 0x01F6, -97, 1},
+    {0x01F7, 0x01F7, -56, 1},
+    {0x01F8, 0x021E, 1, 2},
+    {0x0220, 0x0220, -130, 1},
+    {0x0222, 0x0232, 1, 2},
+    {0x023A, 0x023A, 10795, 1},
+    {0x023B, 0x023B, 1, 1},
+    {0x023D, 0x023D, -163, 1},
+    {0x023E, 0x023E, 10792, 1},
+    {0x0241, 0x0241, 1, 1},
+    {0x0243, 0x0243, -195, 1},
+    {0x0244, 0x0244, 69, 1},
+    {0x0245, 0x0245, 71, 1},
+    {0x0246, 0x024E, 1, 2},
+    {0x0345, 0x0345, 116, 1},
+    {0x0370, 0x0372, 1, 2},
+    {0x0376, 0x0376, 1, 1},
+    {0x037F, 0x037F, 116, 1},
+    {0x0386, 0x0386, 38, 1},
+    {0x0388, 0x038A, 37, 1},
+    {0x038C, 0x038C, 64, 1},
+    {0x038E, 0x038F, 63, 1},
+    {0x0391, 0x03A1, 32, 1},
+    {0x03A3, 0x03AB, 32, 1},
+    {0x03C2, 0x03C2, 1, 1},
+    {0x03CF, 0x03CF, 8, 1},
+    {0x03D0, 0x03D0, -30, 1},
+    {0x03D1, 0x03D1, -25, 1},
+    {0x03D5, 0x03D5, -15, 1},
+    {0x03D6, 0x03D6, -22, 1},
+    {0x03D8, 0x03EE, 1, 2},
+    {0x03F0, 0x03F0, -54, 1},
+    {0x03F1, 0x03F1, -48, 1},
+    {0x03F4, 0x03F4, -60, 1},
+    {0x03F5, 0x03F5, -64, 1},
+    {0x03F7, 0x03F7, 1, 1},
+    {0x03F9, 0x03F9, -7, 1},
+    {0x03FA, 0x03FA, 1, 1},
+    {0x03FD, 0x03FF, -130, 1},
+    {0x0400, 0x040F, 80, 1},
+    {0x0410, 0x042F, 32, 1},
+    {0x0460, 0x0480, 1, 2},
+    {0x048A, 0x04BE, 1, 2},
+    {0x04C0, 0x04C0, 15, 1},
+    {0x04C1, 0x04CD, 1, 2},
+    {0x04D0, 0x052E, 1, 2},
+    {0x0531, 0x0556, 48, 1},
+    {0x10A0, 0x10C5, 7264, 1},
+    {0x10C7, 0x10C7, 7264, 1},
+    {0x10CD, 0x10CD, 7264, 1},
+    {0x13F8, 0x13FD, -8, 1},
+    {0x1C80, 0x1C80, -6222, 1},
+    {0x1C81, 0x1C81, -6221, 1},
+    {0x1C82, 0x1C82, -6212, 1},
+    {0x1C83, 0x1C84, -6210, 1},
+    {0x1C85, 0x1C85, -6211, 1},
+    {0x1C86, 0x1C86, -6204, 1},
+    {0x1C87, 0x1C87, -6180, 1},
+    {0x1C88, 0x1C88, 35267, 1},
+    {0x1C90, 0x1CBA, -3008, 1},
+    {0x1CBD, 0x1CBF, -3008, 1},
+    {0x1E00, 0x1E94, 1, 2},
+    {0x1E9B, 0x1E9B, -58, 1},
+    {0x1E9E, 0x1E9E, -7615, 1},
+    {0x1EA0, 0x1EFE, 1, 2},
+    {0x1F08, 0x1F0F, -8, 1},
+    {0x1F18, 0x1F1D, -8, 1},
+    {0x1F28, 0x1F2F, -8, 1},
+    {0x1F38, 0x1F3F, -8, 1},
+    {0x1F48, 0x1F4D, -8, 1},
+    {0x1F59, 0x1F5F, -8, 2},
+    {0x1F68, 0x1F6F, -8, 1},
+    {0x1F88, 0x1F8F, -8, 1},
+    {0x1F98, 0x1F9F, -8, 1},
+    {0x1FA8, 0x1FAF, -8, 1},
+    {0x1FB8, 0x1FB9, -8, 1},
+    {0x1FBA, 0x1FBB, -74, 1},
+    {0x1FBC, 0x1FBC, -9, 1},
+    {0x1FBE, 0x1FBE, -7173, 1},
+    {0x1FC8, 0x1FCB, -86, 1},
+    {0x1FCC, 0x1FCC, -9, 1},
+    {0x1FD8, 0x1FD9, -8, 1},
+    {0x1FDA, 0x1FDB, -100, 1},
+    {0x1FE8, 0x1FE9, -8, 1},
+    {0x1FEA, 0x1FEB, -112, 1},
+    {0x1FEC, 0x1FEC, -7, 1},
+    {0x1FF8, 0x1FF9, -128, 1},
+    {0x1FFA, 0x1FFB, -126, 1},
+    {0x1FFC, 0x1FFC, -9, 1},
+    {0x2126, 0x2126, -7517, 1},
+    {0x212A, 0x212A, -8383, 1},
+    {0x212B, 0x212B, -8262, 1},
+    {0x2132, 0x2132, 28, 1},
+    {0x2160, 0x216F, 16, 1},
+    {0x2183, 0x2183, 1, 1},
+    {0x24B6, 0x24CF, 26, 1},
+    {0x2C00, 0x2C2F, 48, 1},
+    {0x2C60, 0x2C60, 1, 1},
+    {0x2C62, 0x2C62, -10743, 1},
+    {0x2C63, 0x2C63, -3814, 1},
+    {0x2C64, 0x2C64, -10727, 1},
+    {0x2C67, 0x2C6B, 1, 2},
+    {0x2C6D, 0x2C6D, -10780, 1},
+    {0x2C6E, 0x2C6E, -10749, 1},
+    {0x2C6F, 0x2C6F, -10783, 1},
+    {0x2C70, 0x2C70, -10782, 1},
+    {0x2C72, 0x2C72, 1, 1},
+    {0x2C75, 0x2C75, 1, 1},
+    {0x2C7E, 0x2C7F, -10815, 1},
+    {0x2C80, 0x2CE2, 1, 2},
+    {0x2CEB, 0x2CED, 1, 2},
+    {0x2CF2, 0x2CF2, 1, 1},
+    {0xA640, 0xA66C, 1, 2},
+    {0xA680, 0xA69A, 1, 2},
+    {0xA722, 0xA72E, 1, 2},
+    {0xA732, 0xA76E, 1, 2},
+    {0xA779, 0xA77B, 1, 2},
+    {0xA77D, 0xA77D, -35332, 1},
+    {0xA77E, 0xA786, 1, 2},
+    {0xA78B, 0xA78B, 1, 1},
+    {0xA78D, 0xA78D, -42280, 1},
+    {0xA790, 0xA792, 1, 2},
+    {0xA796, 0xA7A8, 1, 2},
+    {0xA7AA, 0xA7AA, -42308, 1},
+    {0xA7AB, 0xA7AB, -42319, 1},
+    {0xA7AC, 0xA7AC, -42315, 1},
+    {0xA7AD, 0xA7AD, -42305, 1},
+    {0xA7AE, 0xA7AE, -42308, 1},
+    {0xA7B0, 0xA7B0, -42258, 1},
+    {0xA7B1, 0xA7B1, -42282, 1},
+    {0xA7B2, 0xA7B2, -42261, 1},
+    {0xA7B3, 0xA7B3, 928, 1},
+    {0xA7B4, 0xA7C2, 1, 2},
+    {0xA7C4, 0xA7C4, -48, 1},
+    {0xA7C5, 0xA7C5, -42307, 1},
+    {0xA7C6, 0xA7C6, -35384, 1},
+    {0xA7C7, 0xA7C9, 1, 2},
+    {0xA7D0, 0xA7D0, 1, 1},
+    {0xA7D6, 0xA7D8, 1, 2},
+    {0xA7F5, 0xA7F5, 1, 1},
+    {0xAB70, 0xABBF, -38864, 1},
+    {0xFF21, 0xFF3A, 32, 1},
+    {0x10400, 0x10427, 40, 1},
+    {0x104B0, 0x104D3, 40, 1},
+    {0x10570, 0x1057A, 39, 1},
+    {0x1057C, 0x1058A, 39, 1},
+    {0x1058C, 0x10592, 39, 1},
+    {0x10594, 0x10595, 39, 1},
+    {0x10C80, 0x10CB2, 64, 1},
+    {0x118A0, 0x118BF, 32, 1},
+    {0x16E40, 0x16E5F, 32, 1},
+    {0x1E900, 0x1E921, 34, 1},
+};
+
+static uint32_t unicode_map_case(const Unicode_Case_Range *ranges, size_t ranges_count, uint32_t code)
+{
+    size_t low = 0;
+    size_t high = ranges_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (ranges[mid].last < code) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low < ranges_count &&
+            ranges[low].first <= code &&
+            (code - ranges[low].first) % ranges[low].stride == 0) {
+        return (uint32_t) ((int32_t) code + ranges[low].delta);
+    }
+
+    return code;
+}
+
+uint32_t unicode_to_upper(uint32_t code)
+{
+    if (code < 0x80) {
+        return 'a' <= code && code <= 'z' ? code - 0x20 : code;
+    }
+    return unicode_map_case(unicode_upper_ranges, sizeof(unicode_upper_ranges) / sizeof(unicode_upper_ranges[0]), code);
+}
+
+uint32_t unicode_fold_case(uint32_t code)
+{
+    if (code < 0x80) {
+        return 'A' <= code && code <= 'Z' ? code + 0x20 : code;
+    }
+    return unicode_map_case(unicode_fold_ranges, sizeof(unicode_fold_ranges) / sizeof(unicode_fold_ranges[0]), code);
+}
+
+size_t utf8_case_mapping_capacity(String_View view)
+{
+    return view.count + view.count / 2;
+}
+
+// NOTE: maps the case of every code point of the view. The ASCII runs
+// are mapped 16 bytes at a time with SSE2. If keep_ill_formed is
+// true the bytes of the ill-formed sequences are copied as they are,
+// otherwise the mapping stops and returns None.
+static Maybe<size_t> utf8_map_case(String_View view, char *output, bool upper, bool keep_ill_formed)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(view.data);
+    uint8_t *out = reinterpret_cast<uint8_t*>(output);
+    const uint8_t first = upper ? 'a' : 'A';
+    const uint8_t last = upper ? 'z' : 'Z';
+    size_t i = 0;
+    size_t n = 0;
+
+    while (i < view.count) {
+#if defined(AIDS_SSE2)
+        if (i + 16 <= view.count) {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            if (_mm_movemask_epi8(input) == 0) {
+                __m128i in_range = _mm_and_si128(
+                    _mm_cmpgt_epi8(input, _mm_set1_epi8((char) (first - 1))),
+                    _mm_cmpgt_epi8(_mm_set1_epi8((char) (last + 1)), input));
+                __m128i flip = _mm_and_si128(in_range, _mm_set1_epi8(0x20));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n), _mm_xor_si128(input, flip));
+                i += 16;
+                n += 16;
+                continue;
+            }
+        }
+#endif // AIDS_SSE2
+
+        if (bytes[i] < 0x80) {
+            out[n++] = (uint8_t) (first <= bytes[i] && bytes[i] <= last ? bytes[i] ^ 0x20 : bytes[i]);
+            i += 1;
+            continue;
+        }
+
+        uint32_t code = 0;
+        size_t size = utf8_decode_one(bytes + i, view.count - i, &code);
+        if (size == 0) {
+            if (!keep_ill_formed) {
+                return {};
+            }
+            out[n++] = bytes[i++];
+            continue;
+        }
+        i += size;
+        n += utf8_encode_one(upper ? unicode_to_upper(code) : unicode_fold_case(code), out + n);
+    }
+
+    return some(n);
+}
+
+Maybe<size_t> utf8_to_upper(String_View view, char *output)
+{
+    return utf8_map_case(view, output, true, false);
+}
+
+Maybe<size_t> utf8_fold_case(String_View view, char *output)
+{
+    return utf8_map_case(view, output, false, false);
+}
+
+// NOTE: uppercases the view chunk by chunk through a stack buffer
+// without splitting the multibyte sequences between the chunks.
+template <typename Sink>
+static void utf8_caps_chunks(String_View view, Sink sink)
+{
+    const size_t CHUNK_SIZE = 1024;
+    char buffer[CHUNK_SIZE + CHUNK_SIZE / 2];
+
+    while (view.count > 0) {
+        size_t size = min(CHUNK_SIZE, view.count);
+        if (size < view.count) {
+            size_t boundary = size;
+            while (boundary > size - 3 && (view.data[boundary] & 0xC0) == 0x80) {
+                boundary -= 1;
+            }
+            size = boundary;
+        }
+
+        String_View chunk = view.chop_left(size);
+        size_t n = utf8_map_case(chunk, buffer, true, true).unwrap;
+        sink(String_View {n, buffer});
+    }
+}
+
+void print1(FILE *stream, Hex<uint32_t> hex)
+{
+    fprintf(stream, "%x", hex.unwrap);
+}
+
+void print1(FILE *stream, Hex<char> hex)
+{
+    fprintf(stream, "%hhx", hex.unwrap);
+}
+
+void print1(FILE *stream, HEX<uint32_t> hex)
+{
+    fprintf(stream, "%X", hex.unwrap);
+}
+
+void print1(FILE *stream, HEX<char> hex)
+{
+    fprintf(stream, "%hhX", hex.unwrap);
+}
+
+void print1(FILE *stream, Hex_Bytes hex_bytes)
+{
+    print(stream, hex_bytes);
+}
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+void print1(Print_Buffer *buffer, Hex_Bytes hex_bytes)
+{
+    // NOTE: "[", "ff" and ", " per byte, "]"
+    char *output = buffer->reserve(hex_bytes.unwrap.count * 4 + 2);
+    char *begin = output;
+
+    *output++ = '[';
+    for (size_t i = 0; i < hex_bytes.unwrap.count; ++i) {
+        const uint8_t x = (uint8_t) hex_bytes.unwrap.data[i];
+        if (i > 0) {
+            *output++ = ',';
+            *output++ = ' ';
+        }
+        if (x >= 0x10) {
+            *output++ = HEX_DIGITS[x >> 4];
+        }
+        *output++ = HEX_DIGITS[x & 0xF];
+    }
+    *output++ = ']';
+
+    buffer->size += (size_t) (output - begin);
+}
+
+size_t bytes_length_as_hex(String_View bytes)
+{
+    return bytes.count * 2;
+}
+
+size_t hex_length_as_bytes(String_View hex)
+{
+    return hex.count / 2;
+}
+
+// NOTE: the value of every byte as a hex digit, -1 if it is not one
+static const int8_t HEX_DIGIT_VALUES[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+#if defined(AIDS_SSE2)
+// NOTE: 16 bytes into 32 hex digits. The digits past '9' are moved up
+// to 'a' where the nibble is greater than 9.
+static void bytes_to_hex_sse2(const uint8_t *bytes, size_t count, size_t *i, char *output)
+{
+    const __m128i nibble = _mm_set1_epi8(0xF);
+    auto digits = [](__m128i nibbles) {
+        const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                                              _mm_set1_epi8('a' - '0' - 10));
+        return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+    };
+
+    for (; *i + 16 <= count; *i += 16) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + *i));
+        const __m128i high = digits(_mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+        const __m128i low = digits(_mm_and_si128(input, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + *i * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + *i * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+}
+
+// NOTE: the values of 16 hex digits packed in pairs into 8 bytes in
+// the low halves of the 16-bit lanes, or false if any of them is not
+// a hex digit. '0'..'9' are checked as is, the letters after setting
+// the lowercase bit, which only 'A'..'F' and 'a'..'f' turn into
+// 'a'..'f'.
+static bool hex_digits_sse2(__m128i input, __m128i *bytes)
+{
+    const __m128i digit = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(input, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+        return false;
+    }
+
+    const __m128i values = _mm_or_si128(_mm_and_si128(is_digit, digit),
+                                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+    *bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0xFF)), 4),
+                          _mm_srli_epi16(values, 8));
+    return true;
+}
+
+// NOTE: 32 hex digits into 16 bytes. Stops at the block with a
+// non-digit in it, the scalar loop finds out where it is exactly.
+static void hex_to_bytes_sse2(const char *hex, size_t count, size_t *i, char *output)
+{
+    for (; *i + 32 <= count; *i += 32) {
+        __m128i first, second;
+        if (!hex_digits_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + *i)), &first) ||
+            !hex_digits_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + *i + 16)), &second)) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + *i / 2), _mm_packus_epi16(first, second));
+    }
+}
+#endif // AIDS_SSE2
+
+size_t bytes_to_hex(String_View bytes, char *output)
+{
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(bytes.data);
+    size_t i = 0;
+
+#if defined(AIDS_SSE2)
+    bytes_to_hex_sse2(data, bytes.count, &i, output);
+#endif // AIDS_SSE2
+
+    for (; i < bytes.count; ++i) {
+        output[2 * i] = HEX_DIGITS[data[i] >> 4];
+        output[2 * i + 1] = HEX_DIGITS[data[i] & 0xF];
+    }
+
+    return bytes.count * 2;
+}
+
+Maybe<size_t> hex_to_bytes(String_View hex, char *output)
+{
+    if (hex.count % 2 != 0) {
+        return {};
+    }
+
+    size_t i = 0;
+
+#if defined(AIDS_SSE2)
+    hex_to_bytes_sse2(hex.data, hex.count, &i, output);
+#endif // AIDS_SSE2
+
+    for (; i < hex.count; i += 2) {
+        const int high = HEX_DIGIT_VALUES[(uint8_t) hex.data[i]];
+        const int low = HEX_DIGIT_VALUES[(uint8_t) hex.data[i + 1]];
+        if ((high | low) < 0) {
+            return {};
+        }
+        output[i / 2] = (char) (high * 16 + low);
+    }
+
+    return some(hex.count / 2);
+}
 
-#ifdef AIDS_IMPLEMENTATION
+static const char BASE64_DIGITS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// NOTE: the value of every byte as a base64 digit, -1 if it is not one
+static const int8_t BASE64_DIGIT_VALUES[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
 
-namespace aids
+// NOTE: the amount of digits in a base64 view without its padding
+static size_t base64_unpadded_count(String_View base64)
 {
+    size_t count = base64.count;
+    if (count % 4 == 0) {
+        for (size_t i = 0; i < 2 && count > 0 && base64.data[count - 1] == '='; ++i) {
+            count -= 1;
+        }
+    }
+    return count;
+}
 
-Mtor mtor;
+size_t bytes_length_as_base64(String_View bytes)
+{
+    return (bytes.count + 2) / 3 * 4;
+}
 
-[[nodiscard]]
-String_View String_View::trim_begin(void) const
+size_t base64_length_as_bytes(String_View base64)
 {
-    String_View view = *this;
+    return base64_unpadded_count(base64) * 3 / 4;
+}
 
-    while (view.count != 0 && isspace(*view.data)) {
-        view.data  += 1;
-        view.count -= 1;
+#if defined(AIDS_SSSE3)
+// NOTE: the SSSE3 base64 kernels of Wojciech Muła and Daniel Lemire
+// ("Faster Base64 Encoding and Decoding Using AVX2 Instructions",
+// https://arxiv.org/abs/1704.00605). The encoding reads 16 bytes but
+// only uses the first 12 of them.
+static void bytes_to_base64_ssse3(const uint8_t *bytes, size_t count, size_t *i, char **output)
+{
+    for (; *i + 16 <= count; *i += 12, *output += 16) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + *i));
+
+        // NOTE: every 3 bytes into 4 16-bit lanes with one 6-bit index each
+        const __m128i shuffled = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                                                       7, 6, 8, 7, 10, 9, 11, 10));
+        const __m128i ac = _mm_mulhi_epu16(_mm_and_si128(shuffled, _mm_set1_epi32(0x0FC0FC00)),
+                                           _mm_set1_epi32(0x04000040));
+        const __m128i bd = _mm_mullo_epi16(_mm_and_si128(shuffled, _mm_set1_epi32(0x003F03F0)),
+                                           _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(ac, bd);
+
+        // NOTE: the offset from the index to its digit depends only on
+        // the range of the index: 0..25, 26..51, 52..61, 62 or 63
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices),
+                                                  _mm_set1_epi8(13)));
+        const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                              '/' - 63, 'A', 0, 0);
+        const __m128i digits = _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(*output), digits);
     }
-    return view;
 }
 
-[[nodiscard]]
-String_View String_View::trim_end(void) const
+// NOTE: 16 digits into 12 bytes. A digit is valid when the bit of
+// its high nibble is set in the mask of its low nibble. Stops at the
+// block with an invalid digit in it.
+static void base64_to_bytes_ssse3(const char *base64, size_t count, size_t *i, char **output)
 {
-    String_View view = *this;
+    const __m128i nibble = _mm_set1_epi8(0xF);
+    const __m128i offsets = _mm_setr_epi8(0, 0, 62 - '+', 52 - '0', 0 - 'A', 0 - 'A', 26 - 'a', 26 - 'a',
+                                          0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i masks = _mm_setr_epi8((char) 0xA8, (char) 0xF8, (char) 0xF8, (char) 0xF8,
+                                        (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8,
+                                        (char) 0xF8, (char) 0xF8, (char) 0xF0, 0x54,
+                                        0x50, 0x50, 0x50, 0x54);
+    const __m128i bits = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char) 0x80,
+                                       0, 0, 0, 0, 0, 0, 0, 0);
+    for (; *i + 16 <= count; *i += 16, *output += 12) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base64 + *i));
+        const __m128i high = _mm_and_si128(_mm_srli_epi32(input, 4), nibble);
+        const __m128i low = _mm_and_si128(input, nibble);
+
+        const __m128i valid = _mm_and_si128(_mm_shuffle_epi8(masks, low), _mm_shuffle_epi8(bits, high));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(valid, _mm_setzero_si128())) != 0) {
+            break;
+        }
 
-    while (view.count != 0 && isspace(*(view.data + view.count - 1))) {
-        view.count -= 1;
+        // NOTE: '/' is the only digit that doesn't share the offset of its high nibble
+        const __m128i slash = _mm_cmpeq_epi8(input, _mm_set1_epi8('/'));
+        const __m128i offset = _mm_or_si128(_mm_andnot_si128(slash, _mm_shuffle_epi8(offsets, high)),
+                                            _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+        const __m128i values = _mm_add_epi8(input, offset);
+
+        const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        const __m128i result = _mm_shuffle_epi8(quads, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                                                     8, 14, 13, 12, -1, -1, -1, -1));
+        char block[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(block), result);
+        memcpy(*output, block, 12);
     }
-    return view;
 }
+#endif // AIDS_SSSE3
 
-[[nodiscard]]
-String_View String_View::trim(void) const
+size_t bytes_to_base64(String_View bytes, char *output)
 {
-    return trim_begin().trim_end();
-}
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(bytes.data);
+    char *begin = output;
+    size_t i = 0;
 
-String_View String_View::chop_left(size_t n)
-{
-    if (n > count) {
-        n = count;
+#if defined(AIDS_SSSE3)
+    bytes_to_base64_ssse3(data, bytes.count, &i, &output);
+#endif // AIDS_SSSE3
+
+    for (; i + 3 <= bytes.count; i += 3) {
+        const uint32_t x = (uint32_t) data[i] << 16 | (uint32_t) data[i + 1] << 8 | data[i + 2];
+        *output++ = BASE64_DIGITS[(x >> 18) & 0x3F];
+        *output++ = BASE64_DIGITS[(x >> 12) & 0x3F];
+        *output++ = BASE64_DIGITS[(x >> 6) & 0x3F];
+        *output++ = BASE64_DIGITS[x & 0x3F];
     }
 
-    String_View result = {n, data};
-    data  += n;
-    count -= n;
+    if (i < bytes.count) {
+        const uint32_t x = (uint32_t) data[i] << 16 | (i + 1 < bytes.count ? (uint32_t) data[i + 1] << 8 : 0);
+        *output++ = BASE64_DIGITS[(x >> 18) & 0x3F];
+        *output++ = BASE64_DIGITS[(x >> 12) & 0x3F];
+        *output++ = i + 1 < bytes.count ? BASE64_DIGITS[(x >> 6) & 0x3F] : '=';
+        *output++ = '=';
+    }
 
-    return result;
+    return (size_t) (output - begin);
 }
 
-String_View String_View::chop_right(size_t n)
+Maybe<size_t> base64_to_bytes(String_View base64, char *output)
 {
-    if (n > count) {
-        n = count;
+    const size_t count = base64_unpadded_count(base64);
+    if (count % 4 == 1) {
+        return {};
     }
 
-    String_View result = {n, data + count - n};
+    char *begin = output;
+    size_t i = 0;
 
-    count -= n;
+#if defined(AIDS_SSSE3)
+    base64_to_bytes_ssse3(base64.data, count, &i, &output);
+#endif // AIDS_SSSE3
+
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(base64.data);
+    for (; i + 4 <= count; i += 4) {
+        const int a = BASE64_DIGIT_VALUES[data[i]];
+        const int b = BASE64_DIGIT_VALUES[data[i + 1]];
+        const int c = BASE64_DIGIT_VALUES[data[i + 2]];
+        const int d = BASE64_DIGIT_VALUES[data[i + 3]];
+        if ((a | b | c | d) < 0) {
+            return {};
+        }
 
-    return result;
+        const uint32_t x = (uint32_t) a << 18 | (uint32_t) b << 12 | (uint32_t) c << 6 | (uint32_t) d;
+        *output++ = (char) (x >> 16);
+        *output++ = (char) (x >> 8);
+        *output++ = (char) x;
+    }
+
+    // NOTE: 2 digits carry 12 bits of 1 byte, 3 digits 18 bits of 2 bytes
+    uint32_t x = 0;
+    const size_t digits = count - i;
+    for (; i < count; ++i) {
+        const int value = BASE64_DIGIT_VALUES[data[i]];
+        if (value < 0) {
+            return {};
+        }
+        x = x << 6 | (uint32_t) value;
+    }
+
+    if (digits == 2) {
+        *output++ = (char) (x >> 4);
+    } else if (digits == 3) {
+        *output++ = (char) (x >> 10);
+        *output++ = (char) (x >> 2);
+    }
+
+    return some((size_t) (output - begin));
 }
 
-void String_View::chop_back(size_t n)
+void print1(FILE *stream, Newline)
 {
-    count -= n < count ? n : count;
+    print(stream, '\n');
 }
 
-void String_View::chop(size_t n)
+void print1(Print_Buffer *buffer, Newline)
 {
-    if (n > count) {
-        data += count;
-        count = 0;
-    } else {
-        data  += n;
-        count -= n;
+    print1(buffer, '\n');
+}
+
+////////////////////////////////////////////////////////////
+// Hash_Map
+////////////////////////////////////////////////////////////
+
+// NOTE: stolen from http://www.cse.yorku.ca/~oz/hash.html
+unsigned long hash(String_View str)
+{
+    unsigned long hash = 5381;
+    for (size_t i = 0; i < str.count; ++i) {
+        hash = ((hash << 5) + hash) + str.data[i];
     }
+    return hash;
 }
 
-void String_View::grow(size_t n)
+// NOTE: the finalizer of MurmurHash3. Hash_Map only looks at the
+// lower bits of the hash, so they have to depend on all bits of x.
+unsigned long hash(uint32_t x)
 {
-    count += n;
+    x ^= x >> 16;
+    x *= 0x85ebca6b;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35;
+    x ^= x >> 16;
+    return x;
 }
 
-String_View String_View::chop_while(Predicate_Char predicate)
+void print1(FILE *stream, const Hash_Map_Stats &stats)
 {
-    size_t size = 0;
-    while (size < count && predicate(data[size])) {
-        size += 1;
+    println(stream, "size: ", stats.size,
+            ", capacity: ", stats.capacity,
+            ", load factor: ", stats.load_factor,
+            ", resizes: ", stats.resizes);
+    println(stream, "probe length: average ", stats.average_probe_length,
+            ", max ", stats.max_probe_length,
+            ", average miss ", stats.average_miss_probe_length);
+    print(stream, "displacement:");
+    for (size_t i = 0; i < Hash_Map_Stats::DISPLACEMENT_HISTOGRAM_SIZE; ++i) {
+        print(stream, " ", i,
+              i + 1 == Hash_Map_Stats::DISPLACEMENT_HISTOGRAM_SIZE ? "+: " : ": ",
+              stats.displacement_histogram[i]);
     }
-
-    auto result = subview(0, size);
-    chop_left(size);
-    return result;
 }
 
-String_View String_View::chop_by_delim(char delim)
-{
-    assert(data);
+////////////////////////////////////////////////////////////
+// INTERNER
+////////////////////////////////////////////////////////////
 
-    size_t i = 0;
-    while (i < count && data[i] != delim) i++;
-    String_View result = {i, data};
-    chop_left(i + 1);
+bool Interned_View::operator==(const Interned_View &that) const
+{
+    return this->hash == that.hash && this->view == that.view;
+}
 
-    return result;
+bool Interned_View::operator!=(const Interned_View &that) const
+{
+    return !(*this == that);
 }
 
-String_View String_View::chop_word(void)
+unsigned long hash(Interned_View interned_view)
 {
-    *this = trim_begin();
+    return interned_view.hash;
+}
 
-    size_t i = 0;
-    while (i < count && !isspace(data[i])) i++;
+uint32_t Interner::intern(String_View view)
+{
+    const size_t INTERNER_CHUNK_CAPACITY = 64 * 1024;
 
-    String_View result = { i, data };
+    Interned_View key = {view, hash(view)};
+    auto id = ids.get(key);
+    if (id.has_value) {
+        return *id.unwrap;
+    }
 
-    count -= i;
-    data  += i;
+    if (chunks.size == 0 || chunks[chunks.size - 1].count - chunk_size < view.count) {
+        size_t capacity = max(INTERNER_CHUNK_CAPACITY, view.count);
+        chunks.push({capacity, mtor.alloc<char>(capacity)});
+        chunk_size = 0;
+    }
 
-    return result;
-}
+    char *data = const_cast<char*>(chunks[chunks.size - 1].data) + chunk_size;
+    memcpy(data, view.data, view.count);
+    chunk_size += view.count;
 
-Maybe<float> String_View::as_float() const
-{
-    char buffer[300] = {};
-    memcpy(buffer, data, min(sizeof(buffer) - 1, count));
-    char *endptr = NULL;
-    float result = strtof(buffer, &endptr);
+    key.view = {view.count, data};
 
-    if (buffer > endptr || (size_t) (endptr - buffer) != count) {
-        return {};
-    }
+    uint32_t new_id = (uint32_t) views.size;
+    views.push(key.view);
+    hashes.push(key.hash);
+    ids.insert(key, new_id);
 
-    return some(result);
+    return new_id;
 }
 
-String_View String_View::subview(size_t start, size_t count) const
+Maybe<uint32_t> Interner::find(String_View view)
 {
-    if (start + count <= this->count) {
-        return {count, data + start};
+    auto id = ids.get({view, hash(view)});
+    if (!id.has_value) {
+        return {};
     }
-
-    return {};
+    return some(*id.unwrap);
 }
 
-bool String_View::operator<(String_View b) const
+String_View Interner::view(uint32_t id) const
 {
-    auto a = *this;
-    while (a.count > 0 && b.count > 0) {
-        if (*a.data != *b.data) {
-            return *a.data < *b.data;
-        }
-        a.chop_left(1);
-        b.chop_left(1);
-    }
-
-    return a.count < b.count;
+    return views[id];
 }
 
-bool String_View::operator==(String_View view) const
+unsigned long Interner::hash_of(uint32_t id) const
 {
-    if (this->count != view.count) return false;
-    return memcmp(this->data, view.data, this->count) == 0;
+    return hashes[id];
 }
 
-bool String_View::operator!=(String_View view) const
+size_t Interner::count() const
 {
-    return !(*this == view);
+    return views.size;
 }
 
-bool String_View::has_prefix(String_View prefix) const
+void destroy(Interner interner)
 {
-    return prefix.count <= this->count
-           && this->subview(0, prefix.count) == prefix;
+    for (size_t i = 0; i < interner.chunks.size; ++i) {
+        destroy(interner.chunks[i]);
+    }
+    destroy(interner.chunks);
+    destroy(interner.hashes);
+    destroy(interner.views);
+    destroy(interner.ids);
 }
 
-bool String_View::has_suffix(String_View suffix) const
+////////////////////////////////////////////////////////////
+// PIECE TABLE
+////////////////////////////////////////////////////////////
+
+static size_t piece_table_length(const Piece_Table::Node *node)
 {
-    return suffix.count <= this->count
-           && this->subview(this->count - suffix.count, suffix.count) == suffix;
+    return node ? node->length : 0;
 }
 
-size_t String_View::count_chars(char x) const
+static size_t piece_table_lines(const Piece_Table::Node *node)
 {
-    size_t result = 0;
-    for (size_t i = 0; i < count; ++i) {
-        if (data[i] == x) {
-            result += 1;
-        }
-    }
-    return result;
+    return node ? node->lines : 0;
 }
 
-String_View operator ""_sv(const char *data, size_t count)
+static void piece_table_update(Piece_Table::Node *node)
 {
-    return {count, data};
+    node->length = piece_table_length(node->left) + node->piece.count + piece_table_length(node->right);
+    node->lines = piece_table_lines(node->left) + node->piece_lines + piece_table_lines(node->right);
 }
 
-String_View cstr_as_string_view(const char *cstr)
+static void piece_table_destroy_node(Piece_Table::Node *node)
 {
-    return {strlen(cstr), cstr};
+    if (node) {
+        piece_table_destroy_node(node->left);
+        piece_table_destroy_node(node->right);
+        mtor.dealloc(node, 1);
+    }
 }
 
-void print1(FILE *stream, String_View view)
+Piece_Table::Node *Piece_Table::new_node(String_View piece)
 {
-    fwrite(view.data, 1, view.count, stream);
+    if (seed == 0) {
+        seed = 2463534242;
+    }
+
+    // NOTE: xorshift32
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    Node *node = mtor.alloc<Node>(1);
+    node->piece = piece;
+    node->piece_lines = piece.count_chars('\n');
+    node->length = piece.count;
+    node->lines = node->piece_lines;
+    node->priority = seed;
+    return node;
 }
 
-void destroy(String_View sv)
+Piece_Table::Node *Piece_Table::merge(Node *a, Node *b)
 {
-    mtor.dealloc(sv.data, sv.count);
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+
+    if (a->priority > b->priority) {
+        a->right = merge(a->right, b);
+        piece_table_update(a);
+        return a;
+    } else {
+        b->left = merge(a, b->left);
+        piece_table_update(b);
+        return b;
+    }
 }
 
-char *Args::shift()
+void Piece_Table::split(Node *node, size_t position, Node **left, Node **right)
 {
-    char *result = *argv;
-    argv += 1;
-    argc -= 1;
-    return result;
+    if (node == nullptr) {
+        *left = nullptr;
+        *right = nullptr;
+        return;
+    }
+
+    size_t left_length = piece_table_length(node->left);
+
+    if (position <= left_length) {
+        split(node->left, position, left, &node->left);
+        piece_table_update(node);
+        *right = node;
+    } else if (position >= left_length + node->piece.count) {
+        split(node->right, position - left_length - node->piece.count, &node->right, right);
+        piece_table_update(node);
+        *left = node;
+    } else {
+        size_t offset = position - left_length;
+        Node *tail = new_node(node->piece.subview(offset, node->piece.count - offset));
+        node->piece = node->piece.subview(0, offset);
+        node->piece_lines -= tail->piece_lines;
+
+        *right = merge(tail, node->right);
+        node->right = nullptr;
+        piece_table_update(node);
+        *left = node;
+    }
 }
 
-bool Args::empty()
+// NOTE: appends the text to the end of the subtree. If the last piece
+// of the subtree ends right where the text starts in the add buffer,
+// the piece is extended instead of creating a new one, which keeps
+// typing character by character from fragmenting the table.
+Piece_Table::Node *Piece_Table::append_pieces(Node *node, String_View text)
 {
-    return argc == 0;
+    if (node) {
+        Node *last = node;
+        while (last->right) {
+            last = last->right;
+        }
+
+        String_View chunk = add_chunks.size > 0 ? add_chunks[add_chunks.size - 1] : String_View {};
+        if (chunk.data <= last->piece.data &&
+                last->piece.data < chunk.data + chunk.count &&
+                last->piece.data + last->piece.count == text.data) {
+            size_t n = min(text.count, PIECE_TABLE_MAX_PIECE_SIZE - min(PIECE_TABLE_MAX_PIECE_SIZE, last->piece.count));
+            if (n > 0) {
+                String_View head = text.chop_left(n);
+                size_t head_lines = head.count_chars('\n');
+                last->piece.count += n;
+                last->piece_lines += head_lines;
+                for (Node *iter = node; iter; iter = iter->right) {
+                    iter->length += n;
+                    iter->lines += head_lines;
+                }
+            }
+        }
+    }
+
+    while (text.count > 0) {
+        node = merge(node, new_node(text.chop_left(PIECE_TABLE_MAX_PIECE_SIZE)));
+    }
+
+    return node;
 }
 
-String_View String_Buffer::view() const
+void Piece_Table::insert(size_t position, String_View text)
 {
-    return {size, data};
+    const size_t PIECE_TABLE_ADD_CHUNK_CAPACITY = 64 * 1024;
+
+    position = min(position, count());
+
+    if (text.count == 0) {
+        return;
+    }
+
+    if (add_chunks.size == 0 || add_chunks[add_chunks.size - 1].count - add_size < text.count) {
+        size_t capacity = max(PIECE_TABLE_ADD_CHUNK_CAPACITY, text.count);
+        add_chunks.push({capacity, mtor.alloc<char>(capacity)});
+        add_size = 0;
+    }
+
+    char *data = const_cast<char*>(add_chunks[add_chunks.size - 1].data) + add_size;
+    memcpy(data, text.data, text.count);
+    add_size += text.count;
+
+    Node *left = nullptr;
+    Node *right = nullptr;
+    split(root, position, &left, &right);
+    root = merge(append_pieces(left, {text.count, data}), right);
 }
 
-void sprint1(String_Buffer *buffer, const char *cstr)
+void Piece_Table::remove(size_t position, size_t count)
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%s", cstr);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    Node *left = nullptr;
+    Node *middle = nullptr;
+    Node *right = nullptr;
+    split(root, position, &left, &right);
+    split(right, count, &middle, &right);
+    piece_table_destroy_node(middle);
+    root = merge(left, right);
 }
 
-void sprint1(String_Buffer *buffer, String_View view)
+size_t Piece_Table::count() const
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%.*s", (int) view.count, view.data);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    return piece_table_length(root);
 }
 
-void sprint1(String_Buffer *buffer, char c)
+size_t Piece_Table::lines_count() const
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%c", c);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    return piece_table_lines(root) + 1;
 }
 
-void sprint1(String_Buffer *buffer, float f)
+Maybe<size_t> Piece_Table::line_start(size_t line) const
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%f", f);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    if (line == 0) {
+        return some((size_t) 0);
+    }
+
+    if (line > piece_table_lines(root)) {
+        return {};
+    }
+
+    size_t offset = 0;
+    const Node *node = root;
+    while (node) {
+        if (line <= piece_table_lines(node->left)) {
+            node = node->left;
+            continue;
+        }
+
+        line -= piece_table_lines(node->left);
+        offset += piece_table_length(node->left);
+
+        if (line <= node->piece_lines) {
+            for (size_t i = 0; i < node->piece.count; ++i) {
+                if (node->piece.data[i] == '\n') {
+                    line -= 1;
+                    if (line == 0) {
+                        return some(offset + i + 1);
+                    }
+                }
+            }
+            UNREACHABLE("Piece_Table: inconsistent line count of a piece");
+        }
+
+        line -= node->piece_lines;
+        offset += node->piece.count;
+        node = node->right;
+    }
+
+    UNREACHABLE("Piece_Table: inconsistent line count of the tree");
 }
 
-void sprint1(String_Buffer *buffer, unsigned long long x)
+size_t Piece_Table::line_of(size_t position) const
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%llu", x);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    size_t line = 0;
+    const Node *node = root;
+    while (node) {
+        size_t left_length = piece_table_length(node->left);
+        if (position < left_length) {
+            node = node->left;
+            continue;
+        }
+
+        line += piece_table_lines(node->left);
+        position -= left_length;
+
+        if (position < node->piece.count) {
+            return line + node->piece.subview(0, position).count_chars('\n');
+        }
+
+        line += node->piece_lines;
+        position -= node->piece.count;
+        node = node->right;
+    }
+
+    return line;
 }
 
-void sprint1(String_Buffer *buffer, unsigned int x)
+Piece_Table piece_table_of(String_View original)
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%u", x);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    Piece_Table result = {};
+    result.root = result.append_pieces(nullptr, original);
+    return result;
 }
 
-void sprint1(String_Buffer *buffer, long unsigned int x)
+void destroy(Piece_Table piece_table)
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%lu", x);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    piece_table_destroy_node(piece_table.root);
+    for (size_t i = 0; i < piece_table.add_chunks.size; ++i) {
+        destroy(piece_table.add_chunks[i]);
+    }
+    destroy(piece_table.add_chunks);
 }
 
-void sprint1(String_Buffer *buffer, int x)
+void print1(FILE *stream, const Piece_Table &piece_table)
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%d", x);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+    piece_table.for_each_piece([stream](String_View piece) {
+        print1(stream, piece);
+    });
 }
 
-void sprint1(String_Buffer *buffer, long int x)
+////////////////////////////////////////////////////////////
+// PROFILE
+////////////////////////////////////////////////////////////
+
+uint64_t profile_now(void)
 {
-    int n = snprintf(
-                buffer->data + buffer->size,
-                buffer->capacity - buffer->size,
-                "%ld", x);
-    buffer->size = min(buffer->size + n, buffer->capacity - 1);
+#ifdef _WIN32
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    const uint64_t ticks = (uint64_t) counter.QuadPart;
+    const uint64_t freq = (uint64_t) frequency.QuadPart;
+    return ticks / freq * 1000000000 + ticks % freq * 1000000000 / freq;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
 }
 
-void sprint1(String_Buffer *buffer, bool b)
+#ifdef AIDS_PROFILE
+
+static std::atomic<Profile_Thread*> profile_threads = {nullptr};
+static std::atomic<uint32_t> profile_threads_count = {0};
+static thread_local Profile_Thread *profile_current_thread = nullptr;
+
+// NOTE: the buffers of the threads are never freed, so the zones of
+// the threads that already finished can still be dumped.
+static Profile_Thread *profile_register_thread(void)
 {
-    sprint1(buffer, b ? "true" : "false");
+    Profile_Thread *thread = mtor.alloc<Profile_Thread>(1);
+    thread->events = mtor.alloc<Profile_Event>(AIDS_PROFILE_CAPACITY);
+    thread->id = profile_threads_count.fetch_add(1);
+
+    thread->next = profile_threads.load();
+    while (!profile_threads.compare_exchange_weak(thread->next, thread)) {}
+
+    profile_current_thread = thread;
+    return thread;
 }
 
-void sprint1(String_Buffer *buffer, Pad pad)
+Profile_Zone profile_zone_begin(const char *name)
 {
-    for (size_t i = 0; i < pad.n; ++i) {
-        sprint1(buffer, pad.c);
-    }
+    return {name, profile_now()};
 }
 
-void sprint1(String_Buffer *buffer, Caps caps)
+void profile_zone_end(Profile_Zone zone)
 {
-    for (size_t i = 0; i < caps.unwrap.count; ++i) {
-        sprint1(buffer, (char) toupper(caps.unwrap.data[i]));
+    const uint64_t end = profile_now();
+
+    Profile_Thread *thread = profile_current_thread;
+    if (thread == nullptr) {
+        thread = profile_register_thread();
     }
+
+    thread->events[thread->count & (AIDS_PROFILE_CAPACITY - 1)] = {zone.name, zone.begin, end};
+    thread->count += 1;
 }
 
-void sprint1(String_Buffer *buffer, String_Buffer another_buffer)
+template <typename F>
+static void profile_for_each_event(F f)
 {
-    sprint1(buffer, another_buffer.view());
+    for (Profile_Thread *thread = profile_threads.load();
+            thread != nullptr;
+            thread = thread->next) {
+        const uint64_t first = thread->count > AIDS_PROFILE_CAPACITY
+                               ? thread->count - AIDS_PROFILE_CAPACITY
+                               : 0;
+        for (uint64_t i = first; i < thread->count; ++i) {
+            f(*thread, thread->events[i & (AIDS_PROFILE_CAPACITY - 1)]);
+        }
+    }
 }
 
-////////////////////////////////////////////////////////////
-// PRINT
-////////////////////////////////////////////////////////////
+struct Profile_Micros {
+    uint64_t nanos;
+};
 
-void print1(FILE *stream, const char *s)
+static void print1(FILE *stream, Profile_Micros micros)
 {
-    fwrite(s, 1, strlen(s), stream);
+    fprintf(stream, "%llu.%03llu",
+            (unsigned long long) (micros.nanos / 1000),
+            (unsigned long long) (micros.nanos % 1000));
 }
 
-void print1(FILE *stream, char *s)
+void profile_dump_chrome_trace(FILE *stream)
 {
-    fwrite(s, 1, strlen(s), stream);
+    uint64_t origin = UINT64_MAX;
+    profile_for_each_event([&](const Profile_Thread &, const Profile_Event &event) {
+        origin = min(origin, event.begin);
+    });
+
+    println(stream, "{\"traceEvents\":[");
+    bool first = true;
+    profile_for_each_event([&](const Profile_Thread &thread, const Profile_Event &event) {
+        println(stream, first ? "" : ",",
+                "{\"name\":\"", Json_Escape {cstr_as_string_view(event.name)}, "\",",
+                "\"ph\":\"X\",",
+                "\"ts\":", Profile_Micros {event.begin - origin}, ",",
+                "\"dur\":", Profile_Micros {event.end - event.begin}, ",",
+                "\"pid\":0,",
+                "\"tid\":", thread.id, "}");
+        first = false;
+    });
+    println(stream, "],\"displayTimeUnit\":\"ns\"}");
 }
 
-void print1(FILE *stream, char c)
-{
-    fputc(c, stream);
-}
+struct Profile_Stats {
+    String_View name;
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+};
 
-void print1(FILE *stream, float f)
+static void profile_print_column(FILE *stream, uint64_t x)
 {
-    fprintf(stream, "%f", f);
+    const size_t COLUMN_WIDTH = 14;
+    char buffer[32];
+    String_Buffer sbuffer = {sizeof(buffer), buffer, 0};
+    sprint1(&sbuffer, (unsigned long long) x);
+    print(stream, Pad {COLUMN_WIDTH - min(COLUMN_WIDTH, sbuffer.size), ' '}, sbuffer);
 }
 
-void print1(FILE *stream, unsigned long long x)
+void profile_dump_summary(FILE *stream)
 {
-    fprintf(stream, "%llu", x);
+    // NOTE: the zones are grouped by their names rather than by the
+    // name pointers, since the same literal is not guaranteed to have
+    // the same address in different translation units.
+    Hash_Map<String_View, size_t> indices = {};
+    defer(destroy(indices));
+    Dynamic_Array<Profile_Stats> stats = {};
+    defer(destroy(stats));
+    uint64_t dropped = 0;
+
+    for (Profile_Thread *thread = profile_threads.load();
+            thread != nullptr;
+            thread = thread->next) {
+        if (thread->count > AIDS_PROFILE_CAPACITY) {
+            dropped += thread->count - AIDS_PROFILE_CAPACITY;
+        }
+    }
+
+    profile_for_each_event([&](const Profile_Thread &, const Profile_Event &event) {
+        const String_View name = cstr_as_string_view(event.name);
+        const uint64_t duration = event.end - event.begin;
+
+        Maybe<size_t*> index = indices.get(name);
+        if (!index.has_value) {
+            indices.insert(name, stats.size);
+            stats.push({name, 0, 0, UINT64_MAX, 0});
+            index = indices.get(name);
+        }
+
+        Profile_Stats *zone = &stats.data[*index.unwrap];
+        zone->count += 1;
+        zone->total += duration;
+        zone->min = min(zone->min, duration);
+        zone->max = max(zone->max, duration);
+    });
+
+    for (size_t i = 1; i < stats.size; ++i) {
+        for (size_t j = i; j > 0 && stats.data[j - 1].total < stats.data[j].total; --j) {
+            swap(&stats.data[j - 1], &stats.data[j]);
+        }
+    }
+
+    size_t name_width = 4;
+    for (size_t i = 0; i < stats.size; ++i) {
+        name_width = max(name_width, stats.data[i].name.count);
+    }
+
+    print(stream, "zone", Pad {name_width - 4, ' '});
+    print(stream, "         count", "    total (ns)", "     mean (ns)", "      min (ns)", "      max (ns)");
+    println(stream);
+
+    for (size_t i = 0; i < stats.size; ++i) {
+        const Profile_Stats &zone = stats.data[i];
+        print(stream, zone.name, Pad {name_width - zone.name.count, ' '});
+        profile_print_column(stream, zone.count);
+        profile_print_column(stream, zone.total);
+        profile_print_column(stream, zone.total / zone.count);
+        profile_print_column(stream, zone.min);
+        profile_print_column(stream, zone.max);
+        println(stream);
+    }
+
+    if (dropped > 0) {
+        println(stream, "(", (unsigned long long) dropped, " oldest zones were overwritten and are not included)");
+    }
 }
 
-void print1(FILE *stream, long unsigned int x)
+#endif // AIDS_PROFILE
+
+////////////////////////////////////////////////////////////
+// THREADS
+////////////////////////////////////////////////////////////
+
+#ifdef AIDS_THREADS
+
+#if defined(__linux__)
+
+void futex_wait(std::atomic<uint32_t> *word, uint32_t expected)
 {
-    fprintf(stream, "%lu", x);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
 }
 
-void print1(FILE *stream, unsigned int x)
+void futex_wake_one(std::atomic<uint32_t> *word)
 {
-    fprintf(stream, "%u", x);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
 }
 
-void print1(FILE *stream, int x)
+void futex_wake_all(std::atomic<uint32_t> *word)
 {
-    fprintf(stream, "%d", x);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
 }
 
-void print1(FILE *stream, long int x)
+#elif defined(_WIN32)
+
+void futex_wait(std::atomic<uint32_t> *word, uint32_t expected)
 {
-    fprintf(stream, "%ld", x);
+    WaitOnAddress(reinterpret_cast<volatile VOID*>(word), &expected, sizeof(expected), INFINITE);
 }
 
-void print1(FILE *stream, bool b)
+void futex_wake_one(std::atomic<uint32_t> *word)
 {
-    print1(stream, b ? "true" : "false");
+    WakeByAddressSingle(reinterpret_cast<PVOID>(word));
 }
 
-void print1(FILE *stream, Escape escape)
+void futex_wake_all(std::atomic<uint32_t> *word)
 {
-    for (size_t i = 0; i < escape.unwrap.count; ++i) {
-        switch (escape.unwrap.data[i]) {
-        case '\a':
-            print(stream, "\\a");
-            break;
-        case '\b':
-            print(stream, "\\b");
-            break;
-        case '\f':
-            print(stream, "\\f");
-            break;
-        case '\n':
-            print(stream, "\\n");
-            break;
-        case '\r':
-            print(stream, "\\r");
-            break;
-        case '\t':
-            print(stream, "\\t");
-            break;
-        case '\v':
-            print(stream, "\\v");
-            break;
-        default:
-            print(stream, escape.unwrap.data[i]);
-        }
-    }
+    WakeByAddressAll(reinterpret_cast<PVOID>(word));
 }
 
-void print1(FILE *stream, Pad pad)
+#else
+
+// NOTE: all of the words share one condition variable, so every wake
+// wakes all of the waiters and the ones waiting on other words just
+// recheck them and go back to sleep.
+static pthread_mutex_t futex_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t futex_cond = PTHREAD_COND_INITIALIZER;
+
+void futex_wait(std::atomic<uint32_t> *word, uint32_t expected)
 {
-    for (size_t i = 0; i < pad.n; ++i) {
-        fputc(pad.c, stream);
+    pthread_mutex_lock(&futex_mutex);
+    if (word->load() == expected) {
+        pthread_cond_wait(&futex_cond, &futex_mutex);
     }
+    pthread_mutex_unlock(&futex_mutex);
 }
 
-void print1(FILE *stream, Caps caps)
+void futex_wake_one(std::atomic<uint32_t> *word)
 {
-    for (size_t i = 0; i < caps.unwrap.count; ++i) {
-        print1(stream, (char) toupper(caps.unwrap.data[i]));
-    }
+    futex_wake_all(word);
 }
 
-void print1(FILE *stream, String_Buffer buffer)
+void futex_wake_all(std::atomic<uint32_t> *)
 {
-    print1(stream, buffer.view());
+    pthread_mutex_lock(&futex_mutex);
+    pthread_mutex_unlock(&futex_mutex);
+    pthread_cond_broadcast(&futex_cond);
 }
 
-////////////////////////////////////////////////////////////
-// UTF-8
-////////////////////////////////////////////////////////////
+#endif
 
-String_View Utf8_Char::view()
+size_t hardware_threads_count(void)
 {
-    String_View result = {
-        count,
-        reinterpret_cast<const char *>(bytes)
-    };
-
-    return result;
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return max((size_t) info.dwNumberOfProcessors, (size_t) 1);
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t) count : 1;
+#endif
 }
 
-void print1(FILE *stream, Utf8_Char uchar)
+static void thread_pool_pause(void)
 {
-    print(stream, String_View {uchar.count, reinterpret_cast<const char*>(uchar.bytes)});
+#if defined(AIDS_SSE2)
+    _mm_pause();
+#endif
 }
 
-Utf8_Char code_to_utf8(uint32_t code)
+// NOTE: spins for a while before going to sleep, since the next
+// parallel_for() usually comes right after the previous one.
+static uint32_t thread_pool_wait_while(std::atomic<uint32_t> *word, uint32_t value)
 {
-    if (/*0x0000 <= code && */code <= 0x007F) {
-        // 0xxxxxxx
-        // 1 byte
-        return Utf8_Char {
-            {(uint8_t) code, 0, 0, 0},
-            1,
-        };
-    } else if (0x0080 <= code && code <= 0x07FF) {
-        // 110xxxxx 10xxxxxx
-        // 2 bytes
-        return Utf8_Char {
-            {
-                (uint8_t) (((code & 0b00111111000000) >> 6) | 0b11000000),
-                (uint8_t) (((code & 0b00000000111111) >> 0) | 0b10000000),
-                0,
-                0
-            },
-            2
-        };
-    } else if (0x0800 <= code && code <= 0xFFFF) {
-        // 3 bytes
-        // 1110xxxx 10xxxxxx 10xxxxxx
-        return Utf8_Char {
-            {
-                (uint8_t) (((code & 0b1111000000000000) >> 12) | 0b11100000),
-                (uint8_t) (((code & 0b0000111111000000) >> 6)  | 0b10000000),
-                (uint8_t) (((code & 0b0000000000111111) >> 0)  | 0b10000000),
-                0
-            },
-            3
-        };
-    } else if (0x10000 <= code && code <= 0x10FFFF) {
-        // 4 bytes
-        // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-        return Utf8_Char {
-            {
-                (uint8_t) (((code & 0b111000000000000000000) >> 18) | 0b11110000),
-                (uint8_t) (((code & 0b000111111000000000000) >> 12) | 0b10000000),
-                (uint8_t) (((code & 0b000000000111111000000) >> 6)  | 0b10000000),
-                (uint8_t) (((code & 0b000000000000000111111) >> 0)  | 0b10000000),
-            },
-            4
-        };
+    const size_t SPIN_COUNT = 4 * 1024;
+
+    for (size_t i = 0; i < SPIN_COUNT; ++i) {
+        uint32_t current = word->load();
+        if (current != value) {
+            return current;
+        }
+        thread_pool_pause();
     }
 
-    panic("The code ", code, " point is too big");
+    uint32_t current = word->load();
+    while (current == value) {
+        futex_wait(word, value);
+        current = word->load();
+    }
+    return current;
 }
 
-// TODO: utf8_get_code does not check for overlong sequences and the codes being the UTF-16 surrogate pairs range
-Maybe<uint32_t> utf8_get_code(String_View view, size_t *size)
+// NOTE: the range of chunks a thread has not taken yet. The owner
+// takes chunks from the front, the thieves take halves from the back.
+// Both ends are packed into one word so a single compare-exchange
+// decides who gets a chunk.
+struct Thread_Pool_Slot {
+    std::atomic<uint64_t> range;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+static uint64_t thread_pool_range(uint64_t front, uint64_t back)
 {
-    const uint8_t UTF8_1BYTE_MASK      = 1 << 7;
-    const uint8_t UTF8_2BYTES_MASK     = 1 << 5;
-    const uint8_t UTF8_3BYTES_MASK     = 1 << 4;
-    const uint8_t UTF8_4BYTES_MASK     = 1 << 3;
-    const uint8_t UTF8_EXTRA_BYTE_MASK = 1 << 6;
-
-    if (view.count >= 1 &&
-            (*view.data & UTF8_1BYTE_MASK) == 0) {
-        *size = 1;
-        return some(static_cast<uint32_t>(*view.data));
-    }
-
-    if (view.count >= 2 &&
-            (view.data[0] & UTF8_2BYTES_MASK) == 0 &&
-            (view.data[1] & UTF8_EXTRA_BYTE_MASK) == 0) {
-        *size = 2;
-        const auto byte1 = static_cast<uint32_t>((view.data[0] & (UTF8_2BYTES_MASK - 1)) << 6);
-        const auto byte2 = static_cast<uint32_t>(view.data[1] & (UTF8_EXTRA_BYTE_MASK - 1));
-        return some(byte1 | byte2);
-    }
-
-    if (view.count >= 3 &&
-            (view.data[0] & UTF8_3BYTES_MASK) == 0 &&
-            (view.data[1] & UTF8_EXTRA_BYTE_MASK) == 0 &&
-            (view.data[2] & UTF8_EXTRA_BYTE_MASK) == 0) {
-        *size = 3;
-        const auto byte1 = static_cast<uint32_t>((view.data[0] & (UTF8_3BYTES_MASK - 1)) << (6 * 2));
-        const auto byte2 = static_cast<uint32_t>((view.data[1] & (UTF8_EXTRA_BYTE_MASK - 1)) << 6);
-        const auto byte3 = static_cast<uint32_t>(view.data[2] & (UTF8_EXTRA_BYTE_MASK - 1));
-        return some(byte1 | byte2 | byte3);
-    }
-
-    if (view.count >= 4 &&
-            (view.data[0] & UTF8_4BYTES_MASK) == 0 &&
-            (view.data[1] & UTF8_EXTRA_BYTE_MASK) == 0 &&
-            (view.data[2] & UTF8_EXTRA_BYTE_MASK) == 0 &&
-            (view.data[3] & UTF8_EXTRA_BYTE_MASK) == 0) {
-        *size = 4;
-        const auto byte1 = static_cast<uint32_t>((view.data[0] & (UTF8_3BYTES_MASK - 1)) << (6 * 3));
-        const auto byte2 = static_cast<uint32_t>((view.data[1] & (UTF8_EXTRA_BYTE_MASK - 1)) << (6 * 2));
-        const auto byte3 = static_cast<uint32_t>((view.data[2] & (UTF8_EXTRA_BYTE_MASK - 1)) << 6);
-        const auto byte4 = static_cast<uint32_t>(view.data[3] & (UTF8_EXTRA_BYTE_MASK - 1));
-        return some(byte1 | byte2 | byte3 | byte4);
-    }
+    return (front << 32) | back;
+}
 
-    return {};
+static uint64_t thread_pool_front(uint64_t range)
+{
+    return range >> 32;
 }
 
-void print1(FILE *stream, Hex<uint32_t> hex)
+static uint64_t thread_pool_back(uint64_t range)
 {
-    fprintf(stream, "%x", hex.unwrap);
+    return range & 0xFFFFFFFF;
 }
 
-void print1(FILE *stream, Hex<char> hex)
+struct Thread_Pool_Worker {
+    Thread_Pool::Impl *impl;
+    size_t thread;
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+};
+
+struct Thread_Pool::Impl {
+    size_t threads_count;
+    Thread_Pool_Worker *workers;
+    Thread_Pool_Slot *slots;
+
+    std::atomic<uint32_t> generation;
+    std::atomic<uint32_t> pending;
+    std::atomic<bool> busy;
+    std::atomic<bool> quit;
+
+    Thread_Pool_Task task;
+    void *context;
+    size_t begin;
+    size_t end;
+    size_t grain;
+};
+
+static void thread_pool_participate(Thread_Pool::Impl *impl, size_t thread)
 {
-    fprintf(stream, "%hhx", hex.unwrap);
+    Thread_Pool_Slot *own = &impl->slots[thread];
+
+    while (true) {
+        uint64_t range = own->range.load();
+        while (thread_pool_front(range) < thread_pool_back(range)) {
+            const uint64_t chunk = thread_pool_front(range);
+            if (own->range.compare_exchange_weak(range, thread_pool_range(chunk + 1, thread_pool_back(range)))) {
+                const size_t begin = impl->begin + (size_t) chunk * impl->grain;
+                const size_t end = min(impl->end, begin + impl->grain);
+                impl->task(impl->context, thread, begin, end);
+                range = own->range.load();
+            }
+        }
+
+        bool stolen = false;
+        for (size_t i = 1; i < impl->threads_count && !stolen; ++i) {
+            Thread_Pool_Slot *victim = &impl->slots[(thread + i) % impl->threads_count];
+            uint64_t victim_range = victim->range.load();
+            while (thread_pool_front(victim_range) < thread_pool_back(victim_range)) {
+                const uint64_t front = thread_pool_front(victim_range);
+                const uint64_t back = thread_pool_back(victim_range);
+                const uint64_t half = (back - front + 1) / 2;
+                if (victim->range.compare_exchange_weak(victim_range, thread_pool_range(front, back - half))) {
+                    own->range.store(thread_pool_range(back - half, back));
+                    stolen = true;
+                    break;
+                }
+            }
+        }
+
+        if (!stolen) {
+            return;
+        }
+    }
 }
 
-void print1(FILE *stream, HEX<uint32_t> hex)
+static void thread_pool_work(Thread_Pool_Worker *worker)
 {
-    fprintf(stream, "%X", hex.unwrap);
+    Thread_Pool::Impl *impl = worker->impl;
+    uint32_t generation = 0;
+
+    while (true) {
+        generation = thread_pool_wait_while(&impl->generation, generation);
+        if (impl->quit.load()) {
+            return;
+        }
+
+        thread_pool_participate(impl, worker->thread);
+
+        if (impl->pending.fetch_sub(1) == 1) {
+            futex_wake_all(&impl->pending);
+        }
+    }
 }
 
-void print1(FILE *stream, HEX<char> hex)
+#ifdef _WIN32
+static DWORD WINAPI thread_pool_worker_entry(LPVOID worker)
 {
-    fprintf(stream, "%hhX", hex.unwrap);
+    thread_pool_work(static_cast<Thread_Pool_Worker*>(worker));
+    return 0;
+}
+#else
+static void *thread_pool_worker_entry(void *worker)
+{
+    thread_pool_work(static_cast<Thread_Pool_Worker*>(worker));
+    return nullptr;
 }
+#endif
 
-void print1(FILE *stream, Hex_Bytes hex_bytes)
+Thread_Pool thread_pool_of(size_t threads_count)
 {
-    print(stream, "[");
-    for (size_t i = 0; i < hex_bytes.unwrap.count; ++i) {
-        print(stream, i == 0 ? "" : ", ", Hex<char> { hex_bytes.unwrap.data[i] });
+    threads_count = max(threads_count, (size_t) 1);
+
+    // NOTE: std::atomic can't be copied, so Impl does not go through
+    // Mtor::alloc() and relies on zeroed atomics being zero.
+    Thread_Pool::Impl *impl = static_cast<Thread_Pool::Impl*>(calloc(1, sizeof(Thread_Pool::Impl)));
+    impl->threads_count = threads_count;
+    impl->slots = static_cast<Thread_Pool_Slot*>(calloc(threads_count, sizeof(Thread_Pool_Slot)));
+    impl->workers = mtor.alloc<Thread_Pool_Worker>(threads_count);
+
+    for (size_t thread = 1; thread < threads_count; ++thread) {
+        Thread_Pool_Worker *worker = &impl->workers[thread];
+        worker->impl = impl;
+        worker->thread = thread;
+#ifdef _WIN32
+        worker->handle = CreateThread(NULL, 0, thread_pool_worker_entry, worker, 0, NULL);
+        if (worker->handle == NULL) {
+            panic("Could not create a thread: ", (unsigned long) GetLastError());
+        }
+#else
+        int error = pthread_create(&worker->handle, NULL, thread_pool_worker_entry, worker);
+        if (error != 0) {
+            panic("Could not create a thread: ", strerror(error));
+        }
+#endif
     }
-    print(stream, "]");
+
+    return {impl};
 }
 
-void print1(FILE *stream, Newline)
+void destroy(Thread_Pool pool)
 {
-    print(stream, '\n');
+    Thread_Pool::Impl *impl = pool.impl;
+    if (impl == nullptr) {
+        return;
+    }
+
+    impl->quit.store(true);
+    impl->generation.fetch_add(1);
+    futex_wake_all(&impl->generation);
+
+    for (size_t thread = 1; thread < impl->threads_count; ++thread) {
+#ifdef _WIN32
+        WaitForSingleObject(impl->workers[thread].handle, INFINITE);
+        CloseHandle(impl->workers[thread].handle);
+#else
+        pthread_join(impl->workers[thread].handle, NULL);
+#endif
+    }
+
+    mtor.dealloc(impl->workers, impl->threads_count);
+    free(impl->slots);
+    free(impl);
 }
 
-////////////////////////////////////////////////////////////
-// Hash_Map
-////////////////////////////////////////////////////////////
+size_t Thread_Pool::threads_count() const
+{
+    return impl ? impl->threads_count : 1;
+}
 
-// NOTE: stolen from http://www.cse.yorku.ca/~oz/hash.html
-unsigned long hash(String_View str)
+void Thread_Pool::run(size_t begin, size_t end, size_t grain,
+                      Thread_Pool_Task task, void *context) const
 {
-    unsigned long hash = 5381;
-    for (size_t i = 0; i < str.count; ++i) {
-        hash = ((hash << 5) + hash) + str.data[i];
+    if (end <= begin) {
+        return;
     }
-    return hash;
+
+    grain = max(grain, (size_t) 1);
+    size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks > UINT32_MAX) {
+        grain = (end - begin + UINT32_MAX - 1) / UINT32_MAX;
+        chunks = (end - begin + grain - 1) / grain;
+    }
+
+    if (impl == nullptr || impl->threads_count == 1 || chunks == 1 || impl->busy.exchange(true)) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            const size_t chunk_begin = begin + chunk * grain;
+            task(context, 0, chunk_begin, min(end, chunk_begin + grain));
+        }
+        return;
+    }
+
+    impl->task = task;
+    impl->context = context;
+    impl->begin = begin;
+    impl->end = end;
+    impl->grain = grain;
+    for (size_t thread = 0; thread < impl->threads_count; ++thread) {
+        impl->slots[thread].range.store(thread_pool_range(
+                                            chunks * thread / impl->threads_count,
+                                            chunks * (thread + 1) / impl->threads_count));
+    }
+    impl->pending.store((uint32_t) (impl->threads_count - 1));
+
+    impl->generation.fetch_add(1);
+    futex_wake_all(&impl->generation);
+
+    thread_pool_participate(impl, 0);
+
+    uint32_t pending = impl->pending.load();
+    while (pending != 0) {
+        pending = thread_pool_wait_while(&impl->pending, pending);
+    }
+
+    impl->busy.store(false);
 }
 
+#endif // AIDS_THREADS
+
 } // namespace aids
 
 #endif // AIDS_IMPLEMENTATION
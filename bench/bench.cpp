@@ -0,0 +1,710 @@
+#define AIDS_THREADS
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+////////////////////////////////////////////////////////////
+// HARNESS
+////////////////////////////////////////////////////////////
+
+const size_t BENCH_WARMUP = 2;
+const size_t BENCH_REPETITIONS = 15;
+
+// NOTE: every benchmark folds its results into the sink so the
+// compiler can't throw the measured work away.
+volatile uint64_t bench_sink = 0;
+
+const char *bench_filter = nullptr;
+
+bool bench_selected(const char *name)
+{
+    return !bench_filter || cstr_as_string_view(name).has_prefix(cstr_as_string_view(bench_filter));
+}
+
+// NOTE: runs f() BENCH_WARMUP times, then measures BENCH_REPETITIONS
+// runs of it. Every run is expected to perform `ops` operations over
+// `bytes` bytes of input (0 if throughput in bytes makes no sense).
+template <typename F>
+void bench(const char *name, size_t ops, size_t bytes, F f)
+{
+    if (!bench_selected(name)) {
+        return;
+    }
+
+    String_View name_view = cstr_as_string_view(name);
+
+    for (size_t i = 0; i < BENCH_WARMUP; ++i) {
+        bench_sink = bench_sink + f();
+    }
+
+    uint64_t samples[BENCH_REPETITIONS];
+    for (size_t i = 0; i < BENCH_REPETITIONS; ++i) {
+        uint64_t begin = profile_now();
+        bench_sink = bench_sink + f();
+        samples[i] = profile_now() - begin;
+    }
+
+    for (size_t i = 1; i < BENCH_REPETITIONS; ++i) {
+        for (size_t j = i; j > 0 && samples[j] < samples[j - 1]; --j) {
+            swap(&samples[j], &samples[j - 1]);
+        }
+    }
+
+    const double median = (double) samples[BENCH_REPETITIONS / 2];
+    const double p10 = (double) samples[BENCH_REPETITIONS / 10];
+    const double p90 = (double) samples[BENCH_REPETITIONS * 9 / 10];
+
+    const size_t NAME_WIDTH = 36;
+    print(stdout, name_view, Pad {NAME_WIDTH - min(NAME_WIDTH, name_view.count), ' '},
+          Fixed {median / (double) ops, 2, 10}, " ns/op",
+          "  [p10 ", Fixed {p10 / (double) ops, 2, 9},
+          ", p90 ", Fixed {p90 / (double) ops, 2, 9}, "]");
+    if (bytes > 0) {
+        print(stdout, "  ", Fixed {(double) bytes / median, 3, 8}, " GB/s");
+    }
+    println(stdout);
+}
+
+uint32_t random_state = 69;
+
+uint32_t random_u32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+// NOTE: the generated inputs live until the process exits
+char *generate(size_t count)
+{
+    return mtor.alloc<char>(count);
+}
+
+////////////////////////////////////////////////////////////
+// HASH_MAP
+////////////////////////////////////////////////////////////
+
+const size_t HASH_MAP_KEYS = 100000;
+
+String_View *generate_sequential_keys(const char *prefix)
+{
+    String_View *keys = mtor.alloc<String_View>(HASH_MAP_KEYS);
+    char *buffer = generate(HASH_MAP_KEYS * 32);
+    for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+        int n = snprintf(buffer, 32, "%s%zu", prefix, i);
+        keys[i] = {(size_t) n, buffer};
+        buffer += n;
+    }
+    return keys;
+}
+
+String_View *generate_random_keys(size_t length)
+{
+    String_View *keys = mtor.alloc<String_View>(HASH_MAP_KEYS);
+    char *buffer = generate(HASH_MAP_KEYS * length);
+    for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+        for (size_t j = 0; j < length; ++j) {
+            buffer[j] = (char) ('a' + random_u32() % 26);
+        }
+        keys[i] = {length, buffer};
+        buffer += length;
+    }
+    return keys;
+}
+
+void bench_hash_map(const char *insert_name, const char *hit_name, const char *miss_name,
+                    String_View *keys, String_View *missing_keys)
+{
+    bench(insert_name, HASH_MAP_KEYS, 0, [keys]() {
+        Hash_Map<String_View, size_t> map = {};
+        for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+            map.insert(keys[i], i);
+        }
+        size_t size = map.size;
+        destroy(map);
+        return size;
+    });
+
+    Hash_Map<String_View, size_t> map = {};
+    defer(destroy(map));
+    for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+        map.insert(keys[i], i);
+    }
+
+    bench(hit_name, HASH_MAP_KEYS, 0, [&map, keys]() {
+        size_t sum = 0;
+        for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+            sum += *map.get(keys[i]).unwrap;
+        }
+        return sum;
+    });
+
+    bench(miss_name, HASH_MAP_KEYS, 0, [&map, missing_keys]() {
+        size_t misses = 0;
+        for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+            misses += !map.contains(missing_keys[i]);
+        }
+        return misses;
+    });
+}
+
+// NOTE: a map way bigger than the caches, where every probe is a cache
+// miss. get() hashes a key and waits for its bucket before it gets to
+// the next key, get_many() overlaps the misses of a whole batch.
+void bench_hash_map_large()
+{
+    const size_t LARGE_KEYS = 8 * 1024 * 1024;
+    const size_t LENGTH = 24;
+    const size_t BATCH = 1024;
+
+    // NOTE: building the map takes longer than the benchmarks themselves
+    if (!bench_selected("hash_map/large/get") && !bench_selected("hash_map/large/get_many")) {
+        return;
+    }
+
+    String_View *keys = mtor.alloc<String_View>(LARGE_KEYS);
+    char *buffer = generate(LARGE_KEYS * LENGTH);
+    Hash_Map<String_View, size_t> map = {};
+    defer(destroy(map));
+    for (size_t i = 0; i < LARGE_KEYS; ++i) {
+        for (size_t j = 0; j < LENGTH; ++j) {
+            buffer[j] = (char) ('a' + random_u32() % 26);
+        }
+        keys[i] = {LENGTH, buffer};
+        buffer += LENGTH;
+        map.insert(keys[i], i);
+    }
+
+    String_View *queries = mtor.alloc<String_View>(HASH_MAP_KEYS);
+    for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+        queries[i] = keys[random_u32() % LARGE_KEYS];
+    }
+
+    bench("hash_map/large/get", HASH_MAP_KEYS, 0, [&map, queries]() {
+        size_t sum = 0;
+        for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+            sum += *map.get(queries[i]).unwrap;
+        }
+        return sum;
+    });
+
+    bench("hash_map/large/get_many", HASH_MAP_KEYS, 0, [&map, queries]() {
+        Maybe<size_t*> values[BATCH];
+        size_t sum = 0;
+        for (size_t begin = 0; begin < HASH_MAP_KEYS; begin += BATCH) {
+            const size_t n = min(BATCH, HASH_MAP_KEYS - begin);
+            map.get_many(queries + begin, n, values);
+            for (size_t i = 0; i < n; ++i) {
+                sum += *values[i].unwrap;
+            }
+        }
+        return sum;
+    });
+
+    mtor.dealloc(queries, HASH_MAP_KEYS);
+    mtor.dealloc(keys, LARGE_KEYS);
+}
+
+void bench_hash_maps()
+{
+    bench_hash_map("hash_map/sequential/insert",
+                   "hash_map/sequential/get_hit",
+                   "hash_map/sequential/get_miss",
+                   generate_sequential_keys("key-"),
+                   generate_sequential_keys("missing-"));
+
+    String_View *random_8 = generate_random_keys(8);
+    bench_hash_map("hash_map/random_8/insert",
+                   "hash_map/random_8/get_hit",
+                   "hash_map/random_8/get_miss",
+                   random_8,
+                   generate_random_keys(9));
+
+    // NOTE: the same keys as hash_map/random_8/insert without the values
+    bench("hash_set/random_8/insert", HASH_MAP_KEYS, 0, [random_8]() {
+        Hash_Set<String_View> set = {};
+        for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+            set.insert(random_8[i]);
+        }
+        size_t size = set.size;
+        destroy(set);
+        return size;
+    });
+
+    bench_hash_map("hash_map/random_64/insert",
+                   "hash_map/random_64/get_hit",
+                   "hash_map/random_64/get_miss",
+                   generate_random_keys(64),
+                   generate_random_keys(65));
+
+    uint32_t *keys = mtor.alloc<uint32_t>(HASH_MAP_KEYS);
+    for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+        keys[i] = random_u32();
+    }
+
+    bench("hash_map/uint32/insert", HASH_MAP_KEYS, 0, [keys]() {
+        Hash_Map<uint32_t, uint32_t> map = {};
+        for (size_t i = 0; i < HASH_MAP_KEYS; ++i) {
+            map.insert(keys[i], (uint32_t) i);
+        }
+        size_t size = map.size;
+        destroy(map);
+        return size;
+    });
+
+    bench_hash_map_large();
+}
+
+////////////////////////////////////////////////////////////
+// DYNAMIC_ARRAY
+////////////////////////////////////////////////////////////
+
+void bench_dynamic_arrays()
+{
+    const size_t N = 1000000;
+
+    bench("dynamic_array/push", N, N * sizeof(int), []() {
+        Dynamic_Array<int> array = {};
+        for (size_t i = 0; i < N; ++i) {
+            array.push((int) i);
+        }
+        size_t size = array.size;
+        destroy(array);
+        return size;
+    });
+
+    // NOTE: many tiny arrays, the common case of per-record lists
+    const size_t ARRAYS = 100000;
+    const size_t ITEMS = 6;
+
+    bench("dynamic_array/tiny", ARRAYS, 0, []() {
+        size_t sum = 0;
+        for (size_t i = 0; i < ARRAYS; ++i) {
+            Dynamic_Array<int> array = {};
+            for (size_t j = 0; j < ITEMS; ++j) {
+                array.push((int) j);
+            }
+            sum += array.size;
+            destroy(array);
+        }
+        return sum;
+    });
+
+    bench("small_array/tiny", ARRAYS, 0, []() {
+        size_t sum = 0;
+        for (size_t i = 0; i < ARRAYS; ++i) {
+            Small_Array<int, 8> array = {};
+            for (size_t j = 0; j < ITEMS; ++j) {
+                array.push((int) j);
+            }
+            sum += array.size;
+            destroy(array);
+        }
+        return sum;
+    });
+}
+
+////////////////////////////////////////////////////////////
+// SORTING
+////////////////////////////////////////////////////////////
+
+// NOTE: every run sorts a fresh copy of the input, so the copying is
+// included into the measurements
+template <typename T, typename F>
+void bench_sort(const char *name, const T *input, T *scratch, size_t count, F f)
+{
+    bench(name, count, count * sizeof(T), [=]() {
+        memcpy(scratch, input, count * sizeof(T));
+        f(scratch, count);
+        return (uint64_t) scratch[count / 2];
+    });
+}
+
+void bench_sorting()
+{
+    const size_t N = 1000000;
+
+    uint32_t *integers = mtor.alloc<uint32_t>(N);
+    uint32_t *integers_scratch = mtor.alloc<uint32_t>(N);
+    for (size_t i = 0; i < N; ++i) {
+        integers[i] = random_u32();
+    }
+
+    bench_sort("sort/uint32/sort", integers, integers_scratch, N, [](uint32_t *data, size_t count) {
+        sort(data, count);
+    });
+    bench_sort("sort/uint32/stable_sort", integers, integers_scratch, N, [](uint32_t *data, size_t count) {
+        stable_sort(data, count);
+    });
+    bench_sort("sort/uint32/radix_sort", integers, integers_scratch, N, [](uint32_t *data, size_t count) {
+        radix_sort(data, count);
+    });
+
+    Thread_Pool pool = thread_pool_of(hardware_threads_count());
+    defer(destroy(pool));
+    bench_sort("sort/uint32/parallel_sort", integers, integers_scratch, N, [pool](uint32_t *data, size_t count) {
+        parallel_sort(pool, data, count);
+    });
+
+    String_View *keys = generate_random_keys(8);
+    String_View *keys_scratch = mtor.alloc<String_View>(HASH_MAP_KEYS);
+
+    bench("sort/string_view/sort", HASH_MAP_KEYS, 0, [=]() {
+        memcpy(keys_scratch, keys, HASH_MAP_KEYS * sizeof(String_View));
+        sort(keys_scratch, HASH_MAP_KEYS);
+        return (uint64_t) keys_scratch[0].count;
+    });
+    bench("sort/string_view/radix_sort", HASH_MAP_KEYS, 0, [=]() {
+        memcpy(keys_scratch, keys, HASH_MAP_KEYS * sizeof(String_View));
+        radix_sort(keys_scratch, HASH_MAP_KEYS);
+        return (uint64_t) keys_scratch[0].count;
+    });
+}
+
+////////////////////////////////////////////////////////////
+// QUEUES
+////////////////////////////////////////////////////////////
+
+SPSC_Queue<uint64_t, 1024> spsc_queue = {};
+MPMC_Queue<uint64_t, 1024> mpmc_queue = {};
+
+// NOTE: single-threaded round trips, i.e. the cost of the queue
+// operations themselves without any contention
+template <typename Queue>
+void bench_queue(const char *single_name, const char *batch_name, Queue *queue)
+{
+    const size_t N = 1000000;
+    const size_t BATCH_SIZE = 64;
+
+    bench(single_name, N, 0, [queue]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < N; ++i) {
+            queue->push(i);
+            sum += queue->pop().unwrap;
+        }
+        return sum;
+    });
+
+    bench(batch_name, N, 0, [queue]() {
+        uint64_t batch[BATCH_SIZE];
+        uint64_t sum = 0;
+        for (size_t i = 0; i < N; i += BATCH_SIZE) {
+            for (size_t j = 0; j < BATCH_SIZE; ++j) {
+                batch[j] = i + j;
+            }
+            queue->push_many(batch, BATCH_SIZE);
+            queue->pop_many(batch, BATCH_SIZE);
+            sum += batch[0];
+        }
+        return sum;
+    });
+}
+
+void bench_queues()
+{
+    bench_queue("queue/spsc/push_pop", "queue/spsc/push_pop_many", &spsc_queue);
+    bench_queue("queue/mpmc/push_pop", "queue/mpmc/push_pop_many", &mpmc_queue);
+}
+
+////////////////////////////////////////////////////////////
+// STRING_VIEW
+////////////////////////////////////////////////////////////
+
+const size_t TEXT_SIZE = 4 * 1024 * 1024;
+
+String_View generate_words_text()
+{
+    const char *words[] = {
+        "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+        "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore",
+    };
+    const size_t words_count = sizeof(words) / sizeof(words[0]);
+
+    char *text = generate(TEXT_SIZE);
+    size_t size = 0;
+    while (true) {
+        const char *word = words[random_u32() % words_count];
+        size_t n = strlen(word);
+        if (size + n + 1 > TEXT_SIZE) break;
+        memcpy(text + size, word, n);
+        size += n;
+        text[size++] = random_u32() % 10 == 0 ? '\n' : ' ';
+    }
+    return {size, text};
+}
+
+void bench_string_views()
+{
+    String_View text = generate_words_text();
+    size_t words = 0;
+    {
+        String_View iter = text;
+        while (iter.trim().count > 0) {
+            iter.chop_word();
+            words += 1;
+        }
+    }
+
+    bench("string_view/chop_word", words, text.count, [text]() {
+        String_View iter = text;
+        size_t sum = 0;
+        while (iter.count > 0) {
+            sum += iter.chop_word().count;
+        }
+        return sum;
+    });
+
+    bench("string_view/chop_by_delim", text.count_chars('\n') + 1, text.count, [text]() {
+        String_View iter = text;
+        size_t sum = 0;
+        while (iter.count > 0) {
+            sum += iter.chop_by_delim('\n').count;
+        }
+        return sum;
+    });
+
+    const size_t N = 100000;
+    String_View *integers = mtor.alloc<String_View>(N);
+    String_View *floats = mtor.alloc<String_View>(N);
+    char *buffer = generate(N * 64);
+    for (size_t i = 0; i < N; ++i) {
+        int n = snprintf(buffer, 32, "%d", (int) (random_u32() % 2000000) - 1000000);
+        integers[i] = {(size_t) n, buffer};
+        buffer += n;
+
+        n = snprintf(buffer, 32, "%f", (double) random_u32() / 1000.0);
+        floats[i] = {(size_t) n, buffer};
+        buffer += n;
+    }
+
+    bench("string_view/as_integer", N, 0, [integers]() {
+        int sum = 0;
+        for (size_t i = 0; i < N; ++i) {
+            sum += integers[i].as_integer<int>().unwrap;
+        }
+        return (uint64_t) sum;
+    });
+
+    bench("string_view/as_float", N, 0, [floats]() {
+        float sum = 0.0f;
+        for (size_t i = 0; i < N; ++i) {
+            sum += floats[i].as_float().unwrap;
+        }
+        return (uint64_t) sum;
+    });
+}
+
+////////////////////////////////////////////////////////////
+// UTF-8
+////////////////////////////////////////////////////////////
+
+String_View generate_utf8_text(bool ascii_only)
+{
+    const char *fragments[] = {
+        "Hello, World! ", "The quick brown fox ", "Привет, Мир! ", "こんにちは世界! ", "😂👌💯🔥 ",
+    };
+    const size_t fragments_count = ascii_only ? 2 : sizeof(fragments) / sizeof(fragments[0]);
+
+    char *text = generate(TEXT_SIZE);
+    size_t size = 0;
+    while (true) {
+        const char *fragment = fragments[random_u32() % fragments_count];
+        size_t n = strlen(fragment);
+        if (size + n > TEXT_SIZE) break;
+        memcpy(text + size, fragment, n);
+        size += n;
+    }
+    return {size, text};
+}
+
+void bench_utf8()
+{
+    String_View mixed = generate_utf8_text(false);
+    String_View ascii = generate_utf8_text(true);
+    size_t codes = utf8_length(mixed);
+
+    bench("utf8/get_code/mixed", codes, mixed.count, [mixed]() {
+        String_View iter = mixed;
+        uint64_t sum = 0;
+        while (iter.count > 0) {
+            size_t size = 0;
+            sum += utf8_get_code(iter, &size).unwrap;
+            iter.chop_left(size);
+        }
+        return sum;
+    });
+
+    bench("utf8/validate/mixed", codes, mixed.count, [mixed]() {
+        return (uint64_t) utf8_validate(mixed);
+    });
+
+    bench("utf8/validate/ascii", ascii.count, ascii.count, [ascii]() {
+        return (uint64_t) utf8_validate(ascii);
+    });
+
+    uint32_t *utf32 = mtor.alloc<uint32_t>(codes);
+    bench("utf8/to_utf32/mixed", codes, mixed.count, [mixed, utf32]() {
+        return (uint64_t) utf8_to_utf32(mixed, utf32).unwrap;
+    });
+}
+
+////////////////////////////////////////////////////////////
+// HEX AND BASE64
+////////////////////////////////////////////////////////////
+
+void bench_encodings()
+{
+    const size_t SIZE = 64 * 1024;
+    char *bytes = mtor.alloc<char>(SIZE);
+    uint32_t seed = 420;
+    for (size_t i = 0; i < SIZE; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        bytes[i] = (char) (seed >> 24);
+    }
+    String_View input = {SIZE, bytes};
+
+    char *hex = mtor.alloc<char>(bytes_length_as_hex(input));
+    String_View hex_view = {bytes_to_hex(input, hex), hex};
+    char *base64 = mtor.alloc<char>(bytes_length_as_base64(input));
+    String_View base64_view = {bytes_to_base64(input, base64), base64};
+    char *decoded = mtor.alloc<char>(SIZE);
+
+    bench("hex/encode", SIZE, SIZE, [input, hex]() {
+        return (uint64_t) bytes_to_hex(input, hex);
+    });
+
+    bench("hex/decode", SIZE, SIZE, [hex_view, decoded]() {
+        return (uint64_t) hex_to_bytes(hex_view, decoded).unwrap;
+    });
+
+    bench("base64/encode", SIZE, SIZE, [input, base64]() {
+        return (uint64_t) bytes_to_base64(input, base64);
+    });
+
+    bench("base64/decode", SIZE, SIZE, [base64_view, decoded]() {
+        return (uint64_t) base64_to_bytes(base64_view, decoded).unwrap;
+    });
+
+#ifdef _WIN32
+    FILE *null = fopen("NUL", "wb");
+#else
+    FILE *null = fopen("/dev/null", "wb");
+#endif
+    if (null == nullptr) {
+        panic("Could not open the null device: ", strerror(errno));
+    }
+
+    bench("print1/hex_bytes", SIZE, SIZE, [null, input]() {
+        print1(null, Hex_Bytes {input});
+        return (uint64_t) 0;
+    });
+
+    fclose(null);
+    mtor.dealloc(decoded, SIZE);
+    mtor.dealloc(base64, base64_view.count);
+    mtor.dealloc(hex, hex_view.count);
+    mtor.dealloc(bytes, SIZE);
+}
+
+////////////////////////////////////////////////////////////
+// PRINT
+////////////////////////////////////////////////////////////
+
+void bench_prints()
+{
+    const size_t N = 100000;
+
+    bench("sprint1/int", N, 0, []() {
+        char buffer[64];
+        uint64_t sum = 0;
+        for (size_t i = 0; i < N; ++i) {
+            String_Buffer sbuffer = {sizeof(buffer), buffer, 0};
+            sprint1(&sbuffer, (int) i);
+            sum += sbuffer.size;
+        }
+        return sum;
+    });
+
+    bench("sprint1/string_view", N, 0, []() {
+        char buffer[64];
+        uint64_t sum = 0;
+        for (size_t i = 0; i < N; ++i) {
+            String_Buffer sbuffer = {sizeof(buffer), buffer, 0};
+            sprint1(&sbuffer, "Hello, World"_sv);
+            sum += sbuffer.size;
+        }
+        return sum;
+    });
+
+#ifdef _WIN32
+    FILE *null = fopen("NUL", "wb");
+#else
+    FILE *null = fopen("/dev/null", "wb");
+#endif
+    if (null == nullptr) {
+        panic("Could not open the null device: ", strerror(errno));
+    }
+
+    bench("print1/int", N, 0, [null]() {
+        for (size_t i = 0; i < N; ++i) {
+            print1(null, (int) i);
+        }
+        return (uint64_t) 0;
+    });
+
+    bench("print1/string_view", N, 0, [null]() {
+        for (size_t i = 0; i < N; ++i) {
+            print1(null, "Hello, World"_sv);
+        }
+        return (uint64_t) 0;
+    });
+
+    bench("println/mixed", N, 0, [null]() {
+        for (size_t i = 0; i < N; ++i) {
+            println(null, "Hello, ", (int) i, ' ', "World"_sv);
+        }
+        return (uint64_t) 0;
+    });
+
+    // NOTE: a log line with a newline at the end and a quoted word in it
+    const size_t LINES = 1000;
+    String_View line = "2026-10-18 12:00:00 INFO request \"GET /index.html\" served in 42ms by worker-7 without any issues\n"_sv;
+    Dynamic_Array<char> text = {};
+    for (size_t i = 0; i < LINES; ++i) {
+        text.concat(line.data, line.count);
+    }
+    String_View text_view = {text.size, text.data};
+
+    bench("print1/escape", text.size, text.size, [null, text_view]() {
+        print1(null, Escape {text_view});
+        return (uint64_t) 0;
+    });
+
+    bench("print1/json_escape", text.size, text.size, [null, text_view]() {
+        print1(null, Json_Escape {text_view});
+        return (uint64_t) 0;
+    });
+
+    destroy(text);
+    fclose(null);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        bench_filter = argv[1];
+    }
+
+    bench_hash_maps();
+    bench_dynamic_arrays();
+    bench_sorting();
+    bench_queues();
+    bench_string_views();
+    bench_utf8();
+    bench_encodings();
+    bench_prints();
+
+    return 0;
+}
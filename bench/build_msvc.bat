@@ -0,0 +1,9 @@
+@echo off
+rem launch this from msvc-enabled console
+
+set CXXFLAGS=/std:c++17 /O2 /DNDEBUG /FC /Zi /W4 /WX /J /wd4458 /wd4996 /nologo
+set INCLUDES=/I ..\
+
+cl.exe %CXXFLAGS% %INCLUDES% bench.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% word_freq.cpp
@@ -0,0 +1,364 @@
+#define AIDS_THREADS
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace aids;
+
+// NOTE: counts the word frequencies of a big text the way our batch
+// jobs do: the text is split into chunks on line boundaries, every
+// thread of a Thread_Pool counts the words of its chunks into its own
+// Hash_Map, and the maps are merged at the end. It runs the count for
+// 1, 2, 4, ... threads and reports the throughput and the scaling.
+//
+//     ./word_freq [<input.txt>] [--threads <n>] [--size <megabytes>]
+//
+// Without an input file it generates a text of --size megabytes with
+// a Zipf-like distribution of the words.
+
+struct Mapped_File {
+    String_View content;
+    bool mapped;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+// NOTE: falls back to reading the whole file when it can't be mapped
+// (empty files, pipes, etc)
+Maybe<Mapped_File> map_file(const char *file_path)
+{
+    Mapped_File result = {};
+
+#ifdef _WIN32
+    result.file = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (result.file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(result.file, &size) && size.QuadPart > 0) {
+            result.mapping = CreateFileMappingA(result.file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (result.mapping != NULL) {
+                void *data = MapViewOfFile(result.mapping, FILE_MAP_READ, 0, 0, 0);
+                if (data != NULL) {
+                    result.content = {(size_t) size.QuadPart, static_cast<const char*>(data)};
+                    result.mapped = true;
+                    return some(result);
+                }
+                CloseHandle(result.mapping);
+            }
+        }
+        CloseHandle(result.file);
+    }
+#else
+    int fd = open(file_path, O_RDONLY);
+    if (fd >= 0) {
+        struct stat statbuf;
+        if (fstat(fd, &statbuf) == 0 && S_ISREG(statbuf.st_mode) && statbuf.st_size > 0) {
+            void *data = mmap(NULL, (size_t) statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                madvise(data, (size_t) statbuf.st_size, MADV_SEQUENTIAL);
+                close(fd);
+                result.content = {(size_t) statbuf.st_size, static_cast<const char*>(data)};
+                result.mapped = true;
+                return some(result);
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    auto content = read_file_as_string_view(file_path);
+    if (!content.has_value) {
+        return {};
+    }
+    result.content = content.unwrap;
+    return some(result);
+}
+
+void destroy(Mapped_File file)
+{
+    if (!file.mapped) {
+        destroy(file.content);
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(file.content.data);
+    CloseHandle(file.mapping);
+    CloseHandle(file.file);
+#else
+    munmap(const_cast<char*>(file.content.data), file.content.count);
+#endif
+}
+
+uint32_t random_state = 69;
+
+uint32_t random_u32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+String_View generate_text(size_t size)
+{
+    const size_t VOCABULARY_SIZE = 50000;
+    const size_t MAX_WORD_SIZE = 10;
+
+    char *vocabulary = mtor.alloc<char>(VOCABULARY_SIZE * MAX_WORD_SIZE);
+    defer(mtor.dealloc(vocabulary, VOCABULARY_SIZE * MAX_WORD_SIZE));
+    String_View *words = mtor.alloc<String_View>(VOCABULARY_SIZE);
+    defer(mtor.dealloc(words, VOCABULARY_SIZE));
+
+    for (size_t i = 0; i < VOCABULARY_SIZE; ++i) {
+        char *word = vocabulary + i * MAX_WORD_SIZE;
+        size_t count = 2 + random_u32() % (MAX_WORD_SIZE - 1);
+        for (size_t j = 0; j < count; ++j) {
+            word[j] = (char) ('a' + random_u32() % 26);
+        }
+        words[i] = {count, word};
+    }
+
+    char *text = mtor.alloc<char>(size);
+    size_t text_size = 0;
+    size_t words_in_line = 0;
+    while (true) {
+        // NOTE: log-uniform index is a cheap approximation of Zipf's law
+        const double u = (double) random_u32() / 4294967296.0;
+        size_t index = 0;
+        for (double x = u * 16.0; x >= 1.0 && index < VOCABULARY_SIZE / 2; x -= 1.0) {
+            index = index * 2 + 1;
+        }
+        index = min(index + random_u32() % (index + 1), VOCABULARY_SIZE - 1);
+
+        const String_View word = words[index];
+        if (text_size + word.count + 1 > size) {
+            break;
+        }
+
+        memcpy(text + text_size, word.data, word.count);
+        text_size += word.count;
+
+        words_in_line += 1;
+        if (words_in_line >= 12) {
+            text[text_size++] = '\n';
+            words_in_line = 0;
+        } else {
+            text[text_size++] = ' ';
+        }
+    }
+
+    return {text_size, text};
+}
+
+// NOTE: chunks end right after a newline, so no word is cut in half
+Dynamic_Array<String_View> split_into_chunks(String_View text, size_t chunks_count)
+{
+    Dynamic_Array<String_View> chunks = {};
+    while (text.count > 0) {
+        size_t size = min(text.count, max((size_t) 1, text.count / chunks_count));
+        while (size < text.count && text.data[size - 1] != '\n') {
+            size += 1;
+        }
+        chunks.push(text.chop_left(size));
+        chunks_count = max((size_t) 1, chunks_count - 1);
+    }
+    return chunks;
+}
+
+struct Count_Context {
+    const Dynamic_Array<String_View> *chunks;
+    Hash_Map<String_View, int> *maps;
+};
+
+void count_chunks(void *raw, size_t thread, size_t begin, size_t end)
+{
+    Count_Context *context = static_cast<Count_Context*>(raw);
+    Hash_Map<String_View, int> *map = &context->maps[thread];
+
+    for (size_t i = begin; i < end; ++i) {
+        String_View chunk = (*context->chunks)[i];
+        while (true) {
+            String_View word = chunk.chop_word();
+            if (word.count == 0) {
+                break;
+            }
+            *(*map)[word] += 1;
+        }
+    }
+}
+
+void merge(Hash_Map<String_View, int> *into, Hash_Map<String_View, int> from)
+{
+    from.for_each([into](String_View word, int count) {
+        *(*into)[word] += count;
+    });
+}
+
+struct Run_Result {
+    uint64_t count_ns;
+    uint64_t merge_ns;
+    uint64_t words;
+    size_t unique_words;
+};
+
+Run_Result run(String_View text, size_t threads_count, Hash_Map<String_View, int> *result)
+{
+    Thread_Pool pool = thread_pool_of(threads_count);
+    defer(destroy(pool));
+
+    // NOTE: several chunks per thread so the work stealing can even
+    // out the differences between them
+    Dynamic_Array<String_View> chunks = split_into_chunks(text, threads_count * 8);
+    defer(destroy(chunks));
+
+    Hash_Map<String_View, int> *maps = mtor.alloc<Hash_Map<String_View, int>>(threads_count);
+    defer(mtor.dealloc(maps, threads_count));
+
+    Run_Result run_result = {};
+
+    const uint64_t count_begin = profile_now();
+    Count_Context context = {&chunks, maps};
+    pool.run(0, chunks.size, 1, count_chunks, &context);
+    const uint64_t merge_begin = profile_now();
+    for (size_t i = 1; i < threads_count; ++i) {
+        merge(&maps[0], maps[i]);
+        destroy(maps[i]);
+    }
+    const uint64_t merge_end = profile_now();
+
+    run_result.count_ns = merge_begin - count_begin;
+    run_result.merge_ns = merge_end - merge_begin;
+    run_result.unique_words = maps[0].size;
+    maps[0].for_each([&run_result](String_View, int count) {
+        run_result.words += (uint64_t) count;
+    });
+
+    if (result) {
+        *result = maps[0];
+    } else {
+        destroy(maps[0]);
+    }
+
+    return run_result;
+}
+
+void usage(FILE *stream)
+{
+    println(stream, "Usage: ./word_freq [<input.txt>] [--threads <n>] [--size <megabytes>]");
+}
+
+int main(int argc, char *argv[])
+{
+    Args args = {argc, argv};
+    args.shift();
+
+    const char *input_file_path = nullptr;
+    size_t max_threads = hardware_threads_count();
+    size_t generated_size = 64;
+
+    while (!args.empty()) {
+        const char *flag = args.shift();
+        if (strcmp(flag, "--threads") == 0 || strcmp(flag, "--size") == 0) {
+            if (args.empty()) {
+                usage(stderr);
+                panic("ERROR: no value for ", flag);
+            }
+            auto value = cstr_as_string_view(args.shift()).as_integer<int>();
+            if (!value.has_value || value.unwrap <= 0) {
+                usage(stderr);
+                panic("ERROR: ", flag, " expects a positive integer");
+            }
+            if (strcmp(flag, "--threads") == 0) {
+                max_threads = (size_t) value.unwrap;
+            } else {
+                generated_size = (size_t) value.unwrap;
+            }
+        } else {
+            input_file_path = flag;
+        }
+    }
+
+    Mapped_File file = {};
+    String_View text = {};
+    if (input_file_path) {
+        file = unwrap_or_panic(map_file(input_file_path),
+                               "ERROR: could not read file `", input_file_path, "`: ",
+                               strerror(errno));
+        text = file.content;
+    } else {
+        text = generate_text(generated_size * 1024 * 1024);
+    }
+
+    println(stdout, "Input: ", input_file_path ? input_file_path : "<generated>", ", ",
+            Fixed {(double) text.count / (1024.0 * 1024.0), 1}, " MiB");
+    println(stdout, "threads     count (ms)   merge (ms)       GB/s    speedup");
+
+    const int REPETITIONS = 3;
+    double single_thread_ns = 0.0;
+    for (size_t threads = 1; ; threads = min(threads * 2, max_threads)) {
+        Run_Result best = {};
+        for (int i = 0; i < REPETITIONS; ++i) {
+            Run_Result result = run(text, threads, nullptr);
+            if (i == 0 || result.count_ns + result.merge_ns < best.count_ns + best.merge_ns) {
+                best = result;
+            }
+        }
+
+        const double total_ns = (double) (best.count_ns + best.merge_ns);
+        if (threads == 1) {
+            single_thread_ns = total_ns;
+        }
+
+        println(stdout,
+                Fixed {(double) threads, 0, 7},
+                Fixed {(double) best.count_ns / 1e6, 2, 15},
+                Fixed {(double) best.merge_ns / 1e6, 2, 13},
+                Fixed {(double) text.count / total_ns, 3, 11},
+                Fixed {single_thread_ns / total_ns, 2, 10}, "x");
+
+        if (threads >= max_threads) {
+            break;
+        }
+    }
+
+    Hash_Map<String_View, int> freq = {};
+    defer(destroy(freq));
+    Run_Result result = run(text, max_threads, &freq);
+
+    Dynamic_Array<Hash_Map<String_View, int>::Bucket> top = {};
+    defer(destroy(top));
+    freq.for_each([&top](String_View word, int count) {
+        top.push({word, count});
+    });
+    sort(&top, [](const auto &a, const auto &b) {
+        return a.value > b.value || (a.value == b.value && a.key < b.key);
+    });
+
+    println(stdout);
+    println(stdout, "Words: ", (unsigned long long) result.words,
+            ", unique words: ", result.unique_words);
+    for (size_t i = 0; i < min(top.size, (size_t) 10); ++i) {
+        println(stdout, "  ", top[i].key, ": ", top[i].value);
+    }
+
+    if (input_file_path) {
+        destroy(file);
+    } else {
+        mtor.dealloc(text.data, text.count);
+    }
+
+    return 0;
+}
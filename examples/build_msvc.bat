@@ -8,6 +8,8 @@ cl.exe %CXXFLAGS% %INCLUDES% cat.cpp
 
 cl.exe %CXXFLAGS% %INCLUDES% gol.cpp
 
+cl.exe %CXXFLAGS% %INCLUDES% /arch:AVX2 /Fegol_avx2.exe /Fogol_avx2.obj gol.cpp
+
 cl.exe %CXXFLAGS% %INCLUDES% sprintln.cpp
 
 cl.exe %CXXFLAGS% %INCLUDES% utf8.cpp
@@ -15,3 +17,7 @@ cl.exe %CXXFLAGS% %INCLUDES% utf8.cpp
 cl.exe %CXXFLAGS% %INCLUDES% hashmap.cpp
 
 cl.exe %CXXFLAGS% %INCLUDES% custom_struct_as_hashmap_key.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% profile.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% hashlife.cpp
@@ -1,3 +1,4 @@
+#define AIDS_THREADS
 #define AIDS_IMPLEMENTATION
 #include "aids.hpp"
 
@@ -7,83 +8,624 @@
 #include <unistd.h>
 #endif
 
-const int W = 5;
-const int H = 5;
+// NOTE: the board is bit-packed, 64 cells per word. Cell (x, y) lives
+// in bit x % 64 of word y * stride + x / 64. The bits past the width
+// in the last word of every row are always zero.
+struct Board
+{
+    size_t width;
+    size_t height;
+    size_t stride;
+    uint64_t *words;
+
+    uint64_t *row(size_t y) const
+    {
+        return words + y * stride;
+    }
+
+    bool get(size_t x, size_t y) const
+    {
+        return (row(y)[x / 64] >> (x % 64)) & 1;
+    }
+
+    void set(size_t x, size_t y, bool alive)
+    {
+        const uint64_t bit = 1ull << (x % 64);
+        if (alive) {
+            row(y)[x / 64] |= bit;
+        } else {
+            row(y)[x / 64] &= ~bit;
+        }
+    }
 
-enum class Cell
+    uint64_t last_mask() const
+    {
+        return width % 64 == 0 ? ~0ull : (1ull << (width % 64)) - 1;
+    }
+};
+
+Board board_of(size_t width, size_t height)
+{
+    Board board = {};
+    board.width = width;
+    board.height = height;
+    board.stride = (width + 63) / 64;
+    board.words = aids::mtor.alloc<uint64_t>(board.stride * height);
+    return board;
+}
+
+void destroy(Board board)
+{
+    aids::mtor.dealloc(board.words, board.stride * board.height);
+}
+
+// NOTE: west(row, i) holds the west neighbour of every cell of word i
+// in the cell's own bit, east(row, i) the east one. Column 0 and
+// column width - 1 are neighbours of each other.
+uint64_t west(const Board *board, const uint64_t *row, size_t i)
 {
-    Dead = 0,
-    Alive = 1
+    const uint64_t carry = i > 0
+        ? row[i - 1] >> 63
+        : (row[board->stride - 1] >> ((board->width - 1) % 64)) & 1;
+    return (row[i] << 1) | carry;
+}
+
+uint64_t east(const Board *board, const uint64_t *row, size_t i)
+{
+    if (i + 1 < board->stride) {
+        return (row[i] >> 1) | (row[i + 1] << 63);
+    }
+    return (row[i] >> 1) | ((row[0] & 1) << ((board->width - 1) % 64));
+}
+
+#ifdef AIDS_AVX2
+struct Lanes
+{
+    __m256i v;
 };
 
-struct Board
+Lanes operator&(Lanes a, Lanes b) { return {_mm256_and_si256(a.v, b.v)}; }
+Lanes operator|(Lanes a, Lanes b) { return {_mm256_or_si256(a.v, b.v)}; }
+Lanes operator^(Lanes a, Lanes b) { return {_mm256_xor_si256(a.v, b.v)}; }
+Lanes operator~(Lanes a) { return {_mm256_xor_si256(a.v, _mm256_set1_epi8(-1))}; }
+
+Lanes load_lanes(const uint64_t *words)
+{
+    return {_mm256_loadu_si256((const __m256i *) words)};
+}
+#endif // AIDS_AVX2
+
+template <typename Bits>
+void full_add(Bits a, Bits b, Bits c, Bits *sum, Bits *carry)
 {
-    Cell cells[H][W];
+    const Bits ab = a ^ b;
+    *sum = ab ^ c;
+    *carry = (a & b) | (ab & c);
+}
+
+// NOTE: bit-sliced neighbour count. Every bit lane adds up its 8
+// neighbours modulo 8 into (s2 s1 s0) and applies B3/S23: the cell
+// lives with 3 neighbours, or with 2 if it is already alive. 8
+// neighbours wrap around to 0, which is dead either way.
+template <typename Bits>
+Bits life(Bits nw, Bits n, Bits ne,
+          Bits w,  Bits c, Bits e,
+          Bits sw, Bits s, Bits se)
+{
+    Bits t0, t1, b0, b1;
+    full_add(nw, n, ne, &t0, &t1);
+    full_add(sw, s, se, &b0, &b1);
+    const Bits m0 = w ^ e;
+    const Bits m1 = w & e;
+
+    Bits s0, c1, u, v;
+    full_add(t0, b0, m0, &s0, &c1);
+    full_add(t1, b1, m1, &u, &v);
+    const Bits s1 = u ^ c1;
+    const Bits s2 = v ^ (u & c1);
+
+    return s1 & ~s2 & (s0 | c);
+}
+
+uint64_t next_word(const Board *board,
+                   const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+                   size_t i)
+{
+    const uint64_t result =
+        life(west(board, up, i),   up[i],   east(board, up, i),
+             west(board, mid, i),  mid[i],  east(board, mid, i),
+             west(board, down, i), down[i], east(board, down, i));
+    return i + 1 == board->stride ? result & board->last_mask() : result;
+}
+
+#ifdef AIDS_AVX2
+// NOTE: words [i, i + 4) of the next generation of a row. They must
+// not wrap, so their neighbours are just the unaligned loads one word
+// to the left and to the right.
+void next_lanes(const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+                uint64_t *out, size_t i, Lanes *changed)
+{
+    Lanes rows[3][3];
+    const uint64_t *srcs[3] = {up, mid, down};
+    for (int r = 0; r < 3; ++r) {
+        const Lanes l = load_lanes(srcs[r] + i - 1);
+        const Lanes c = load_lanes(srcs[r] + i);
+        const Lanes e = load_lanes(srcs[r] + i + 1);
+        rows[r][0] = {_mm256_or_si256(_mm256_slli_epi64(c.v, 1), _mm256_srli_epi64(l.v, 63))};
+        rows[r][1] = c;
+        rows[r][2] = {_mm256_or_si256(_mm256_srli_epi64(c.v, 1), _mm256_slli_epi64(e.v, 63))};
+    }
+    const Lanes result = life(rows[0][0], rows[0][1], rows[0][2],
+                              rows[1][0], rows[1][1], rows[1][2],
+                              rows[2][0], rows[2][1], rows[2][2]);
+    _mm256_storeu_si256((__m256i *) (out + i), result.v);
+    *changed = *changed | (result ^ rows[1][1]);
+}
+#endif // AIDS_AVX2
 
-    Cell get_wrapped(int y, int x) const
+// NOTE: computes the words [begin, end) of row y of the next
+// generation. Returns whether any of them changed.
+bool next_row(const Board *prev, Board *next, size_t y, size_t begin, size_t end)
+{
+    const uint64_t *up = prev->row(y > 0 ? y - 1 : prev->height - 1);
+    const uint64_t *mid = prev->row(y);
+    const uint64_t *down = prev->row(y + 1 < prev->height ? y + 1 : 0);
+    uint64_t *out = next->row(y);
+    uint64_t changed = 0;
+
+    size_t i = begin;
+    if (i == 0) {
+        out[0] = next_word(prev, up, mid, down, 0);
+        changed |= out[0] ^ mid[0];
+        i = 1;
+    }
+
+#ifdef AIDS_AVX2
+    // Only the first and the last word of a row wrap around
+    const size_t vector_end = aids::min(end, prev->stride - 1);
+    Lanes changed_lanes = {_mm256_setzero_si256()};
+    for (; i + 4 <= vector_end; i += 4) {
+        next_lanes(up, mid, down, out, i, &changed_lanes);
+    }
+    // The tail is recomputed together with some of the words that
+    // are already done instead of going through the scalar path.
+    if (i < vector_end && vector_end >= begin + 4 && vector_end >= 5) {
+        next_lanes(up, mid, down, out, vector_end - 4, &changed_lanes);
+        i = vector_end;
+    }
+    changed |= !_mm256_testz_si256(changed_lanes.v, changed_lanes.v);
+#endif // AIDS_AVX2
+
+    for (; i < end; ++i) {
+        out[i] = next_word(prev, up, mid, down, i);
+        changed |= out[i] ^ mid[i];
+    }
+
+    return changed != 0;
+}
+
+void next_gen(const Board *prev, Board *next)
+{
+    assert(prev->width == next->width && prev->height == next->height);
+
+    for (size_t y = 0; y < prev->height; ++y) {
+        next_row(prev, next, y, 0, prev->stride);
+    }
+}
+
+// NOTE: the board is cut into tiles of TILE_WORDS x TILE_ROWS words,
+// small enough for a tile and its border rows to stay in L1. Only
+// the tiles next to a tile that changed in the previous generation
+// are computed, in parallel. Everything else is stable or empty and
+// is already the same in both boards.
+const size_t TILE_WORDS = 16;
+const size_t TILE_ROWS = 32;
+
+struct Tiled_Life
+{
+    Board boards[2];
+    int fb;
+    size_t tiles_x;
+    size_t tiles_y;
+    uint8_t *changed;
+    uint8_t *marked;
+    aids::Dynamic_Array<uint32_t> active;
+    aids::Dynamic_Array<uint32_t> next_active;
+
+    const Board &board() const
     {
-        return cells[aids::mod(y, H)][aids::mod(x, W)];
+        return boards[fb];
     }
 
-    int nbors(int y, int x) const
+    size_t tiles_count() const
     {
-        int result = 0;
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-                if (dx != 0 || dy != 0) {
-                    if (get_wrapped(y + dy, x + dx) == Cell::Alive) {
-                        result += 1;
-                    }
+        return tiles_x * tiles_y;
+    }
+
+    void wake(size_t tx, size_t ty)
+    {
+        const uint32_t tile = (uint32_t) (ty * tiles_x + tx);
+        if (!marked[tile]) {
+            marked[tile] = 1;
+            next_active.push(tile);
+        }
+    }
+
+    void next_gen(aids::Thread_Pool pool)
+    {
+        const Board *prev = &boards[fb];
+        Board *next = &boards[1 - fb];
+
+        aids::parallel_for(pool, 0, active.size, 1, [&](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) {
+                const size_t tile = active.data[j];
+                const size_t word_begin = tile % tiles_x * TILE_WORDS;
+                const size_t word_end = aids::min(word_begin + TILE_WORDS, prev->stride);
+                const size_t row_begin = tile / tiles_x * TILE_ROWS;
+                const size_t row_end = aids::min(row_begin + TILE_ROWS, prev->height);
+
+                bool tile_changed = false;
+                for (size_t y = row_begin; y < row_end; ++y) {
+                    tile_changed |= next_row(prev, next, y, word_begin, word_end);
+                }
+                changed[tile] = tile_changed;
+            }
+        });
+
+        next_active.size = 0;
+        for (size_t j = 0; j < active.size; ++j) {
+            const size_t tile = active.data[j];
+            if (!changed[tile]) continue;
+
+            const size_t tx = tile % tiles_x;
+            const size_t ty = tile / tiles_x;
+            for (size_t dy = 0; dy < 3; ++dy) {
+                for (size_t dx = 0; dx < 3; ++dx) {
+                    wake((tx + tiles_x + dx - 1) % tiles_x, (ty + tiles_y + dy - 1) % tiles_y);
                 }
             }
         }
-        return result;
+        for (size_t j = 0; j < next_active.size; ++j) {
+            marked[next_active.data[j]] = 0;
+        }
+
+        aids::swap(&active, &next_active);
+        fb = 1 - fb;
+    }
+};
+
+// NOTE: the first generation computes every tile of the board
+Tiled_Life tiled_life_of(const Board *board)
+{
+    Tiled_Life life = {};
+    life.boards[0] = board_of(board->width, board->height);
+    life.boards[1] = board_of(board->width, board->height);
+    memcpy(life.boards[0].words, board->words, board->stride * board->height * sizeof(uint64_t));
+    memcpy(life.boards[1].words, board->words, board->stride * board->height * sizeof(uint64_t));
+    life.tiles_x = (board->stride + TILE_WORDS - 1) / TILE_WORDS;
+    life.tiles_y = (board->height + TILE_ROWS - 1) / TILE_ROWS;
+    life.changed = aids::mtor.alloc<uint8_t>(life.tiles_count());
+    life.marked = aids::mtor.alloc<uint8_t>(life.tiles_count());
+    for (size_t tile = 0; tile < life.tiles_count(); ++tile) {
+        life.active.push((uint32_t) tile);
     }
-    
-    void render(FILE *stream)
+    return life;
+}
+
+void destroy(Tiled_Life life)
+{
+    destroy(life.boards[0]);
+    destroy(life.boards[1]);
+    aids::mtor.dealloc(life.changed, life.tiles_count());
+    aids::mtor.dealloc(life.marked, life.tiles_count());
+    destroy(life.active);
+    destroy(life.next_active);
+}
+
+// NOTE: Frame_Renderer composes every frame into a buffer, compares
+// it to the previous one and only redraws the runs of cells that
+// changed, using relative cursor movements. The whole update goes out
+// with a single fwrite(). The cursor is expected to stay right below
+// the board between the frames.
+struct Frame_Renderer
+{
+    // NOTE: jumping over a few unchanged cells costs more than just
+    // printing them again
+    static const size_t MAX_GAP = 4;
+
+    // NOTE: after printing into the last column of the terminal the
+    // cursor stays on that column with a pending wrap, so a relative
+    // move from there lands one cell off. The board may be as wide as
+    // the terminal, so after its last column the column is unknown
+    // and the next move starts over from column 0.
+    static const size_t UNKNOWN_COL = SIZE_MAX;
+
+    size_t width;
+    size_t height;
+    char *prev;
+    char *next;
+    bool drawn;
+    size_t row;
+    size_t col;
+    aids::Dynamic_Array<char> out;
+
+    void emit(const char *data, size_t size)
+    {
+        out.concat(data, size);
+    }
+
+    void emit_move(size_t n, char direction)
     {
-        for (int y = 0; y < H; ++y) {
-            for (int x = 0; x < W; ++x) {
-                if (cells[y][x] == Cell::Alive) {
-                    aids::print(stream, '#');
-                } else {
-                    aids::print(stream, '.');
+        char escape[32];
+        int size = snprintf(escape, sizeof(escape), "\033[%zu%c", n, direction);
+        emit(escape, (size_t) size);
+    }
+
+    void move_to(size_t y, size_t x)
+    {
+        if (y < row) emit_move(row - y, 'A');
+        if (y > row) emit_move(y - row, 'B');
+        row = y;
+
+        if (col == UNKNOWN_COL) {
+            emit("\r", 1);
+            col = 0;
+        }
+
+        if (x == 0 && col > 0) emit("\r", 1);
+        else if (x < col) emit_move(col - x, 'D');
+        else if (x > col) emit_move(x - col, 'C');
+        col = x;
+    }
+
+    void render(const Board &board, FILE *stream)
+    {
+        assert(board.width == width && board.height == height);
+
+        for (size_t y = 0; y < height; ++y) {
+            char *line = next + y * width;
+            for (size_t x = 0; x < width; ++x) {
+                line[x] = board.get(x, y) ? '#' : '.';
+            }
+        }
+
+        out.size = 0;
+        if (!drawn) {
+            for (size_t y = 0; y < height; ++y) {
+                emit(next + y * width, width);
+                emit("\n", 1);
+            }
+            drawn = true;
+        } else {
+            for (size_t y = 0; y < height; ++y) {
+                const char *a = prev + y * width;
+                const char *b = next + y * width;
+                size_t x = 0;
+                while (x < width) {
+                    if (a[x] == b[x]) {
+                        x += 1;
+                        continue;
+                    }
+
+                    size_t last_changed = x;
+                    for (size_t i = x + 1; i < width && i - last_changed <= MAX_GAP; ++i) {
+                        if (a[i] != b[i]) last_changed = i;
+                    }
+                    const size_t end = last_changed + 1;
+
+                    move_to(y, x);
+                    emit(b + x, end - x);
+                    col = end < width ? end : UNKNOWN_COL;
+                    x = end;
                 }
             }
-            aids::println(stream);
+            move_to(height, 0);
+        }
+
+        if (out.size > 0) {
+            fwrite(out.data, 1, out.size, stream);
+            fflush(stream);
         }
+
+        aids::swap(&prev, &next);
     }
 };
 
-void next_gen(const Board *prev, Board *next)
+Frame_Renderer frame_renderer_of(size_t width, size_t height)
 {
-    for (int y = 0; y < H; ++y) {
-        for (int x = 0; x < W; ++x) {
-            auto nbors = prev->nbors(y, x);
-            if (prev->cells[y][x] == Cell::Alive) {
-                next->cells[y][x] = nbors == 3 || nbors == 2 ? Cell::Alive : Cell::Dead;
-            } else {
-                next->cells[y][x] = nbors == 3 ? Cell::Alive : Cell::Dead;
-            }
+    Frame_Renderer renderer = {};
+    renderer.width = width;
+    renderer.height = height;
+    renderer.prev = aids::mtor.alloc<char>(width * height);
+    renderer.next = aids::mtor.alloc<char>(width * height);
+    renderer.row = height;
+    return renderer;
+}
+
+void destroy(Frame_Renderer renderer)
+{
+    aids::mtor.dealloc(renderer.prev, renderer.width * renderer.height);
+    aids::mtor.dealloc(renderer.next, renderer.width * renderer.height);
+    destroy(renderer.out);
+}
+
+uint64_t random_u64(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+void randomize(Board *board, uint64_t seed)
+{
+    for (size_t y = 0; y < board->height; ++y) {
+        uint64_t *row = board->row(y);
+        for (size_t i = 0; i < board->stride; ++i) {
+            row[i] = random_u64(&seed);
         }
+        row[board->stride - 1] &= board->last_mask();
     }
 }
 
-Board boards[2] = {
-    {
-        {
-            {Cell::Dead, Cell::Alive, Cell::Dead, Cell::Dead, Cell::Dead},
-            {Cell::Dead, Cell::Dead, Cell::Alive, Cell::Dead, Cell::Dead},
-            {Cell::Alive, Cell::Alive, Cell::Alive, Cell::Dead, Cell::Dead},
-            {Cell::Dead, Cell::Dead, Cell::Dead, Cell::Dead, Cell::Dead},
-            {Cell::Dead, Cell::Dead, Cell::Dead, Cell::Dead, Cell::Dead},
+size_t count_bits(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (size_t) ((x * 0x0101010101010101ull) >> 56);
+}
+
+void usage(FILE *stream)
+{
+    aids::println(stream, "Usage: ./gol [<width> <height>]");
+    aids::println(stream, "       ./gol bench [<width> <height> [<generations>]] [--threads <n>] [--sparse]");
+}
+
+size_t parse_positive(const char *arg, const char *name)
+{
+    auto value = aids::cstr_as_string_view(arg).as_integer<int>();
+    if (!value.has_value || value.unwrap <= 0) {
+        usage(stderr);
+        aids::panic("ERROR: ", name, " expects a positive integer");
+    }
+
+    return (size_t) value.unwrap;
+}
+
+size_t shift_positive(aids::Args *args, const char *name)
+{
+    if (args->empty()) {
+        usage(stderr);
+        aids::panic("ERROR: no ", name, " is provided");
+    }
+
+    return parse_positive(args->shift(), name);
+}
+
+void report(const char *name, size_t width, size_t height, size_t generations, uint64_t elapsed)
+{
+    const double updates = (double) width * (double) height * (double) generations;
+    aids::println(stdout, name, ": ", generations, " generations of ", width, "x", height,
+                  " in ", aids::Fixed {(double) elapsed / 1e6, 1}, " ms: ",
+                  aids::Fixed {updates / ((double) elapsed / 1e9) / 1e9, 2},
+                  " billion cell updates/s");
+}
+
+// NOTE: runs the same generations through the dense single threaded
+// next_gen() and through Tiled_Life. --sparse only fills a 256x256
+// square in the middle of the board, which is what the tiles are for.
+int bench(aids::Args args)
+{
+    size_t sizes[3] = {4096, 4096, 100};
+    const char *names[3] = {"width", "height", "generations"};
+    size_t sizes_count = 0;
+    size_t threads = aids::hardware_threads_count();
+    bool sparse = false;
+
+    while (!args.empty()) {
+        const char *arg = args.shift();
+        if (strcmp(arg, "--threads") == 0) {
+            threads = shift_positive(&args, "--threads");
+        } else if (strcmp(arg, "--sparse") == 0) {
+            sparse = true;
+        } else if (sizes_count < 3) {
+            sizes[sizes_count] = parse_positive(arg, names[sizes_count]);
+            sizes_count += 1;
+        } else {
+            usage(stderr);
+            aids::panic("ERROR: unexpected argument `", arg, "`");
         }
-    },
-    {}
-};
+    }
+
+    if (sizes_count == 1) {
+        usage(stderr);
+        aids::panic("ERROR: no height is provided");
+    }
+
+    const size_t width = sizes[0];
+    const size_t height = sizes[1];
+    const size_t generations = sizes[2];
+
+    Board initial = board_of(width, height);
+    defer(destroy(initial));
+    if (sparse) {
+        Board soup = board_of(aids::min(width, (size_t) 256), aids::min(height, (size_t) 256));
+        defer(destroy(soup));
+        randomize(&soup, 0x9E3779B97F4A7C15ull);
+        for (size_t y = 0; y < soup.height; ++y) {
+            for (size_t x = 0; x < soup.width; ++x) {
+                initial.set((width - soup.width) / 2 + x, (height - soup.height) / 2 + y, soup.get(x, y));
+            }
+        }
+    } else {
+        randomize(&initial, 0x9E3779B97F4A7C15ull);
+    }
 
-int main()
+    Board boards[2] = {board_of(width, height), board_of(width, height)};
+    defer(destroy(boards[0]));
+    defer(destroy(boards[1]));
+    memcpy(boards[0].words, initial.words, initial.stride * height * sizeof(uint64_t));
+
+    int fb = 0;
+    uint64_t begin = aids::profile_now();
+    for (size_t i = 0; i < generations; ++i) {
+        next_gen(&boards[fb], &boards[1 - fb]);
+        fb = 1 - fb;
+    }
+    const uint64_t dense_elapsed = aids::profile_now() - begin;
+    report("dense", width, height, generations, dense_elapsed);
+
+    aids::Thread_Pool pool = aids::thread_pool_of(threads);
+    defer(destroy(pool));
+    Tiled_Life life = tiled_life_of(&initial);
+    defer(destroy(life));
+
+    size_t computed_tiles = 0;
+    begin = aids::profile_now();
+    for (size_t i = 0; i < generations; ++i) {
+        computed_tiles += life.active.size;
+        life.next_gen(pool);
+    }
+    const uint64_t tiled_elapsed = aids::profile_now() - begin;
+    report("tiled", width, height, generations, tiled_elapsed);
+
+    aids::println(stdout, "threads: ", pool.threads_count(),
+                  ", computed tiles: ", aids::Fixed {100.0 * (double) computed_tiles / (double) (life.tiles_count() * generations), 1}, "%",
+                  ", speedup: ", aids::Fixed {(double) dense_elapsed / (double) tiled_elapsed, 2}, "x");
+
+    if (memcmp(life.board().words, boards[fb].words, initial.stride * height * sizeof(uint64_t)) != 0) {
+        aids::panic("ERROR: the tiled and the dense boards diverged");
+    }
+
+    size_t alive = 0;
+    for (size_t j = 0; j < initial.stride * height; ++j) {
+        alive += count_bits(boards[fb].words[j]);
+    }
+    aids::println(stdout, "alive: ", alive);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
 {
+    aids::Args args = {argc, argv};
+    args.shift();
+
+    if (!args.empty() && strcmp(*args.argv, "bench") == 0) {
+        args.shift();
+        return bench(args);
+    }
+
+    size_t width = 5;
+    size_t height = 5;
+    if (!args.empty()) {
+        width = shift_positive(&args, "width");
+        height = shift_positive(&args, "height");
+    }
+
 #ifdef _MSC_VER
     // https://docs.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences#example-of-sgr-terminal-sequences
     HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -96,17 +638,29 @@ int main()
     if (!SetConsoleMode(hOut, dwMode)) return GetLastError();
 #endif
 
+    Board boards[2] = {board_of(width, height), board_of(width, height)};
+    defer(destroy(boards[0]));
+    defer(destroy(boards[1]));
+
+    // Glider
+    boards[0].set(1 % width, 0, true);
+    boards[0].set(2 % width, 1 % height, true);
+    boards[0].set(0, 2 % height, true);
+    boards[0].set(1 % width, 2 % height, true);
+    boards[0].set(2 % width, 2 % height, true);
+
+    Frame_Renderer renderer = frame_renderer_of(width, height);
+    defer(destroy(renderer));
+
     int fb = 0;
 
-    boards[fb].render(stdout);
+    renderer.render(boards[fb], stdout);
 
     for (;;) {
         int bb = 1 - fb;
         next_gen(&boards[fb], &boards[bb]);
         fb = bb;
-        aids::print(stdout, "\033[", H, "A");
-        aids::print(stdout, "\033[", W, "D");
-        boards[fb].render(stdout);
+        renderer.render(boards[fb], stdout);
         usleep(200000);
         if (false) break;
     }
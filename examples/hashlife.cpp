@@ -0,0 +1,473 @@
+#define AIDS_IMPLEMENTATION
+#include "aids.hpp"
+
+using namespace aids;
+
+// NOTE: HashLife (Gosper, 1984). The universe is a quadtree whose
+// nodes are canonicalized: two equal subtrees are always the same
+// node, so a node is just a uint32_t index into Universe::nodes. The
+// future of every node is memoized, which makes repetitive patterns
+// cheap to simulate for 2^N generations at once.
+//
+//     ./hashlife [<pattern.rle>] [--log2 <n>] [--generations <n>]
+//
+// Without a pattern file it runs the Gosper glider gun.
+
+struct Quad
+{
+    uint32_t nw, ne, sw, se;
+};
+
+bool operator==(Quad a, Quad b)
+{
+    return a.nw == b.nw && a.ne == b.ne && a.sw == b.sw && a.se == b.se;
+}
+
+bool operator!=(Quad a, Quad b)
+{
+    return !(a == b);
+}
+
+// NOTE: the children of a node are tiny consecutive ids most of the
+// time, so everything has to be mixed into the lower bits.
+uint64_t mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+unsigned long hash(Quad quad)
+{
+    const uint64_t a = ((uint64_t) quad.nw << 32) | quad.ne;
+    const uint64_t b = ((uint64_t) quad.sw << 32) | quad.se;
+    return (unsigned long) mix(a ^ mix(b));
+}
+
+struct Step
+{
+    uint32_t node;
+    uint32_t log2;
+};
+
+bool operator==(Step a, Step b)
+{
+    return a.node == b.node && a.log2 == b.log2;
+}
+
+bool operator!=(Step a, Step b)
+{
+    return !(a == b);
+}
+
+unsigned long hash(Step step)
+{
+    return (unsigned long) mix(((uint64_t) step.node << 32) | step.log2);
+}
+
+// NOTE: a node of level k is a square of 2^k cells. Level 0 nodes are
+// the two leaves: DEAD and ALIVE.
+struct Node
+{
+    Quad quad;
+    uint32_t level;
+    uint64_t population;
+};
+
+const uint32_t DEAD = 0;
+const uint32_t ALIVE = 1;
+const uint32_t MAX_LEVEL = 60;
+
+struct Universe
+{
+    Dynamic_Array<Node> nodes;
+    Hash_Map<Quad, uint32_t> quads;
+    Hash_Map<Step, uint32_t> steps;
+    uint32_t empties[MAX_LEVEL + 1];
+    uint32_t root;
+    uint64_t generation;
+
+    const Node &node(uint32_t id) const
+    {
+        return nodes.data[id];
+    }
+
+    uint32_t join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+    {
+        const Quad quad = {nw, ne, sw, se};
+        auto existing = quads.get(quad);
+        if (existing.has_value) {
+            return *existing.unwrap;
+        }
+
+        const Node result = {
+            quad,
+            node(nw).level + 1,
+            node(nw).population + node(ne).population +
+            node(sw).population + node(se).population
+        };
+        const uint32_t id = (uint32_t) nodes.size;
+        nodes.push(result);
+        quads.insert(quad, id);
+        return id;
+    }
+
+    uint32_t empty(uint32_t level)
+    {
+        if (level == 0) return DEAD;
+        if (empties[level] == 0) {
+            const uint32_t e = empty(level - 1);
+            empties[level] = join(e, e, e, e);
+        }
+        return empties[level];
+    }
+
+    // NOTE: the 2^(k-1) x 2^(k-1) square in the middle of a node of level k
+    uint32_t center(uint32_t id)
+    {
+        const Quad q = node(id).quad;
+        return join(node(q.nw).quad.se, node(q.ne).quad.sw,
+                    node(q.sw).quad.ne, node(q.se).quad.nw);
+    }
+
+    // NOTE: the middle 2x2 cells of a 4x4 node one generation later
+    uint32_t successor_of_level_2(uint32_t id)
+    {
+        bool cells[4][4];
+        const Quad q = node(id).quad;
+        const uint32_t children[2][2] = {{q.nw, q.ne}, {q.sw, q.se}};
+        for (int cy = 0; cy < 2; ++cy) {
+            for (int cx = 0; cx < 2; ++cx) {
+                const Quad leaves = node(children[cy][cx]).quad;
+                cells[cy * 2 + 0][cx * 2 + 0] = leaves.nw == ALIVE;
+                cells[cy * 2 + 0][cx * 2 + 1] = leaves.ne == ALIVE;
+                cells[cy * 2 + 1][cx * 2 + 0] = leaves.sw == ALIVE;
+                cells[cy * 2 + 1][cx * 2 + 1] = leaves.se == ALIVE;
+            }
+        }
+
+        uint32_t next[2][2];
+        for (int y = 1; y <= 2; ++y) {
+            for (int x = 1; x <= 2; ++x) {
+                int nbors = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        if ((dx != 0 || dy != 0) && cells[y + dy][x + dx]) {
+                            nbors += 1;
+                        }
+                    }
+                }
+                const bool alive = nbors == 3 || (nbors == 2 && cells[y][x]);
+                next[y - 1][x - 1] = alive ? ALIVE : DEAD;
+            }
+        }
+
+        return join(next[0][0], next[0][1], next[1][0], next[1][1]);
+    }
+
+    // NOTE: the center of a node of level k, 2^log2 generations later.
+    // log2 == k - 2 is the classic HashLife step: the node is split
+    // into 9 overlapping subnodes of level k - 1 which are advanced
+    // twice by 2^(k-3) generations. For smaller steps the first pass
+    // only takes the centers and the second one advances by 2^log2.
+    uint32_t successor(uint32_t id, uint32_t log2)
+    {
+        const uint32_t level = node(id).level;
+        assert(level >= 2 && log2 + 2 <= level);
+
+        if (node(id).population == 0) {
+            return empty(level - 1);
+        }
+
+        const Step step = {id, log2};
+        auto memo = steps.get(step);
+        if (memo.has_value) {
+            return *memo.unwrap;
+        }
+
+        uint32_t result = 0;
+        if (level == 2) {
+            result = successor_of_level_2(id);
+        } else {
+            uint32_t g[4][4];
+            const Quad q = node(id).quad;
+            const uint32_t children[2][2] = {{q.nw, q.ne}, {q.sw, q.se}};
+            for (int cy = 0; cy < 2; ++cy) {
+                for (int cx = 0; cx < 2; ++cx) {
+                    const Quad grandchildren = node(children[cy][cx]).quad;
+                    g[cy * 2 + 0][cx * 2 + 0] = grandchildren.nw;
+                    g[cy * 2 + 0][cx * 2 + 1] = grandchildren.ne;
+                    g[cy * 2 + 1][cx * 2 + 0] = grandchildren.sw;
+                    g[cy * 2 + 1][cx * 2 + 1] = grandchildren.se;
+                }
+            }
+
+            const bool full_speed = log2 + 2 == level;
+
+            uint32_t s[3][3];
+            for (int y = 0; y < 3; ++y) {
+                for (int x = 0; x < 3; ++x) {
+                    const uint32_t sub = join(g[y][x], g[y][x + 1], g[y + 1][x], g[y + 1][x + 1]);
+                    s[y][x] = full_speed ? successor(sub, log2 - 1) : center(sub);
+                }
+            }
+
+            const uint32_t next_log2 = min(log2, level - 3);
+            uint32_t r[2][2];
+            for (int y = 0; y < 2; ++y) {
+                for (int x = 0; x < 2; ++x) {
+                    const uint32_t sub = join(s[y][x], s[y][x + 1], s[y + 1][x], s[y + 1][x + 1]);
+                    r[y][x] = successor(sub, next_log2);
+                }
+            }
+
+            result = join(r[0][0], r[0][1], r[1][0], r[1][1]);
+        }
+
+        steps.insert(step, result);
+        return result;
+    }
+
+    // NOTE: the same node one level up with an empty border around it
+    void expand()
+    {
+        if (node(root).level >= MAX_LEVEL) {
+            panic("ERROR: the universe is too big");
+        }
+
+        const Quad q = node(root).quad;
+        const uint32_t e = empty(node(root).level - 1);
+        root = join(join(e, e, e, q.nw), join(e, e, q.ne, e),
+                    join(e, q.sw, e, e), join(q.se, e, e, e));
+    }
+
+    // NOTE: every live cell is in the center of the root
+    bool is_padded() const
+    {
+        const Quad q = node(root).quad;
+        return node(q.nw).population == node(node(q.nw).quad.se).population
+            && node(q.ne).population == node(node(q.ne).quad.sw).population
+            && node(q.sw).population == node(node(q.sw).quad.ne).population
+            && node(q.se).population == node(node(q.se).quad.nw).population;
+    }
+
+    void advance_log2(uint32_t log2)
+    {
+        // NOTE: within 2^log2 generations the pattern grows by at most
+        // 2^log2 cells in every direction. Two more levels on top of
+        // a padded root make sure all of it stays in the center.
+        while (node(root).level < log2 + 2 || !is_padded()) {
+            expand();
+        }
+        expand();
+        expand();
+
+        root = successor(root, log2);
+        generation += 1ull << log2;
+
+        while (node(root).level > 3 && is_padded()) {
+            root = center(root);
+        }
+    }
+
+    void advance(uint64_t generations)
+    {
+        for (uint32_t log2 = 0; log2 < 64; ++log2) {
+            if ((generations >> log2) & 1) {
+                advance_log2(log2);
+            }
+        }
+    }
+
+    uint32_t set_alive(uint32_t id, int64_t x, int64_t y)
+    {
+        const uint32_t level = node(id).level;
+        if (level == 0) {
+            return ALIVE;
+        }
+
+        // NOTE: a node of level k covers [-2^(k-1), 2^(k-1)) around its
+        // center on both axes
+        const int64_t offset = level >= 2 ? (int64_t) 1 << (level - 2) : 0;
+        Quad q = node(id).quad;
+        if (y < 0) {
+            if (x < 0) q.nw = set_alive(q.nw, x + offset, y + offset);
+            else       q.ne = set_alive(q.ne, x - offset, y + offset);
+        } else {
+            if (x < 0) q.sw = set_alive(q.sw, x + offset, y - offset);
+            else       q.se = set_alive(q.se, x - offset, y - offset);
+        }
+        return join(q.nw, q.ne, q.sw, q.se);
+    }
+
+    void set_alive(int64_t x, int64_t y)
+    {
+        for (;;) {
+            const int64_t half = (int64_t) 1 << (node(root).level - 1);
+            if (-half <= x && x < half && -half <= y && y < half) break;
+            expand();
+        }
+        root = set_alive(root, x, y);
+    }
+
+    uint64_t population() const
+    {
+        return node(root).population;
+    }
+};
+
+Universe universe_of()
+{
+    Universe universe = {};
+    universe.nodes.push({{}, 0, 0});
+    universe.nodes.push({{}, 0, 1});
+    universe.root = universe.empty(3);
+    return universe;
+}
+
+void destroy(Universe universe)
+{
+    destroy(universe.nodes);
+    destroy(universe.quads);
+    destroy(universe.steps);
+}
+
+// NOTE: https://conwaylife.com/wiki/Run_Length_Encoded
+// The pattern is centered around (0, 0).
+void load_rle(Universe *universe, String_View rle)
+{
+    int64_t width = 0;
+    int64_t height = 0;
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t count = 0;
+
+    while (rle.count > 0) {
+        String_View line = rle.chop_by_delim('\n').trim();
+        if (line.count == 0 || *line.data == '#') continue;
+
+        if (*line.data == 'x') {
+            while (line.count > 0) {
+                String_View value = line.chop_by_delim(',').trim();
+                String_View name = value.chop_by_delim('=').trim();
+                auto number = value.trim().as_integer<int64_t>();
+                if (name == "x"_sv && number.has_value) width = number.unwrap;
+                if (name == "y"_sv && number.has_value) height = number.unwrap;
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < line.count; ++i) {
+            const char c = line.data[i];
+            if (c == '!') return;
+            if (isdigit(c)) {
+                count = count * 10 + (c - '0');
+                continue;
+            }
+
+            const int64_t n = count > 0 ? count : 1;
+            count = 0;
+            if (c == 'b') {
+                x += n;
+            } else if (c == '$') {
+                x = 0;
+                y += n;
+            } else if (isalpha(c)) {
+                for (int64_t j = 0; j < n; ++j, ++x) {
+                    universe->set_alive(x - width / 2, y - height / 2);
+                }
+            }
+        }
+    }
+}
+
+const char *GOSPER_GLIDER_GUN =
+    "#N Gosper glider gun\n"
+    "x = 36, y = 9, rule = B3/S23\n"
+    "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4b\n"
+    "obo$10bo5bo7bo$11bo3bo$12b2o!\n";
+
+void usage(FILE *stream)
+{
+    println(stream, "Usage: ./hashlife [<pattern.rle>] [--log2 <n>] [--generations <n>]");
+}
+
+void report(const Universe *universe, uint64_t begin)
+{
+    println(stdout, "generation ", universe->generation,
+            ": population ", universe->population(),
+            ", nodes ", universe->nodes.size,
+            ", memoized steps ", universe->steps.size,
+            ", ", Fixed {(double) (profile_now() - begin) / 1e6, 1}, " ms");
+}
+
+int main(int argc, char *argv[])
+{
+    Args args = {argc, argv};
+    args.shift();
+
+    const char *pattern_file_path = nullptr;
+    uint64_t max_log2 = 40;
+    uint64_t generations = 0;
+
+    while (!args.empty()) {
+        const char *flag = args.shift();
+        if (strcmp(flag, "--log2") == 0 || strcmp(flag, "--generations") == 0) {
+            if (args.empty()) {
+                usage(stderr);
+                panic("ERROR: no value for ", flag);
+            }
+            auto value = cstr_as_string_view(args.shift()).as_integer<int64_t>();
+            if (!value.has_value || value.unwrap < 0) {
+                usage(stderr);
+                panic("ERROR: ", flag, " expects a non-negative integer");
+            }
+            if (strcmp(flag, "--log2") == 0) {
+                max_log2 = (uint64_t) value.unwrap;
+            } else {
+                generations = (uint64_t) value.unwrap;
+            }
+        } else {
+            pattern_file_path = flag;
+        }
+    }
+
+    if (max_log2 > 56) {
+        panic("ERROR: --log2 is at most 56");
+    }
+
+    Universe universe = universe_of();
+    defer(destroy(universe));
+
+    if (pattern_file_path) {
+        auto rle = unwrap_or_panic(
+                       read_file_as_string_view(pattern_file_path),
+                       "Could not read file `", pattern_file_path, "`: ", strerror(errno));
+        defer(destroy(rle));
+        load_rle(&universe, rle);
+    } else {
+        load_rle(&universe, cstr_as_string_view(GOSPER_GLIDER_GUN));
+    }
+
+    const uint64_t begin = profile_now();
+    report(&universe, begin);
+
+    if (generations > 0) {
+        universe.advance(generations);
+        report(&universe, begin);
+        return 0;
+    }
+
+    // 1, 2, 4, ..., 2^max_log2 generations
+    universe.advance(1);
+    report(&universe, begin);
+    for (uint32_t log2 = 0; log2 < max_log2; ++log2) {
+        universe.advance_log2(log2);
+        report(&universe, begin);
+    }
+
+    return 0;
+}
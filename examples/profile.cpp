@@ -0,0 +1,63 @@
+#define AIDS_PROFILE
+#define AIDS_IMPLEMENTATION
+#include "aids.hpp"
+
+using namespace aids;
+
+unsigned long count_words(String_View text)
+{
+    AIDS_PROFILE_ZONE("count_words");
+
+    unsigned long words = 0;
+    while (text.trim().count > 0) {
+        text.chop_word();
+        words += 1;
+    }
+    return words;
+}
+
+unsigned long count_unique_words(String_View text)
+{
+    AIDS_PROFILE_ZONE("count_unique_words");
+
+    Hash_Map<String_View, int> words = {};
+    defer(destroy(words));
+
+    while (text.trim().count > 0) {
+        *words[text.chop_word()] += 1;
+    }
+    return (unsigned long) words.size;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        println(stderr, "Usage: ./profile <input.txt> [trace.json]");
+        exit(1);
+    }
+
+    auto text = unwrap_or_panic(
+                    read_file_as_string_view(argv[1]),
+                    "Could not read file `", argv[1], "`: ", strerror(errno));
+    defer(destroy(text));
+
+    for (int i = 0; i < 10; ++i) {
+        AIDS_PROFILE_ZONE("iteration");
+        println(stdout, "Words: ", count_words(text),
+                ", unique words: ", count_unique_words(text));
+    }
+
+    println(stdout);
+    profile_dump_summary(stdout);
+
+    if (argc >= 3) {
+        FILE *trace = fopen(argv[2], "wb");
+        if (trace == nullptr) {
+            panic("Could not open file `", argv[2], "`: ", strerror(errno));
+        }
+        defer(fclose(trace));
+        profile_dump_chrome_trace(trace);
+    }
+
+    return 0;
+}
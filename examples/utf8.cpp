@@ -6,7 +6,7 @@ using namespace aids;
 void code_points_of(const char *cstr)
 {
     String_View s = cstr_as_string_view(cstr);
-    println(stdout, "Code points of \"", s, "\"");
+    println(stdout, "Code points of \"", s, "\" (", utf8_length(s), " in total, uppercased \"", Caps { s }, "\")");
     while (s.count > 0) {
         size_t size = 0;
         auto code = utf8_get_code(s, &size);
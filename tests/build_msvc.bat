@@ -9,3 +9,29 @@ cl.exe %CXXFLAGS% %INCLUDES% utf8_test.cpp
 cl.exe %CXXFLAGS% %INCLUDES% hash_map_test.cpp
 
 cl.exe %CXXFLAGS% %INCLUDES% string_view_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% string_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% interner_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% piece_table_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% sort_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% thread_pool_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% queue_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% small_array_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% dynamic_array_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% maybe_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% print_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% encoding_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% hash_set_test.cpp
+
+cl.exe %CXXFLAGS% %INCLUDES% profile_test.cpp
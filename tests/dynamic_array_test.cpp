@@ -0,0 +1,104 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+template <typename Array>
+void expect_items(Array *xs, const int *expected, size_t count, const char *context)
+{
+    if (xs->size != count) {
+        panic("ERROR: ", context, ": expected ", count, " items, got ", xs->size);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if ((*xs)[i] != expected[i]) {
+            panic("ERROR: ", context, ": item ", i, " is ", (*xs)[i], " instead of ", expected[i]);
+        }
+    }
+}
+
+// NOTE: the same scenario for Dynamic_Array and Small_Array, the
+// latter spills to the heap in the middle of it
+template <typename Array>
+void test_editing(Array *xs)
+{
+    const int items[] = {1, 2, 3, 4, 5};
+    xs->concat(items, 5);
+    xs->insert(0, 0);
+    xs->insert(6, 6);
+    xs->insert(3, 42);
+    {
+        const int expected[] = {0, 1, 2, 42, 3, 4, 5, 6};
+        expect_items(xs, expected, 8, "insert()");
+    }
+
+    xs->remove_at(3);
+    xs->swap_remove(0);
+    {
+        const int expected[] = {6, 1, 2, 3, 4, 5};
+        expect_items(xs, expected, 6, "remove_at() and swap_remove()");
+    }
+
+    if (xs->pop() != 5 || xs->pop() != 4) {
+        panic("ERROR: pop() returned the wrong items");
+    }
+
+    xs->resize(6);
+    {
+        const int expected[] = {6, 1, 2, 3, 0, 0};
+        expect_items(xs, expected, 6, "resize()");
+    }
+
+    xs->clear();
+    if (xs->size != 0) {
+        panic("ERROR: clear() did not clear the array");
+    }
+}
+
+int main(int, char *[])
+{
+    {
+        Dynamic_Array<int> xs = {};
+        defer(destroy(xs));
+        test_editing(&xs);
+
+        if (xs.capacity == 0) {
+            panic("ERROR: Dynamic_Array::clear() has to keep the capacity");
+        }
+    }
+
+    {
+        Small_Array<int, 6> xs = {};
+        defer(destroy(xs));
+        test_editing(&xs);
+    }
+
+    {
+        // NOTE: a batch bigger than the doubled capacity has to be
+        // copied in full after one allocation
+        const size_t N = 10000;
+        int *items = mtor.alloc<int>(N);
+        defer(mtor.dealloc(items, N));
+        for (size_t i = 0; i < N; ++i) {
+            items[i] = (int) i;
+        }
+
+        Dynamic_Array<int> xs = {};
+        defer(destroy(xs));
+        xs.push(-1);
+        xs.concat(items, N);
+
+        if (xs.size != N + 1 || xs.capacity < N + 1 || xs[0] != -1 || xs[N] != (int) N - 1) {
+            panic("ERROR: Dynamic_Array::concat() of a big batch is broken");
+        }
+
+        xs.reserve(3 * N);
+        if (xs.capacity != 3 * N || xs[N] != (int) N - 1) {
+            panic("ERROR: Dynamic_Array::reserve() has to allocate exactly");
+        }
+    }
+
+    println(stdout, "OK.");
+
+    return 0;
+}
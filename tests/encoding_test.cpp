@@ -0,0 +1,223 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+// NOTE: the test vectors of RFC 4648
+struct Test_Vector {
+    String_View bytes;
+    String_View hex;
+    String_View base64;
+};
+
+const Test_Vector test_vectors[] = {
+    {""_sv,       ""_sv,             ""_sv},
+    {"f"_sv,      "66"_sv,           "Zg=="_sv},
+    {"fo"_sv,     "666f"_sv,         "Zm8="_sv},
+    {"foo"_sv,    "666f6f"_sv,       "Zm9v"_sv},
+    {"foob"_sv,   "666f6f62"_sv,     "Zm9vYg=="_sv},
+    {"fooba"_sv,  "666f6f6261"_sv,   "Zm9vYmE="_sv},
+    {"foobar"_sv, "666f6f626172"_sv, "Zm9vYmFy"_sv},
+};
+
+const String_View invalid_hex[] = {
+    "6"_sv, "6g"_sv, "g6"_sv, "66 "_sv, "0x66"_sv,
+};
+
+const String_View invalid_base64[] = {
+    "Z"_sv, "Zg="_sv, "Zg==="_sv, "Z==="_sv, "Zg=a"_sv, "Zm9v YmFy"_sv, "Zm9v\n"_sv, "Zm-v"_sv,
+};
+
+template <typename Encode>
+String_View encode(Encode encode, String_View input, char *output)
+{
+    return String_View {encode(input, output), output};
+}
+
+template <typename Decode>
+Maybe<String_View> decode(Decode decode, String_View input, char *output)
+{
+    auto n = decode(input, output);
+    if (!n.has_value) {
+        return {};
+    }
+    return some(String_View {n.unwrap, output});
+}
+
+void test_vectors_roundtrip()
+{
+    char buffer[64];
+    for (const auto &test : test_vectors) {
+        if (encode(bytes_to_hex, test.bytes, buffer) != test.hex) {
+            panic("ERROR: unexpected hex of `", test.bytes, "`: ", encode(bytes_to_hex, test.bytes, buffer));
+        }
+        if (encode(bytes_to_base64, test.bytes, buffer) != test.base64) {
+            panic("ERROR: unexpected base64 of `", test.bytes, "`: ", encode(bytes_to_base64, test.bytes, buffer));
+        }
+        if (decode(hex_to_bytes, test.hex, buffer) != some(test.bytes)) {
+            panic("ERROR: could not decode hex `", test.hex, "`");
+        }
+        if (decode(base64_to_bytes, test.base64, buffer) != some(test.bytes)) {
+            panic("ERROR: could not decode base64 `", test.base64, "`");
+        }
+        if (bytes_length_as_hex(test.bytes) != test.hex.count ||
+            hex_length_as_bytes(test.hex) != test.bytes.count ||
+            bytes_length_as_base64(test.bytes) != test.base64.count ||
+            base64_length_as_bytes(test.base64) != test.bytes.count) {
+            panic("ERROR: unexpected lengths of `", test.bytes, "`");
+        }
+    }
+
+    if (decode(hex_to_bytes, "666F6f"_sv, buffer) != some("foo"_sv)) {
+        panic("ERROR: hex digits are expected to be case insensitive");
+    }
+    if (decode(base64_to_bytes, "Zm9vYg"_sv, buffer) != some("foob"_sv) ||
+        decode(base64_to_bytes, "Zm9vYmE"_sv, buffer) != some("fooba"_sv)) {
+        panic("ERROR: unpadded base64 is expected to be accepted");
+    }
+
+    for (auto hex : invalid_hex) {
+        if (decode(hex_to_bytes, hex, buffer).has_value) {
+            panic("ERROR: `", hex, "` is not expected to be valid hex");
+        }
+    }
+    for (auto base64 : invalid_base64) {
+        if (decode(base64_to_bytes, base64, buffer).has_value) {
+            panic("ERROR: `", base64, "` is not expected to be valid base64");
+        }
+    }
+}
+
+// NOTE: every length up to a few SIMD blocks, every byte value, and an
+// invalid digit planted at every position of the encoded text
+void test_long_roundtrip()
+{
+    const size_t MAX_COUNT = 200;
+    char bytes[MAX_COUNT];
+    char encoded[MAX_COUNT * 2];
+    char decoded[MAX_COUNT];
+
+    uint32_t seed = 69;
+    for (size_t count = 0; count <= MAX_COUNT; ++count) {
+        for (size_t i = 0; i < count; ++i) {
+            seed = seed * 1664525 + 1013904223;
+            bytes[i] = (char) (seed >> 24);
+        }
+        String_View input = {count, bytes};
+
+        String_View hex = encode(bytes_to_hex, input, encoded);
+        for (size_t i = 0; i < count; ++i) {
+            const char *digits = "0123456789abcdef";
+            const uint8_t x = (uint8_t) bytes[i];
+            if (hex.data[2 * i] != digits[x >> 4] || hex.data[2 * i + 1] != digits[x & 0xF]) {
+                panic("ERROR: byte ", i, " of ", count, " is encoded into wrong hex digits");
+            }
+        }
+        if (decode(hex_to_bytes, hex, decoded) != some(input)) {
+            panic("ERROR: hex of ", count, " bytes did not roundtrip");
+        }
+        for (size_t i = 0; i < hex.count; ++i) {
+            const char saved = encoded[i];
+            encoded[i] = 'x';
+            if (decode(hex_to_bytes, hex, decoded).has_value) {
+                panic("ERROR: invalid digit at ", i, " of ", hex.count, " hex digits was accepted");
+            }
+            encoded[i] = saved;
+        }
+
+        String_View base64 = encode(bytes_to_base64, input, encoded);
+        if (decode(base64_to_bytes, base64, decoded) != some(input)) {
+            panic("ERROR: base64 of ", count, " bytes did not roundtrip");
+        }
+        for (size_t i = 0; i < base64.count; ++i) {
+            const char saved = encoded[i];
+            encoded[i] = (char) 0xC3;
+            if (decode(base64_to_bytes, base64, decoded).has_value) {
+                panic("ERROR: invalid digit at ", i, " of ", base64.count, " base64 digits was accepted");
+            }
+            encoded[i] = saved;
+        }
+    }
+
+    // NOTE: every byte value makes it through the SIMD lookups
+    for (size_t i = 0; i < MAX_COUNT; ++i) {
+        bytes[i] = (char) i;
+    }
+    String_View input = {MAX_COUNT, bytes};
+    auto hex = unwrap_or_panic(bytes_as_hex(input), "ERROR: could not encode hex");
+    defer(destroy(hex));
+    auto base64 = unwrap_or_panic(bytes_as_base64(input), "ERROR: could not encode base64");
+    defer(destroy(base64));
+    auto hex_bytes = unwrap_or_panic(hex_as_bytes(hex), "ERROR: could not decode hex");
+    defer(destroy(hex_bytes));
+    auto base64_bytes = unwrap_or_panic(base64_as_bytes(base64), "ERROR: could not decode base64");
+    defer(destroy(base64_bytes));
+    if (hex_bytes != input || base64_bytes != input) {
+        panic("ERROR: all byte values did not roundtrip");
+    }
+}
+
+void test_hex_bytes_printing()
+{
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+        panic("ERROR: could not create a temporary file: ", strerror(errno));
+    }
+    defer(fclose(file));
+
+    println(file, Hex_Bytes {String_View {5, "\x00\x0a\x10\xff\x7f"}}, " ", Hex_Bytes {""_sv});
+
+    char data[64];
+    fflush(file);
+    rewind(file);
+    String_View actual = {fread(data, 1, sizeof(data), file), data};
+    if (actual != "[0, a, 10, ff, 7f] []\n"_sv) {
+        panic("ERROR: unexpected Hex_Bytes output: ", actual);
+    }
+}
+
+// NOTE: runs out of memory on every allocation, even on the empty ones
+struct Failing_Ator {
+    template <typename T>
+    T *alloc(size_t, T = {})
+    {
+        return nullptr;
+    }
+
+    template <typename T>
+    void dealloc(T *, size_t) {}
+};
+
+void test_allocation_failure()
+{
+    Failing_Ator ator = {};
+    if (bytes_as_hex("foobar"_sv, &ator).has_value ||
+            bytes_as_base64("foobar"_sv, &ator).has_value ||
+            hex_as_bytes("666f6f"_sv, &ator).has_value ||
+            base64_as_bytes("Zm9v"_sv, &ator).has_value) {
+        panic("ERROR: a failed allocation is expected to give None");
+    }
+
+    auto hex = bytes_as_hex(""_sv, &ator);
+    auto base64 = bytes_as_base64(""_sv, &ator);
+    auto hex_bytes = hex_as_bytes(""_sv, &ator);
+    auto base64_bytes = base64_as_bytes(""_sv, &ator);
+    if (!hex.has_value || hex.unwrap.count != 0 ||
+            !base64.has_value || base64.unwrap.count != 0 ||
+            !hex_bytes.has_value || hex_bytes.unwrap.count != 0 ||
+            !base64_bytes.has_value || base64_bytes.unwrap.count != 0) {
+        panic("ERROR: an empty input is expected to be converted into an empty output");
+    }
+}
+
+int main(int, char *[])
+{
+    test_vectors_roundtrip();
+    test_long_roundtrip();
+    test_hex_bytes_printing();
+    test_allocation_failure();
+
+    println(stdout, "OK.");
+
+    return 0;
+}
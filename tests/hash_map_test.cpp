@@ -3,6 +3,11 @@
 
 using namespace aids;
 
+// NOTE: the buckets borrow the niche of String_View
+static_assert(sizeof(Compact_Maybe<Hash_Map<String_View, int>::Bucket>) ==
+              sizeof(Hash_Map<String_View, int>::Bucket),
+              "the buckets of Hash_Map<String_View, int> are expected to have no flag");
+
 void prepare_expected_freq(Hash_Map<String_View, int> *map)
 {
     map->insert("quis"_sv, 1);
@@ -71,8 +76,196 @@ void prepare_expected_freq(Hash_Map<String_View, int> *map)
     map->insert("Duis"_sv, 1);
 }
 
+struct Colliding_Key {
+    uint32_t x;
+
+    bool operator==(const Colliding_Key &that) const
+    {
+        return x == that.x;
+    }
+
+    bool operator!=(const Colliding_Key &that) const
+    {
+        return x != that.x;
+    }
+};
+
+unsigned long hash(Colliding_Key)
+{
+    return 42;
+}
+
+void test_stats()
+{
+    {
+        Hash_Map<uint32_t, int> map = {};
+        defer(destroy(map));
+
+        for (uint32_t i = 0; i < 1000; ++i) {
+            map.insert(i, 0);
+        }
+
+        Hash_Map_Stats stats = map.stats();
+        size_t histogram_total = 0;
+        for (size_t i = 0; i < Hash_Map_Stats::DISPLACEMENT_HISTOGRAM_SIZE; ++i) {
+            histogram_total += stats.displacement_histogram[i];
+        }
+
+        if (stats.size != 1000 || stats.capacity != 2048 || stats.resizes != 3 ||
+                histogram_total != 1000 || stats.load_factor != 1000.0f / 2048.0f) {
+            panic("ERROR: unexpected stats of uint32_t map:\n", stats);
+        }
+    }
+
+    {
+        Hash_Map<Colliding_Key, int> map = {};
+        defer(destroy(map));
+
+        for (uint32_t i = 0; i < 10; ++i) {
+            map.insert({i}, 0);
+        }
+
+        Hash_Map_Stats stats = map.stats();
+        bool histogram_ok = true;
+        for (size_t i = 0; i < Hash_Map_Stats::DISPLACEMENT_HISTOGRAM_SIZE; ++i) {
+            histogram_ok = histogram_ok && stats.displacement_histogram[i] == (i < 10 ? 1u : 0u);
+        }
+
+        // NOTE: all of the keys are in one run of 10 buckets, so a miss
+        // starting in that run looks at 11..2 buckets and 1 elsewhere.
+        if (stats.resizes != 0 || stats.max_probe_length != 10 ||
+                stats.average_probe_length != 5.5f ||
+                stats.average_miss_probe_length != 311.0f / 256.0f ||
+                !histogram_ok) {
+            panic("ERROR: unexpected stats of colliding map:\n", stats);
+        }
+    }
+}
+
+void test_get_many()
+{
+    Hash_Map<uint32_t, uint32_t> map = {};
+    defer(destroy(map));
+
+    const size_t N = 1000;
+    uint32_t keys[N];
+    Maybe<uint32_t*> values[N];
+
+    map.get_many(keys, 0, values);
+    keys[0] = 69;
+    map.get_many(keys, 1, values);
+    if (values[0].has_value) {
+        panic("ERROR: an empty map is not expected to have any keys");
+    }
+
+    // NOTE: the even keys are inserted, the odd ones are missing
+    for (uint32_t i = 0; i < N; ++i) {
+        keys[i] = i * 7919;
+        if (i % 2 == 0) {
+            map.insert_with_hash(keys[i], hash(keys[i]), i);
+        }
+    }
+
+    // NOTE: the amounts that are not a multiple of a batch
+    const size_t amounts[] = {N, N - 1, 17, 3};
+    for (size_t n : amounts) {
+        map.get_many(keys, n, values);
+        for (uint32_t i = 0; i < n; ++i) {
+            if (values[i].has_value != (i % 2 == 0) ||
+                    (values[i].has_value && *values[i].unwrap != i)) {
+                panic("ERROR: get_many() disagrees with the inserted keys at ", keys[i]);
+            }
+            if (map.get_with_hash(keys[i], hash(keys[i])) != map.get(keys[i])) {
+                panic("ERROR: get_with_hash() disagrees with get() at ", keys[i]);
+            }
+        }
+    }
+
+    Hash_Map<Colliding_Key, int> colliding = {};
+    defer(destroy(colliding));
+    Colliding_Key colliding_keys[40];
+    Maybe<int*> colliding_values[40];
+    for (uint32_t i = 0; i < 40; ++i) {
+        colliding_keys[i] = {i};
+        if (i < 20) {
+            colliding.insert(colliding_keys[i], (int) i);
+        }
+    }
+    colliding.get_many(colliding_keys, 40, colliding_values);
+    for (uint32_t i = 0; i < 40; ++i) {
+        if (colliding_values[i].has_value != (i < 20) ||
+                (colliding_values[i].has_value && *colliding_values[i].unwrap != (int) i)) {
+            panic("ERROR: get_many() disagrees with the inserted colliding keys at ", i);
+        }
+    }
+}
+
+struct Obj {
+    int id;
+};
+
+unsigned long hash(Obj *obj)
+{
+    return hash((uint32_t) (obj ? obj->id : -1));
+}
+
+// NOTE: nullptr is the niche of the pointers, so it doesn't go into
+// the buckets, but it is still a valid key
+void test_niche_key()
+{
+    Obj objects[1000];
+    for (int i = 0; i < 1000; ++i) {
+        objects[i] = {i};
+    }
+
+    Hash_Map<Obj*, int> map = {};
+    defer(destroy(map));
+
+    map.insert(nullptr, 69);
+    map.insert(nullptr, 420);
+    if (map.size != 1 || !map.contains(nullptr) || *map.get(nullptr).unwrap != 420) {
+        panic("ERROR: nullptr is expected to be a key like any other");
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        map.insert(&objects[i], i);
+    }
+    if (map.size != 1001 || map.resizes == 0 || *map.get(nullptr).unwrap != 420) {
+        panic("ERROR: nullptr key is expected to survive the resizes");
+    }
+
+    size_t count = 0;
+    long long sum = 0;
+    map.for_each([&](Obj *key, int &value) {
+        count += 1;
+        sum += value;
+        if (key != nullptr && *map.get(key).unwrap != key->id) {
+            panic("ERROR: for_each() disagrees with get()");
+        }
+    });
+    if (count != 1001 || sum != 420 + 999 * 1000 / 2) {
+        panic("ERROR: for_each() is expected to visit every key once");
+    }
+
+    if (!map.remove(nullptr) || map.remove(nullptr) || map.contains(nullptr) || map.size != 1000) {
+        panic("ERROR: nullptr key is expected to be removed exactly once");
+    }
+
+    Hash_Map<Obj*, int> empty = {};
+    defer(destroy(empty));
+    *empty[nullptr] += 1;
+    empty.insert(&objects[0], 0);
+    if (empty.size != 2 || *empty.get(nullptr).unwrap != 1) {
+        panic("ERROR: nullptr key is expected to work before the first allocation");
+    }
+}
+
 int main(int, char *[])
 {
+    test_stats();
+    test_get_many();
+    test_niche_key();
+
     String_View text = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum."_sv;
 
     Hash_Map<String_View, int> actual_freq = {};
@@ -93,25 +286,21 @@ int main(int, char *[])
         }
     }
 
-    for (size_t i = 0; i < actual_freq.capacity; ++i) {
-        if (actual_freq.buckets[i].has_value) {
-            auto word = actual_freq.buckets[i].unwrap.key;
-            auto freq = expected_freq.get(word);
-            auto actual = actual_freq.buckets[i].unwrap.value;
+    actual_freq.for_each([&](String_View word, int actual) {
+        auto freq = expected_freq.get(word);
 
-            println(stdout, word, "...");
+        println(stdout, word, "...");
 
-            if (!freq.has_value) {
-                panic("ERROR: unexpected word `", word, "`");
-            }
+        if (!freq.has_value) {
+            panic("ERROR: unexpected word `", word, "`");
+        }
 
-            auto expected = *freq.unwrap;
+        auto expected = *freq.unwrap;
 
-            if (expected != actual) {
-                panic("ERROR: unexpected frequency of word `", word, "`. Expected: ", expected, ", Actual: ", actual);
-            }
+        if (expected != actual) {
+            panic("ERROR: unexpected frequency of word `", word, "`. Expected: ", expected, ", Actual: ", actual);
         }
-    }
+    });
 
     if (actual_freq.size != expected_freq.size) {
         panic("ERROR: Unexpected size of hash map. ",
@@ -119,5 +308,27 @@ int main(int, char *[])
               "Actual: ", actual_freq.size);
     }
 
+    {
+        const size_t size = actual_freq.size;
+        if (!actual_freq.remove("dolor"_sv) || actual_freq.remove("dolor"_sv) ||
+                actual_freq.size != size - 1 || actual_freq.contains("dolor"_sv)) {
+            panic("ERROR: `dolor` is expected to be removed exactly once");
+        }
+        expected_freq.for_each([&](String_View word, int) {
+            if (word != "dolor"_sv && !actual_freq.contains(word)) {
+                panic("ERROR: `", word, "` is lost after removing `dolor`");
+            }
+        });
+        actual_freq.insert("dolor"_sv, 2);
+    }
+
+    {
+        const size_t size = actual_freq.size;
+        actual_freq.insert("Lorem"_sv, 69);
+        if (actual_freq.size != size || *actual_freq.get("Lorem"_sv).unwrap != 69) {
+            panic("ERROR: inserting an existing key is expected to replace its value");
+        }
+    }
+
     return 0;
 }
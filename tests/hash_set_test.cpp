@@ -0,0 +1,223 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+struct Colliding_Key {
+    uint32_t x;
+
+    bool operator==(const Colliding_Key &that) const
+    {
+        return x == that.x;
+    }
+
+    bool operator!=(const Colliding_Key &that) const
+    {
+        return x != that.x;
+    }
+};
+
+unsigned long hash(Colliding_Key key)
+{
+    // NOTE: a few long runs that wrap around the end of the slots
+    return 250 + key.x % 3;
+}
+
+// NOTE: random inserts and removes checked against a plain array of
+// flags, with enough of them to grow the set a couple of times
+template <typename Key, typename Make_Key>
+void test_against_flags(Make_Key make_key, uint32_t key_count)
+{
+    Hash_Set<Key> set = {};
+    defer(destroy(set));
+
+    bool *present = mtor.alloc<bool>(key_count, false);
+    defer(mtor.dealloc(present, key_count));
+    size_t size = 0;
+
+    uint32_t random_state = 69;
+    for (size_t step = 0; step < 20000; ++step) {
+        random_state = random_state * 1664525 + 1013904223;
+        const uint32_t x = (random_state >> 8) % key_count;
+        const bool insert = (random_state >> 4) % 3 != 0;
+
+        if (insert) {
+            if (set.insert(make_key(x)) == present[x]) {
+                panic("ERROR: insert() of ", x, " is expected to return ", !present[x]);
+            }
+            size += !present[x];
+            present[x] = true;
+        } else {
+            if (set.remove(make_key(x)) != present[x]) {
+                panic("ERROR: remove() of ", x, " is expected to return ", present[x]);
+            }
+            size -= present[x];
+            present[x] = false;
+        }
+
+        if (set.size != size) {
+            panic("ERROR: unexpected size ", set.size, " instead of ", size);
+        }
+    }
+
+    for (uint32_t x = 0; x < key_count; ++x) {
+        if (set.contains(make_key(x)) != present[x]) {
+            panic("ERROR: contains() of ", x, " is expected to return ", present[x]);
+        }
+    }
+
+    size_t visited = 0;
+    set.for_each([&](const Key &) {
+        visited += 1;
+    });
+    if (visited != size) {
+        panic("ERROR: for_each() visited ", visited, " keys instead of ", size);
+    }
+}
+
+char key_names[1000][16];
+
+String_View key_name(uint32_t x)
+{
+    int n = snprintf(key_names[x], sizeof(key_names[x]), "key-%u", x);
+    return {(size_t) n, key_names[x]};
+}
+
+void test_set_operations()
+{
+    Hash_Set<uint32_t> multiples_of_2 = {};
+    defer(destroy(multiples_of_2));
+    Hash_Set<uint32_t> multiples_of_3 = {};
+    defer(destroy(multiples_of_3));
+    Hash_Set<uint32_t> empty = {};
+
+    for (uint32_t x = 0; x < 3000; x += 2) multiples_of_2.insert(x);
+    for (uint32_t x = 0; x < 300; x += 3) multiples_of_3.insert(x);
+
+    // NOTE: both orders of the arguments, the smaller one is walked either way
+    for (size_t order = 0; order < 2; ++order) {
+        const Hash_Set<uint32_t> &a = order == 0 ? multiples_of_2 : multiples_of_3;
+        const Hash_Set<uint32_t> &b = order == 0 ? multiples_of_3 : multiples_of_2;
+
+        Hash_Set<uint32_t> both = set_union(a, b);
+        defer(destroy(both));
+        Hash_Set<uint32_t> common = set_intersection(a, b);
+        defer(destroy(common));
+
+        size_t union_size = 0;
+        size_t intersection_size = 0;
+        for (uint32_t x = 0; x < 3000; ++x) {
+            const bool in_a = x % 2 == 0;
+            const bool in_b = x % 3 == 0 && x < 300;
+            union_size += in_a || in_b;
+            intersection_size += in_a && in_b;
+            if (both.contains(x) != (in_a || in_b) || common.contains(x) != (in_a && in_b)) {
+                panic("ERROR: unexpected union or intersection at ", x);
+            }
+        }
+
+        if (both.size != union_size || common.size != intersection_size) {
+            panic("ERROR: unexpected sizes of union ", both.size, " and intersection ", common.size);
+        }
+    }
+
+    Hash_Set<uint32_t> with_empty = set_union(multiples_of_3, empty);
+    defer(destroy(with_empty));
+    Hash_Set<uint32_t> none = set_intersection(empty, multiples_of_3);
+    defer(destroy(none));
+    if (with_empty.size != multiples_of_3.size || none.size != 0) {
+        panic("ERROR: unexpected union or intersection with the empty set");
+    }
+}
+
+struct Obj {
+    int id;
+};
+
+unsigned long hash(Obj *obj)
+{
+    return hash((uint32_t) (obj ? obj->id : -1));
+}
+
+// NOTE: nullptr is the niche of the pointers, so it doesn't go into
+// the slots, but it is still a valid key
+void test_niche_key()
+{
+    Obj objects[1000];
+    for (int i = 0; i < 1000; ++i) {
+        objects[i] = {i};
+    }
+
+    Hash_Set<Obj*> set = {};
+    defer(destroy(set));
+
+    if (set.contains(nullptr) || set.remove(nullptr)) {
+        panic("ERROR: an empty set is not expected to contain nullptr");
+    }
+    if (!set.insert(nullptr) || set.insert(nullptr) || set.size != 1 || !set.contains(nullptr)) {
+        panic("ERROR: nullptr is expected to be inserted exactly once");
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        set.insert(&objects[i]);
+    }
+    if (set.size != 1001 || set.resizes == 0 || !set.contains(nullptr)) {
+        panic("ERROR: nullptr is expected to survive the resizes");
+    }
+
+    Hash_Set<Obj*> copy = set.copy();
+    defer(destroy(copy));
+    size_t count = 0;
+    size_t nulls = 0;
+    copy.for_each([&](Obj *obj) {
+        count += 1;
+        nulls += obj == nullptr;
+    });
+    if (count != 1001 || nulls != 1) {
+        panic("ERROR: for_each() is expected to visit nullptr once along with the rest");
+    }
+
+    if (!set.remove(nullptr) || set.remove(nullptr) || set.contains(nullptr) || set.size != 1000) {
+        panic("ERROR: nullptr is expected to be removed exactly once");
+    }
+    for (int i = 0; i < 1000; ++i) {
+        if (!set.contains(&objects[i])) {
+            panic("ERROR: removing nullptr is not expected to lose the other keys");
+        }
+    }
+
+    Hash_Set<Obj*> only_null = {};
+    defer(destroy(only_null));
+    only_null.insert(nullptr);
+    Hash_Set<Obj*> both = set_union(copy, only_null);
+    defer(destroy(both));
+    Hash_Set<Obj*> common = set_intersection(only_null, set);
+    defer(destroy(common));
+    if (both.size != 1001 || !both.contains(nullptr) || common.size != 0) {
+        panic("ERROR: unexpected union or intersection with nullptr");
+    }
+}
+
+int main(int, char *[])
+{
+    static_assert(sizeof(Compact_Maybe<String_View>) == sizeof(String_View),
+                  "String_View keys are expected to take no extra space");
+
+    {
+        Hash_Set<uint32_t> set = {};
+        defer(destroy(set));
+        if (set.contains(69) || set.remove(69)) {
+            panic("ERROR: an empty set is not expected to have any keys");
+        }
+    }
+
+    test_against_flags<uint32_t>([](uint32_t x) { return x * 2654435761u; }, 1000);
+    test_against_flags<String_View>(key_name, 1000);
+    test_against_flags<Colliding_Key>([](uint32_t x) { return Colliding_Key {x}; }, 150);
+    test_set_operations();
+    test_niche_key();
+
+    println(stdout, "OK.");
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+int main(int, char *[])
+{
+    Interner interner = {};
+    defer(destroy(interner));
+
+    String_View text = "the quick brown fox jumps over the lazy dog the end"_sv;
+    uint32_t the = interner.intern("the"_sv);
+
+    uint32_t expected_count = 0;
+    while (text.count > 0) {
+        auto word = text.chop_word();
+        auto maybe_id = interner.find(word);
+        auto id = interner.intern(word);
+
+        if (maybe_id.has_value) {
+            if (maybe_id.unwrap != id) {
+                panic("ERROR: `", word, "` was interned as ", maybe_id.unwrap, " but got ", id);
+            }
+        } else {
+            expected_count += 1;
+        }
+
+        if (interner.view(id) != word) {
+            panic("ERROR: id ", id, " maps to `", interner.view(id), "` instead of `", word, "`");
+        }
+    }
+
+    if (interner.intern("the"_sv) != the || the != 0) {
+        panic("ERROR: `the` is expected to be the first id");
+    }
+
+    if (interner.count() != expected_count + 1) {
+        panic("ERROR: unexpected amount of interned strings. ",
+              "Expected: ", expected_count + 1, ", ",
+              "Actual: ", interner.count());
+    }
+
+    // Enough strings to grow every internal storage a couple of times
+    char buffer[32];
+    for (uint32_t i = 0; i < 10000; ++i) {
+        int n = snprintf(buffer, sizeof(buffer), "key-%u", i);
+        String_View key = {(size_t) n, buffer};
+        uint32_t id = interner.intern(key);
+        if (interner.view(id) != key) {
+            panic("ERROR: id ", id, " maps to `", interner.view(id), "` instead of `", key, "`");
+        }
+        if (interner.hash_of(id) != hash(key)) {
+            panic("ERROR: precomputed hash of `", key, "` is wrong");
+        }
+    }
+
+    for (uint32_t i = 0; i < 10000; ++i) {
+        int n = snprintf(buffer, sizeof(buffer), "key-%u", i);
+        String_View key = {(size_t) n, buffer};
+        auto id = unwrap_or_panic(interner.find(key), "ERROR: `", key, "` was not interned");
+        if (interner.view(id) != key) {
+            panic("ERROR: id ", id, " maps to `", interner.view(id), "` instead of `", key, "`");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+struct Entity_Id {
+    uint32_t index;
+};
+
+namespace aids {
+    template <>
+    struct Niche<Entity_Id> {
+        static constexpr bool exists = true;
+        static Entity_Id none() { return {UINT32_MAX}; }
+        static bool is_none(const Entity_Id &x) { return x.index == UINT32_MAX; }
+    };
+}
+
+struct Vec2 {
+    float x, y;
+};
+
+static_assert(sizeof(Compact_Maybe<int*>) == sizeof(int*));
+static_assert(sizeof(Compact_Maybe<float>) == sizeof(float));
+static_assert(sizeof(Compact_Maybe<double>) == sizeof(double));
+static_assert(sizeof(Compact_Maybe<String_View>) == sizeof(String_View));
+static_assert(sizeof(Compact_Maybe<Entity_Id>) == sizeof(Entity_Id));
+static_assert(sizeof(Compact_Maybe<Vec2>) == sizeof(Maybe<Vec2>));
+
+template <typename T>
+void test_niche(const char *name, T value)
+{
+    Compact_Maybe<T> maybe = {};
+    if (maybe.has_value()) {
+        panic("ERROR: zero initialized Compact_Maybe<", name, "> is expected to be None");
+    }
+
+    maybe.set(value);
+    if (!maybe.has_value()) {
+        panic("ERROR: Compact_Maybe<", name, "> lost its value");
+    }
+
+    Maybe<T> roundtrip = as_maybe(maybe);
+    if (!roundtrip.has_value || !as_compact_maybe(roundtrip).has_value()) {
+        panic("ERROR: Compact_Maybe<", name, "> does not convert to Maybe and back");
+    }
+
+    maybe.reset();
+    if (maybe.has_value() || as_maybe(maybe).has_value) {
+        panic("ERROR: reset Compact_Maybe<", name, "> is expected to be None");
+    }
+}
+
+int main(int, char *[])
+{
+    int x = 69;
+    test_niche("int*", &x);
+    test_niche("float", 0.0f);
+    test_niche("float", -1.5f);
+    test_niche("double", 0.0);
+    test_niche("String_View", ""_sv);
+    test_niche("String_View", "hello"_sv);
+    test_niche("Entity_Id", Entity_Id {0});
+    test_niche("Vec2", Vec2 {0.0f, 0.0f});
+
+    // Regular NaNs are still values, only the niche pattern is None
+    float nan = 0.0f;
+    nan = nan / nan;
+    test_niche("float", nan);
+    test_niche("double", (double) nan);
+
+    if (compact_some(&x).unwrap() != &x) {
+        panic("ERROR: compact_some() does not keep the pointer");
+    }
+
+    if (unwrap_or_panic(compact_some("foo"_sv), "ERROR: compact_some() is None") != "foo"_sv) {
+        panic("ERROR: compact_some() does not keep the view");
+    }
+
+    Compact_Maybe<Entity_Id> entities[4] = {};
+    entities[2].set({2});
+    for (size_t i = 0; i < 4; ++i) {
+        if (entities[i].has_value() != (i == 2)) {
+            panic("ERROR: only the third entity is expected to be set");
+        }
+    }
+
+    String_Buffer buffer = {};
+    char data[64];
+    buffer.capacity = sizeof(data);
+    buffer.data = data;
+    sprint(&buffer, compact_some("foo"_sv), " ", Compact_Maybe<String_View> {});
+    if (buffer.view() != "Some(foo) None"_sv) {
+        panic("ERROR: unexpected Compact_Maybe print: ", buffer.view());
+    }
+
+    println(stdout, "OK.");
+
+    return 0;
+}
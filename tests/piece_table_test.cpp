@@ -0,0 +1,131 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+const size_t TEXT_CAPACITY = 1024 * 1024;
+char expected_text[TEXT_CAPACITY];
+size_t expected_count = 0;
+
+char actual_text[TEXT_CAPACITY];
+size_t actual_count = 0;
+
+uint32_t random_state = 69;
+
+uint32_t random_u32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+void check(const Piece_Table &table, int step)
+{
+    actual_count = 0;
+    table.for_each_piece([](String_View piece) {
+        memcpy(actual_text + actual_count, piece.data, piece.count);
+        actual_count += piece.count;
+    });
+
+    String_View expected = {expected_count, expected_text};
+    String_View actual = {actual_count, actual_text};
+    if (expected != actual || table.count() != expected_count) {
+        panic("FAILED: step ", step, ": the content of the Piece_Table is not what was expected");
+    }
+
+    size_t line = 0;
+    for (size_t i = 0; i <= expected_count; ++i) {
+        if (table.line_of(i) != line) {
+            panic("FAILED: step ", step, ": line_of(", i, ") is ", table.line_of(i), " but expected ", line);
+        }
+
+        if (i == 0 || expected_text[i - 1] == '\n') {
+            auto start = table.line_start(line);
+            if (!start.has_value || start.unwrap != i) {
+                panic("FAILED: step ", step, ": line_start(", line, ") is ", start, " but expected ", i);
+            }
+        }
+
+        if (i < expected_count && expected_text[i] == '\n') {
+            line += 1;
+        }
+    }
+
+    if (table.lines_count() != line + 1) {
+        panic("FAILED: step ", step, ": lines_count() is ", table.lines_count(), " but expected ", line + 1);
+    }
+
+    if (table.line_start(line + 1).has_value) {
+        panic("FAILED: step ", step, ": line_start() past the last line is expected to fail");
+    }
+}
+
+int main(int, char *[])
+{
+    // Original buffer bigger than a single piece
+    static char original[3 * Piece_Table::PIECE_TABLE_MAX_PIECE_SIZE + 69];
+    for (size_t i = 0; i < sizeof(original); ++i) {
+        original[i] = random_u32() % 16 == 0 ? '\n' : (char) ('a' + random_u32() % 26);
+    }
+    memcpy(expected_text, original, sizeof(original));
+    expected_count = sizeof(original);
+
+    Piece_Table table = piece_table_of({sizeof(original), original});
+    defer(destroy(table));
+    check(table, 0);
+
+    const char *alphabet = "abc\ndef\n\nxyz";
+    char insertion[128];
+
+    for (int step = 1; step <= 500; ++step) {
+        if (random_u32() % 3 != 0) {
+            size_t position = random_u32() % (expected_count + 1);
+            size_t count = random_u32() % sizeof(insertion);
+            for (size_t i = 0; i < count; ++i) {
+                insertion[i] = alphabet[random_u32() % strlen(alphabet)];
+            }
+
+            memmove(expected_text + position + count, expected_text + position, expected_count - position);
+            memcpy(expected_text + position, insertion, count);
+            expected_count += count;
+
+            table.insert(position, {count, insertion});
+        } else {
+            size_t position = random_u32() % (expected_count + 1);
+            size_t count = min((size_t) (random_u32() % 256), expected_count - position);
+
+            memmove(expected_text + position, expected_text + position + count, expected_count - position - count);
+            expected_count -= count;
+
+            table.remove(position, count);
+        }
+
+        if (step % 25 == 0) {
+            check(table, step);
+        }
+    }
+
+    // Typing character by character must not fragment the table
+    {
+        Piece_Table typed = {};
+        defer(destroy(typed));
+        String_View text = "Hello, World\nThis is typed character by character\n"_sv;
+        for (size_t i = 0; i < text.count; ++i) {
+            typed.insert(i, text.subview(i, 1));
+        }
+
+        size_t pieces = 0;
+        typed.for_each_piece([&pieces](String_View) {
+            pieces += 1;
+        });
+
+        if (pieces != 1) {
+            panic("FAILED: typing produced ", pieces, " pieces instead of 1");
+        }
+    }
+
+    println(stdout, "OK.");
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+#define AIDS_THREADS
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+#include <climits>
+
+using namespace aids;
+
+struct Vec2 {
+    int x, y;
+};
+
+void print1(Print_Buffer *buffer, Vec2 v)
+{
+    print(buffer, "(", v.x, ", ", v.y, ")");
+}
+
+// NOTE: only printable through the FILE*
+struct Legacy {
+    int x;
+};
+
+void print1(FILE *stream, Legacy legacy)
+{
+    fprintf(stream, "<%d>", legacy.x);
+}
+
+String_View read_back(FILE *file, char *data, size_t capacity)
+{
+    fflush(file);
+    rewind(file);
+    size_t size = fread(data, 1, capacity, file);
+    return {size, data};
+}
+
+template <typename ... Types>
+void expect_println(String_View expected, Types... args)
+{
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+        panic("ERROR: could not create a temporary file: ", strerror(errno));
+    }
+    defer(fclose(file));
+
+    println(file, args...);
+
+    static char data[64 * 1024];
+    String_View actual = read_back(file, data, sizeof(data));
+    if (actual != expected) {
+        panic("ERROR: unexpected output.\n",
+              "Expected: `", Escape {expected}, "`\n",
+              "Actual:   `", Escape {actual}, "`");
+    }
+}
+
+void test_formatting()
+{
+    expect_println("69 -420 true c foo bar\n"_sv,
+                   69, " ", -420, " ", true, " ", 'c', " ", "foo", " ", "bar"_sv);
+    expect_println("-2147483648 2147483647 4294967295\n"_sv, INT_MIN, " ", INT_MAX, " ", UINT_MAX);
+    expect_println("-9223372036854775808 18446744073709551615 0\n"_sv,
+                   (long int) LLONG_MIN, " ", ULLONG_MAX, " ", 0u);
+    expect_println("1.500000 -0.250000\n"_sv, 1.5f, " ", -0.25f);
+    expect_println("Some(69) None Some(foo)\n"_sv,
+                   some(69), " ", Maybe<int> {}, " ", compact_some("foo"_sv));
+    expect_println("(1, 2) <3> Some((4, 5)) Some(<6>)\n"_sv,
+                   Vec2 {1, 2}, " ", Legacy {3}, " ", some(Vec2 {4, 5}), " ", some(Legacy {6}));
+    expect_println("a\\nb\\t  --\n"_sv, Escape {"a\nb\t"_sv}, Pad {2, ' '}, Pad {2, '-'});
+    expect_println("3.14 [   -2.500] 100\n"_sv,
+                   Fixed {3.14159, 2}, " [", Fixed {-2.5, 3, 9}, "] ", Fixed {99.5, 0});
+
+    char expected[4096];
+    memset(expected, 'x', sizeof(expected));
+    expected[sizeof(expected) - 1] = '\n';
+    expect_println(String_View {sizeof(expected), expected}, "x"_sv, Pad {sizeof(expected) - 3, 'x'}, 'x');
+}
+
+// NOTE: byte by byte reference implementations to check the bulk ones against
+void naive_escape(String_View input, Dynamic_Array<char> *output)
+{
+    for (size_t i = 0; i < input.count; ++i) {
+        const char c = input.data[i];
+        switch (c) {
+        case '\a': output->push('\\'); output->push('a'); break;
+        case '\b': output->push('\\'); output->push('b'); break;
+        case '\f': output->push('\\'); output->push('f'); break;
+        case '\n': output->push('\\'); output->push('n'); break;
+        case '\r': output->push('\\'); output->push('r'); break;
+        case '\t': output->push('\\'); output->push('t'); break;
+        case '\v': output->push('\\'); output->push('v'); break;
+        default: output->push(c);
+        }
+    }
+}
+
+void naive_json_escape(String_View input, Dynamic_Array<char> *output)
+{
+    for (size_t i = 0; i < input.count; ++i) {
+        const uint8_t c = (uint8_t) input.data[i];
+        switch (c) {
+        case '"': output->push('\\'); output->push('"'); break;
+        case '\\': output->push('\\'); output->push('\\'); break;
+        case '\b': output->push('\\'); output->push('b'); break;
+        case '\f': output->push('\\'); output->push('f'); break;
+        case '\n': output->push('\\'); output->push('n'); break;
+        case '\r': output->push('\\'); output->push('r'); break;
+        case '\t': output->push('\\'); output->push('t'); break;
+        default:
+            if (c < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                output->concat(escaped, 6);
+            } else {
+                output->push((char) c);
+            }
+        }
+    }
+}
+
+void test_escaping()
+{
+    expect_println("\\a\\b\\t\\n\\v\\f\\r\x06\x0e\"\\\n"_sv,
+                   Escape {"\a\b\t\n\v\f\r\x06\x0e\"\\"_sv});
+    expect_println("say \\\"hi\\\"\\\\\\n\\t\\u0000\\u001f\\r\\b\\f \x7f\xc3\xa9\n"_sv,
+                   Json_Escape {String_View {20, "say \"hi\"\\\n\t\0\x1f\r\b\f \x7f\xc3\xa9"}});
+
+    // Long inputs with the special bytes on both sides of every block boundary
+    const size_t COUNT = 1000;
+    char input[COUNT];
+    for (size_t special = 0; special < 256; special += 1) {
+        for (size_t i = 0; i < COUNT; ++i) {
+            input[i] = (char) ('a' + i % 26);
+        }
+        for (size_t i = 15; i < COUNT; i += 16) {
+            if (i % 3 != 0) input[i] = (char) special;
+            if (i % 5 != 0) input[i + 1 < COUNT ? i + 1 : i] = (char) special;
+        }
+        input[COUNT - 1] = (char) special;
+        String_View view = {COUNT, input};
+
+        Dynamic_Array<char> expected = {};
+        defer(destroy(expected));
+
+        naive_escape(view, &expected);
+        expected.push('\n');
+        expect_println(String_View {expected.size, expected.data}, Escape {view});
+
+        expected.size = 0;
+        naive_json_escape(view, &expected);
+        expected.push('\n');
+        expect_println(String_View {expected.size, expected.data}, Json_Escape {view});
+    }
+}
+
+void test_lines_are_not_interleaved()
+{
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+        panic("ERROR: could not create a temporary file: ", strerror(errno));
+    }
+    defer(fclose(file));
+
+    const size_t THREADS = 4;
+    const size_t LINES = 1000;
+
+    Thread_Pool pool = thread_pool_of(THREADS);
+    defer(destroy(pool));
+
+    parallel_for(pool, 0, THREADS, 1, [&](size_t begin, size_t end) {
+        for (size_t thread = begin; thread < end; ++thread) {
+            for (size_t i = 0; i < LINES; ++i) {
+                println(file, "thread ", thread, " line ", i, " ", Legacy {(int) i}, " end");
+            }
+        }
+    });
+
+    static char data[1024 * 1024];
+    String_View output = read_back(file, data, sizeof(data));
+    size_t lines = 0;
+    while (output.count > 0) {
+        String_View line = output.chop_by_delim('\n');
+        String_View words = line;
+        if (words.chop_word() != "thread"_sv) panic("ERROR: broken line `", line, "`");
+        words.chop_word();
+        if (words.chop_word() != "line"_sv) panic("ERROR: broken line `", line, "`");
+        String_View i = words.chop_word();
+        String_View legacy = words.chop_word();
+        if (legacy.count != i.count + 2 || legacy.subview(1, i.count) != i) {
+            panic("ERROR: broken line `", line, "`");
+        }
+        if (words.chop_word() != "end"_sv || words.count != 0) panic("ERROR: broken line `", line, "`");
+        lines += 1;
+    }
+
+    if (lines != THREADS * LINES) {
+        panic("ERROR: expected ", THREADS * LINES, " lines but got ", lines);
+    }
+}
+
+int main(int, char *[])
+{
+    test_formatting();
+    test_escaping();
+    test_lines_are_not_interleaved();
+
+    println(stdout, "OK.");
+
+    return 0;
+}
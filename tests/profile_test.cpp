@@ -0,0 +1,222 @@
+#define AIDS_PROFILE
+// NOTE: small enough to overflow the ring buffer of a thread quickly
+#define AIDS_PROFILE_CAPACITY 64
+#define AIDS_THREADS
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+// NOTE: the profile is global and can't be reset, so the tests below
+// run in order and every one of them accounts for the zones recorded
+// by the previous ones.
+
+Maybe<size_t> find(String_View haystack, String_View needle)
+{
+    for (size_t i = 0; i + needle.count <= haystack.count; ++i) {
+        if (haystack.subview(i, needle.count) == needle) {
+            return some(i);
+        }
+    }
+    return {};
+}
+
+String_View dump(void (*dump_to)(FILE *stream))
+{
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+        panic("ERROR: could not create a temporary file: ", strerror(errno));
+    }
+    defer(fclose(file));
+
+    dump_to(file);
+
+    static char data[64 * 1024];
+    fflush(file);
+    rewind(file);
+    return {fread(data, 1, sizeof(data), file), data};
+}
+
+void zone_with_quotes()
+{
+    AIDS_PROFILE_ZONE("say \"hi\" to C:\\path\tnow");
+}
+
+void test_json_escape()
+{
+    zone_with_quotes();
+
+    String_View trace = dump(profile_dump_chrome_trace);
+
+    // NOTE: the zone name has to be a valid JSON string, JSON has no
+    // \a and \v escapes and quotes and backslashes have to be escaped
+    if (!find(trace, "\"name\":\"say \\\"hi\\\" to C:\\\\path\\tnow\","_sv).has_value) {
+        panic("ERROR: the zone name is not escaped as a JSON string:\n", trace);
+    }
+}
+
+void busy_wait(uint64_t nanos)
+{
+    const uint64_t begin = profile_now();
+    while (profile_now() - begin < nanos) {}
+}
+
+struct Summary_Row {
+    uint64_t count;
+    uint64_t total;
+    uint64_t mean;
+    uint64_t min;
+    uint64_t max;
+};
+
+// NOTE: the row of name and its position among the rows
+Maybe<Summary_Row> summary_row(String_View summary, String_View name, size_t *position)
+{
+    summary.chop_by_delim('\n');
+    for (size_t row = 0; summary.count > 0; ++row) {
+        String_View line = summary.chop_by_delim('\n');
+        if (line.chop_word() != name) {
+            continue;
+        }
+
+        uint64_t columns[5] = {};
+        for (size_t i = 0; i < 5; ++i) {
+            line = line.trim_begin();
+            columns[i] = unwrap_or_panic(line.chop_word().as_integer<uint64_t>(),
+                                         "ERROR: unexpected summary row of `", name, "`");
+        }
+        *position = row;
+        return some(Summary_Row {columns[0], columns[1], columns[2], columns[3], columns[4]});
+    }
+    return {};
+}
+
+void test_summary()
+{
+    const uint64_t SLOW_NANOS = 2000000;
+    for (int i = 0; i < 3; ++i) {
+        AIDS_PROFILE_ZONE("fast");
+    }
+    for (int i = 0; i < 2; ++i) {
+        AIDS_PROFILE_ZONE("slow");
+        busy_wait(SLOW_NANOS);
+    }
+
+    String_View summary = dump(profile_dump_summary);
+
+    size_t slow_position = 0;
+    size_t fast_position = 0;
+    Summary_Row slow = unwrap_or_panic(summary_row(summary, "slow"_sv, &slow_position),
+                                       "ERROR: no `slow` zone in the summary:\n", summary);
+    Summary_Row fast = unwrap_or_panic(summary_row(summary, "fast"_sv, &fast_position),
+                                       "ERROR: no `fast` zone in the summary:\n", summary);
+
+    if (slow.count != 2 || fast.count != 3) {
+        panic("ERROR: the zones are expected to be grouped by name:\n", summary);
+    }
+    if (slow.min < SLOW_NANOS || slow.min > slow.max || slow.total < slow.min + slow.max ||
+            slow.mean != slow.total / slow.count || fast.min > fast.max) {
+        panic("ERROR: unexpected durations of the zones:\n", summary);
+    }
+    if (slow_position >= fast_position) {
+        panic("ERROR: the zones are expected to be sorted by the total time:\n", summary);
+    }
+    if (find(summary, "overwritten"_sv).has_value) {
+        panic("ERROR: no zones are expected to be overwritten yet:\n", summary);
+    }
+}
+
+// NOTE: the chunks wait for each other, so each of the threads of
+// the pool records exactly one zone
+void test_threads()
+{
+    Thread_Pool pool = thread_pool_of(2);
+    defer(destroy(pool));
+
+    std::atomic<uint32_t> arrived = {0};
+    parallel_for(pool, 0, 2, 1, [&](size_t, size_t) {
+        AIDS_PROFILE_ZONE("parallel");
+        arrived.fetch_add(1);
+        while (arrived.load() < 2) {}
+    });
+
+    String_View trace = dump(profile_dump_chrome_trace);
+
+    uint64_t tids[2] = {};
+    size_t found = 0;
+    while (trace.count > 0) {
+        String_View line = trace.chop_by_delim('\n');
+        if (!find(line, "\"name\":\"parallel\""_sv).has_value) {
+            continue;
+        }
+        if (found == 2) {
+            panic("ERROR: too many `parallel` zones:\n", trace);
+        }
+
+        const String_View TID = "\"tid\":"_sv;
+        size_t tid = unwrap_or_panic(find(line, TID), "ERROR: no tid in `", line, "`");
+        line.chop_left(tid + TID.count);
+        tids[found++] = unwrap_or_panic(line.chop_by_delim('}').as_integer<uint64_t>(),
+                                        "ERROR: unexpected tid in `", line, "`");
+    }
+
+    if (found != 2 || tids[0] == tids[1]) {
+        panic("ERROR: the zones of the two threads are expected to have different tids");
+    }
+}
+
+// NOTE: the main thread recorded 1 + 3 + 2 + 1 zones by now, the
+// worker of test_threads() recorded its 1 into its own buffer
+void test_overwrite()
+{
+    const size_t TICKS = 100;
+    for (size_t i = 0; i < TICKS; ++i) {
+        AIDS_PROFILE_ZONE("tick");
+    }
+
+    String_View summary = dump(profile_dump_summary);
+
+    size_t position = 0;
+    Summary_Row tick = unwrap_or_panic(summary_row(summary, "tick"_sv, &position),
+                                       "ERROR: no `tick` zone in the summary:\n", summary);
+    if (tick.count != AIDS_PROFILE_CAPACITY) {
+        panic("ERROR: only the newest ", AIDS_PROFILE_CAPACITY, " zones of a thread are expected to be kept:\n", summary);
+    }
+    if (summary_row(summary, "slow"_sv, &position).has_value ||
+            summary_row(summary, "fast"_sv, &position).has_value) {
+        panic("ERROR: the oldest zones are expected to be overwritten:\n", summary);
+    }
+    Maybe<Summary_Row> parallel = summary_row(summary, "parallel"_sv, &position);
+    if (!parallel.has_value || parallel.unwrap.count != 1) {
+        panic("ERROR: the zones of the other threads are not expected to be overwritten:\n", summary);
+    }
+
+    const size_t dropped = 1 + 3 + 2 + 1 + TICKS - AIDS_PROFILE_CAPACITY;
+    char expected[128];
+    String_Buffer buffer = {sizeof(expected), expected, 0};
+    sprint(&buffer, "(", dropped, " oldest zones were overwritten and are not included)");
+    if (!find(summary, buffer.view()).has_value) {
+        panic("ERROR: expected `", buffer.view(), "` in the summary:\n", summary);
+    }
+
+    String_View trace = dump(profile_dump_chrome_trace);
+    size_t ticks = 0;
+    while (trace.count > 0) {
+        ticks += find(trace.chop_by_delim('\n'), "\"name\":\"tick\""_sv).has_value;
+    }
+    if (ticks != AIDS_PROFILE_CAPACITY) {
+        panic("ERROR: the trace is expected to have the newest ", AIDS_PROFILE_CAPACITY, " ticks, got ", ticks);
+    }
+}
+
+int main(int, char *[])
+{
+    test_json_escape();
+    test_summary();
+    test_threads();
+    test_overwrite();
+
+    println(stdout, "OK.");
+
+    return 0;
+}
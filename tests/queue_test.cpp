@@ -0,0 +1,154 @@
+#define AIDS_THREADS
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+template <typename Queue>
+void test_single_thread(Queue *queue, const char *name)
+{
+    // NOTE: a couple of laps around the ring
+    uint32_t next_push = 0;
+    uint32_t next_pop = 0;
+    for (int lap = 0; lap < 5; ++lap) {
+        while (queue->push(next_push)) {
+            next_push += 1;
+        }
+
+        if (next_push - next_pop != 16) {
+            panic("ERROR: ", name, " accepted ", next_push - next_pop, " items instead of 16");
+        }
+
+        uint32_t items[5];
+        size_t n = queue->pop_many(items, 5);
+        for (size_t i = 0; i < n; ++i) {
+            if (items[i] != next_pop++) {
+                panic("ERROR: ", name, " popped ", items[i], " out of order");
+            }
+        }
+
+        while (true) {
+            Maybe<uint32_t> item = queue->pop();
+            if (!item.has_value) {
+                break;
+            }
+            if (item.unwrap != next_pop++) {
+                panic("ERROR: ", name, " popped ", item.unwrap, " out of order");
+            }
+        }
+
+        if (next_pop != next_push) {
+            panic("ERROR: ", name, " lost items");
+        }
+
+        uint32_t batch[20];
+        for (size_t i = 0; i < 20; ++i) {
+            batch[i] = next_push + (uint32_t) i;
+        }
+        if (queue->push_many(batch, 20) != 16) {
+            panic("ERROR: ", name, " push_many() has to stop when the queue is full");
+        }
+        next_push += 16;
+
+        while (queue->pop_many(items, 5) > 0) {}
+        next_pop = next_push;
+    }
+}
+
+SPSC_Queue<uint32_t, 16> spsc_small = {};
+MPMC_Queue<uint32_t, 16> mpmc_small = {};
+
+const uint32_t ITEMS_PER_PRODUCER = 100000;
+
+Blocking_Queue<SPSC_Queue<uint32_t, 64>> spsc = {};
+
+void test_spsc(Thread_Pool pool)
+{
+    parallel_for(pool, 0, 2, 1, [](size_t begin, size_t end) {
+        for (size_t role = begin; role < end; ++role) {
+            if (role == 0) {
+                for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+                    spsc.push(i);
+                }
+                spsc.close();
+            } else {
+                uint32_t expected = 0;
+                while (true) {
+                    Maybe<uint32_t> item = spsc.pop();
+                    if (!item.has_value) break;
+                    if (item.unwrap != expected++) {
+                        panic("ERROR: SPSC_Queue delivered ", item.unwrap, " out of order");
+                    }
+                }
+                if (expected != ITEMS_PER_PRODUCER) {
+                    panic("ERROR: SPSC_Queue delivered ", expected, " items");
+                }
+            }
+        }
+    });
+}
+
+const size_t PRODUCERS = 3;
+const size_t CONSUMERS = 3;
+
+Blocking_Queue<MPMC_Queue<uint32_t, 64>> mpmc = {};
+std::atomic<uint32_t> producers_left = {PRODUCERS};
+std::atomic<uint64_t> consumed_sum = {0};
+std::atomic<uint64_t> consumed_count = {0};
+
+void test_mpmc(Thread_Pool pool)
+{
+    parallel_for(pool, 0, PRODUCERS + CONSUMERS, 1, [](size_t begin, size_t end) {
+        for (size_t role = begin; role < end; ++role) {
+            if (role < PRODUCERS) {
+                // NOTE: the items encode the producer in the top bits
+                for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+                    mpmc.push((uint32_t) (role << 24) | i);
+                }
+                if (producers_left.fetch_sub(1) == 1) {
+                    mpmc.close();
+                }
+            } else {
+                uint32_t last[PRODUCERS] = {};
+                bool seen[PRODUCERS] = {};
+                while (true) {
+                    Maybe<uint32_t> item = mpmc.pop();
+                    if (!item.has_value) break;
+
+                    const uint32_t producer = item.unwrap >> 24;
+                    const uint32_t index = item.unwrap & 0xFFFFFF;
+                    if (seen[producer] && index <= last[producer]) {
+                        panic("ERROR: MPMC_Queue reordered the items of producer ", producer);
+                    }
+                    seen[producer] = true;
+                    last[producer] = index;
+
+                    consumed_sum.fetch_add(index);
+                    consumed_count.fetch_add(1);
+                }
+            }
+        }
+    });
+
+    const uint64_t n = ITEMS_PER_PRODUCER;
+    if (consumed_count.load() != PRODUCERS * n ||
+            consumed_sum.load() != PRODUCERS * n * (n - 1) / 2) {
+        panic("ERROR: MPMC_Queue delivered ", (unsigned long long) consumed_count.load(), " items");
+    }
+}
+
+int main(int, char *[])
+{
+    test_single_thread(&spsc_small, "SPSC_Queue");
+    test_single_thread(&mpmc_small, "MPMC_Queue");
+
+    Thread_Pool pool = thread_pool_of(PRODUCERS + CONSUMERS);
+    defer(destroy(pool));
+
+    test_spsc(pool);
+    test_mpmc(pool);
+
+    println(stdout, "OK.");
+
+    return 0;
+}
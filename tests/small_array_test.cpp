@@ -0,0 +1,89 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+struct Counting_Ator {
+    size_t allocs;
+    size_t deallocs;
+
+    template <typename T>
+    T *alloc(size_t count, T def = {})
+    {
+        allocs += 1;
+        return mtor.alloc<T>(count, def);
+    }
+
+    template <typename T>
+    void dealloc(T *ptr, size_t count)
+    {
+        deallocs += 1;
+        mtor.dealloc(ptr, count);
+    }
+};
+
+void expect_items(const Small_Array<int, 4, Counting_Ator> &xs, int count, const char *context)
+{
+    if (xs.size != (size_t) count) {
+        panic("ERROR: ", context, ": expected ", count, " items, got ", xs.size);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (xs[i] != i) {
+            panic("ERROR: ", context, ": item ", i, " is ", xs[i]);
+        }
+    }
+}
+
+int main(int, char *[])
+{
+    Counting_Ator ator = {};
+
+    Small_Array<int, 4, Counting_Ator> xs = {};
+    for (int i = 0; i < 4; ++i) {
+        xs.push(i, &ator);
+    }
+    expect_items(xs, 4, "inline");
+    if (!xs.is_inline() || ator.allocs != 0) {
+        panic("ERROR: Small_Array allocated before going beyond its inline capacity");
+    }
+
+    // NOTE: the copy of an inline array owns its own elements
+    Small_Array<int, 4, Counting_Ator> copy = xs;
+    copy[0] = 420;
+    if (xs[0] != 0 || !xs.contains(3) || xs.contains(420)) {
+        panic("ERROR: the copy of an inline Small_Array shares its elements");
+    }
+
+    xs.push(4, &ator);
+    expect_items(xs, 5, "spilled");
+    if (xs.is_inline() || ator.allocs != 1) {
+        panic("ERROR: Small_Array has to spill exactly once");
+    }
+
+    int more[100];
+    for (int i = 0; i < 100; ++i) {
+        more[i] = 5 + i;
+    }
+    xs.concat(more, 100, &ator);
+    expect_items(xs, 105, "concat");
+    if (ator.allocs != 2 || ator.deallocs != 1) {
+        panic("ERROR: Small_Array::concat() has to grow once per batch");
+    }
+
+    destroy(xs, &ator);
+    if (ator.allocs != ator.deallocs) {
+        panic("ERROR: Small_Array leaked ", ator.allocs - ator.deallocs, " blocks");
+    }
+
+    Small_Array<int, 4, Counting_Ator> ys = {};
+    ys.concat(more, 3, &ator);
+    ys.concat(more + 3, 1, &ator);
+    if (!ys.is_inline() || ys.size != 4 || ys[3] != 8) {
+        panic("ERROR: Small_Array::concat() has to stay inline while it fits");
+    }
+
+    println(stdout, "OK.");
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+uint32_t random_state = 69;
+
+uint32_t random_u32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+struct Record {
+    int key;
+    size_t index;
+};
+
+// NOTE: the inputs that tend to break quicksort pivots and merges
+void generate(int *data, size_t count, int pattern)
+{
+    for (size_t i = 0; i < count; ++i) {
+        switch (pattern) {
+        case 0: data[i] = (int) random_u32(); break;
+        case 1: data[i] = (int) i; break;
+        case 2: data[i] = (int) (count - i); break;
+        case 3: data[i] = 42; break;
+        case 4: data[i] = (int) (random_u32() % 4) - 2; break;
+        case 5: data[i] = (int) min(i, count - i); break;
+        default: UNREACHABLE("pattern");
+        }
+    }
+}
+
+const int PATTERNS_COUNT = 6;
+
+template <typename F>
+void test_sort_ints(const char *name, F f)
+{
+    const size_t sizes[] = {0, 1, 2, 3, 15, 16, 17, 33, 100, 1000, 100000};
+
+    for (size_t size : sizes) {
+        for (int pattern = 0; pattern < PATTERNS_COUNT; ++pattern) {
+            int *data = mtor.alloc<int>(size);
+            defer(mtor.dealloc(data, size));
+            generate(data, size, pattern);
+
+            long long sum = 0;
+            for (size_t i = 0; i < size; ++i) sum += data[i];
+
+            f(data, size);
+
+            for (size_t i = 0; i < size; ++i) {
+                sum -= data[i];
+                if (i > 0 && data[i] < data[i - 1]) {
+                    panic("ERROR: ", name, " did not sort ", size,
+                          " elements of pattern ", pattern, " at ", i);
+                }
+            }
+
+            if (sum != 0) {
+                panic("ERROR: ", name, " lost elements of pattern ", pattern);
+            }
+        }
+    }
+}
+
+template <typename F>
+void test_stability(const char *name, F f)
+{
+    const size_t N = 10000;
+    Dynamic_Array<Record> records = {};
+    defer(destroy(records));
+    for (size_t i = 0; i < N; ++i) {
+        records.push({(int) (random_u32() % 100) - 50, i});
+    }
+
+    f(&records);
+
+    for (size_t i = 1; i < N; ++i) {
+        const Record &a = records[i - 1];
+        const Record &b = records[i];
+        if (a.key > b.key || (a.key == b.key && a.index > b.index)) {
+            panic("ERROR: ", name, " is not stable at ", i);
+        }
+    }
+}
+
+void test_msd_radix_sort()
+{
+    const size_t N = 20000;
+    const char alphabet[] = {'a', 'b', '\x80', '\xFF'};
+
+    Dynamic_Array<String_View> views = {};
+    defer(destroy(views));
+    char *buffer = mtor.alloc<char>(N * 8);
+    defer(mtor.dealloc(buffer, N * 8));
+
+    for (size_t i = 0; i < N; ++i) {
+        char *data = buffer + i * 8;
+        size_t count = random_u32() % 8;
+        for (size_t j = 0; j < count; ++j) {
+            data[j] = alphabet[random_u32() % sizeof(alphabet)];
+        }
+        views.push({count, data});
+    }
+
+    Dynamic_Array<String_View> expected = {};
+    defer(destroy(expected));
+    expected.concat(views.data, views.size);
+
+    stable_sort(&expected);
+    radix_sort(views.data, views.size);
+
+    for (size_t i = 0; i < N; ++i) {
+        // NOTE: the equal views have to keep their order as well
+        if (views[i].data != expected[i].data) {
+            panic("ERROR: radix_sort() of String_Views differs at ", i, ": `",
+                  views[i], "` vs `", expected[i], "`");
+        }
+    }
+}
+
+void test_bounds()
+{
+    const int data[] = {1, 2, 2, 2, 5, 7, 7, 9};
+    const size_t count = sizeof(data) / sizeof(data[0]);
+
+    for (int value = 0; value <= 10; ++value) {
+        size_t expected_lower = 0;
+        while (expected_lower < count && data[expected_lower] < value) expected_lower += 1;
+        size_t expected_upper = expected_lower;
+        while (expected_upper < count && data[expected_upper] <= value) expected_upper += 1;
+
+        if (lower_bound(data, count, value) != expected_lower) {
+            panic("ERROR: lower_bound(", value, ") is ", lower_bound(data, count, value),
+                  ", expected ", expected_lower);
+        }
+
+        if (upper_bound(data, count, value) != expected_upper) {
+            panic("ERROR: upper_bound(", value, ") is ", upper_bound(data, count, value),
+                  ", expected ", expected_upper);
+        }
+    }
+
+    if (lower_bound(data, 0, 5) != 0 || upper_bound(data, 0, 5) != 0) {
+        panic("ERROR: bounds of an empty array have to be 0");
+    }
+}
+
+int main(int, char *[])
+{
+    test_sort_ints("sort()", [](int *data, size_t count) {
+        sort(data, count);
+    });
+    test_sort_ints("sort() with less", [](int *data, size_t count) {
+        sort(data, count, [](int a, int b) {
+            return a > b;
+        });
+        for (size_t i = 0; i < count / 2; ++i) {
+            swap(&data[i], &data[count - i - 1]);
+        }
+    });
+    test_sort_ints("stable_sort()", [](int *data, size_t count) {
+        stable_sort(data, count);
+    });
+    test_sort_ints("radix_sort()", [](int *data, size_t count) {
+        radix_sort(data, count);
+    });
+
+    test_stability("stable_sort()", [](Dynamic_Array<Record> *records) {
+        stable_sort(records, [](const Record &a, const Record &b) {
+            return a.key < b.key;
+        });
+    });
+    test_stability("radix_sort()", [](Dynamic_Array<Record> *records) {
+        radix_sort(records, [](const Record &record) {
+            return Radix_Key<int> {}(record.key);
+        });
+    });
+
+    test_msd_radix_sort();
+    test_bounds();
+
+    println(stdout, "OK.");
+
+    return 0;
+}
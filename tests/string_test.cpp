@@ -0,0 +1,107 @@
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+#define ASSERT_EQ(expected_expr, actual_expr)              \
+    do {                                                   \
+        const auto expected = (expected_expr);             \
+        const auto actual = (actual_expr);                 \
+        if (expected != actual) {                          \
+            println(stderr, __FILE__, ":", __LINE__,       \
+                    ": ASSERTION FAILED! ",                \
+                    #expected_expr, " == ", #actual_expr); \
+            println(stderr, "  Expected: ", expected);     \
+            println(stderr, "  Actual:   ", actual);       \
+            exit(1);                                       \
+        }                                                  \
+    } while(0)
+
+int main(int, char *[])
+{
+    static_assert(sizeof(String<>) == 24, "String<> is expected to be 24 bytes on 64-bit targets");
+
+    // Zero-initialized String
+    {
+        String<> s = {};
+        defer(destroy(s));
+        ASSERT_EQ((size_t) 0, s.count());
+        ASSERT_EQ(""_sv, s.view());
+    }
+    // Small String
+    {
+        String<> s = {};
+        defer(destroy(s));
+        s.append("Hello"_sv);
+        s.push(',');
+        s.append(" World"_sv);
+        ASSERT_EQ(true, s.is_small());
+        ASSERT_EQ("Hello, World"_sv, s.view());
+        ASSERT_EQ('W', s[7]);
+    }
+    // Small String at full capacity
+    {
+        String<> s = "0123456789abcdefghijklm"_sv.as_string();
+        defer(destroy(s));
+        ASSERT_EQ(String<>::SMALL_CAPACITY, s.count());
+        ASSERT_EQ(true, s.is_small());
+        ASSERT_EQ("0123456789abcdefghijklm"_sv, s.view());
+    }
+    // Spill from small to large
+    {
+        String<> s = "0123456789abcdefghijklm"_sv.as_string();
+        defer(destroy(s));
+        s.push('n');
+        ASSERT_EQ(false, s.is_small());
+        ASSERT_EQ("0123456789abcdefghijklmn"_sv, s.view());
+
+        for (int i = 0; i < 100; ++i) {
+            s.push('x');
+        }
+        ASSERT_EQ((size_t) 124, s.count());
+        ASSERT_EQ(true, s.view().has_prefix("0123456789abcdefghijklmnxxx"_sv));
+    }
+    // Appending a String to itself
+    {
+        String<> s = "0123456789"_sv.as_string();
+        defer(destroy(s));
+        s.append(s.view());
+        ASSERT_EQ("01234567890123456789"_sv, s.view());
+        s.append(s.view());
+        ASSERT_EQ("0123456789012345678901234567890123456789"_sv, s.view());
+    }
+    // clear() keeps the capacity
+    {
+        String<> s = {};
+        defer(destroy(s));
+        s.reserve(100);
+        size_t capacity = s.capacity();
+        s.append("foo"_sv);
+        s.clear();
+        ASSERT_EQ((size_t) 0, s.count());
+        ASSERT_EQ(capacity, s.capacity());
+    }
+    // copy() and comparison
+    {
+        String<> a = "The quick brown fox jumps over the lazy dog"_sv.as_string();
+        defer(destroy(a));
+        String<> b = a.copy();
+        defer(destroy(b));
+        ASSERT_EQ(true, a == b);
+        ASSERT_EQ(true, a.view().data != b.view().data);
+        b.push('!');
+        ASSERT_EQ(true, a != b);
+    }
+    // String as a Hash_Map key
+    {
+        Hash_Map<String<>, int> map = {};
+        defer(destroy(map));
+        String<> key = "key"_sv.as_string();
+        defer(destroy(key));
+        map.insert(key, 42);
+        ASSERT_EQ(true, map.contains(key));
+        ASSERT_EQ(42, *map.get(key).unwrap);
+    }
+
+    return 0;
+}
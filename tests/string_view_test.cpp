@@ -97,5 +97,17 @@ int main(int, char *[])
             ASSERT_EQ(""_sv, bar);
         }
     }
+    // String_View::operator<
+    {
+        ASSERT_EQ(true, "abc"_sv < "abd"_sv);
+        ASSERT_EQ(false, "abd"_sv < "abc"_sv);
+        ASSERT_EQ(true, "ab"_sv < "abc"_sv);
+        ASSERT_EQ(false, "abc"_sv < "ab"_sv);
+        ASSERT_EQ(false, "abc"_sv < "abc"_sv);
+        ASSERT_EQ(true, ""_sv < "a"_sv);
+        // Bytes are compared as unsigned, which is the code point order for UTF-8
+        ASSERT_EQ(true, "z"_sv < "я"_sv);
+        ASSERT_EQ(true, "я"_sv < "😂"_sv);
+    }
     return 0;
 }
@@ -0,0 +1,140 @@
+#define AIDS_THREADS
+#define AIDS_IMPLEMENTATION
+#include "../aids.hpp"
+
+using namespace aids;
+
+uint32_t random_state = 69;
+
+uint32_t random_u32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+void test_parallel_for(Thread_Pool pool, size_t count, size_t grain)
+{
+    std::atomic<uint32_t> *visits = static_cast<std::atomic<uint32_t>*>(
+                                        malloc(sizeof(std::atomic<uint32_t>) * count));
+    defer(free(visits));
+    for (size_t i = 0; i < count; ++i) {
+        visits[i].store(0);
+    }
+
+    parallel_for(pool, 0, count, grain, [&](size_t begin, size_t end) {
+        if (begin >= end || end - begin > grain) {
+            panic("ERROR: unexpected chunk [", begin, ", ", end, ") of grain ", grain);
+        }
+
+        for (size_t i = begin; i < end; ++i) {
+            visits[i].fetch_add(1);
+        }
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        if (visits[i].load() != 1) {
+            panic("ERROR: element ", i, " of ", count, " was visited ",
+                  visits[i].load(), " times with grain ", grain);
+        }
+    }
+}
+
+void test_parallel_reduce(Thread_Pool pool)
+{
+    const size_t N = 1000000;
+    unsigned long long sum = parallel_reduce(
+        pool, 0, N, 1000, 0ULL,
+        [](size_t begin, size_t end) {
+            unsigned long long sum = 0;
+            for (size_t i = begin; i < end; ++i) sum += i;
+            return sum;
+        },
+        [](unsigned long long a, unsigned long long b) {
+            return a + b;
+        });
+
+    if (sum != (unsigned long long) N * (N - 1) / 2) {
+        panic("ERROR: parallel_reduce() computed ", sum);
+    }
+}
+
+void test_nested(Thread_Pool pool)
+{
+    std::atomic<uint32_t> total = {0};
+    parallel_for(pool, 0, 64, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            parallel_for(pool, 0, 100, 10, [&](size_t b, size_t e) {
+                total.fetch_add((uint32_t) (e - b));
+            });
+        }
+    });
+
+    if (total.load() != 6400) {
+        panic("ERROR: nested parallel_for() visited ", total.load(), " elements");
+    }
+}
+
+void test_parallel_sort(Thread_Pool pool, size_t count)
+{
+    Dynamic_Array<uint32_t> actual = {};
+    defer(destroy(actual));
+    Dynamic_Array<uint32_t> expected = {};
+    defer(destroy(expected));
+
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t x = random_u32() % 1000;
+        actual.push(x);
+        expected.push(x);
+    }
+
+    parallel_sort(pool, &actual);
+    radix_sort(&expected);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (actual[i] != expected[i]) {
+            panic("ERROR: parallel_sort() of ", count, " elements differs at ", i);
+        }
+    }
+}
+
+int main(int, char *[])
+{
+    Thread_Pool serial = {};
+    Thread_Pool pools[] = {
+        thread_pool_of(1),
+        thread_pool_of(3),
+        thread_pool_of(max(hardware_threads_count(), (size_t) 2)),
+    };
+
+    for (Thread_Pool pool : pools) {
+        test_parallel_for(pool, 0, 1);
+        test_parallel_for(pool, 1, 1);
+        test_parallel_for(pool, 1000, 1);
+        test_parallel_for(pool, 100000, 7);
+        test_parallel_for(pool, 100000, 100000);
+
+        // NOTE: back to back runs exercise the wake up of the workers
+        for (int i = 0; i < 1000; ++i) {
+            test_parallel_for(pool, 100, 1);
+        }
+
+        test_parallel_reduce(pool);
+        test_nested(pool);
+        test_parallel_sort(pool, 1000);
+        test_parallel_sort(pool, 100000);
+        test_parallel_sort(pool, 1000003);
+    }
+
+    test_parallel_for(serial, 1000, 10);
+    test_parallel_reduce(serial);
+
+    for (Thread_Pool pool : pools) {
+        destroy(pool);
+    }
+
+    println(stdout, "OK.");
+
+    return 0;
+}
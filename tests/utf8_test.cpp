@@ -3,10 +3,76 @@
 
 using namespace aids;
 
+#define ASSERT_EQ(expected_expr, actual_expr)              \
+    do {                                                   \
+        const auto expected = (expected_expr);             \
+        const auto actual = (actual_expr);                 \
+        if (expected != actual) {                          \
+            println(stderr, __FILE__, ":", __LINE__,       \
+                    ": ASSERTION FAILED! ",                \
+                    #expected_expr, " == ", #actual_expr); \
+            println(stderr, "  Expected: ", expected);     \
+            println(stderr, "  Actual:   ", actual);       \
+            exit(1);                                       \
+        }                                                  \
+    } while(0)
+
+uint32_t random_state = 69;
+
+uint32_t random_u32()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+// NOTE: the reference validator that relies only on utf8_get_code()
+bool utf8_validate_by_codes(String_View view)
+{
+    while (view.count > 0) {
+        size_t size = 0;
+        if (!utf8_get_code(view, &size).has_value) {
+            return false;
+        }
+        view.chop_left(size);
+    }
+    return true;
+}
+
+void check_invalid(String_View view)
+{
+    size_t size = 0;
+    if (utf8_get_code(view, &size).has_value) {
+        panic("FAILED: utf8_get_code() accepted invalid sequence ", Hex_Bytes { view });
+    }
+
+    if (utf8_validate(view)) {
+        panic("FAILED: utf8_validate() accepted invalid sequence ", Hex_Bytes { view });
+    }
+}
+
+// NOTE: malloc(0) is allowed to return nullptr as well
+struct Empty_Is_Null_Ator {
+    template <typename T>
+    T *alloc(size_t count, T def = {})
+    {
+        return count == 0 ? nullptr : mtor.alloc<T>(count, def);
+    }
+
+    template <typename T>
+    void dealloc(T *ptr, size_t count)
+    {
+        mtor.dealloc(ptr, count);
+    }
+};
+
 int main(int, char *[])
 {
     const uint32_t UNICODE_LOW = 0x0000;
     const uint32_t UNICODE_HIGH = 0x10FFFF;
+    const uint32_t SURROGATES_LOW = 0xD800;
+    const uint32_t SURROGATES_HIGH = 0xDFFF;
 
     println(stdout, "Checking decoding/encoding of all code points within the range ",
             "[0x", HEX<uint32_t> { UNICODE_LOW }, "..0x", HEX<uint32_t> { UNICODE_HIGH }, "]...");
@@ -18,6 +84,11 @@ int main(int, char *[])
         auto uchar = code_to_utf8(expected_code);
         auto uchar_view = uchar.view();
 
+        if (SURROGATES_LOW <= expected_code && expected_code <= SURROGATES_HIGH) {
+            check_invalid(uchar_view);
+            continue;
+        }
+
         size_t size = 0;
         auto actual_code = unwrap_or_panic(
             utf8_get_code(uchar_view, &size),
@@ -36,6 +107,233 @@ int main(int, char *[])
                   "expected size of code ", HEX<uint32_t> { expected_code }, " ",
                   "to be ", uchar.count, ", but it was ", size, ".");
         }
+
+        if (!utf8_validate(uchar_view)) {
+            panic("FAILED: utf8_validate() rejected ", Hex_Bytes { uchar_view });
+        }
+    }
+
+    println(stdout, "OK.");
+
+    println(stdout, "Checking invalid UTF-8 sequences...");
+
+    check_invalid("\x80"_sv);                 // lone continuation byte
+    check_invalid("\xBF"_sv);                 // lone continuation byte
+    check_invalid("\xC0\xAF"_sv);             // overlong '/'
+    check_invalid("\xC1\xBF"_sv);             // overlong 2-byte
+    check_invalid("\xE0\x80\xAF"_sv);         // overlong 3-byte
+    check_invalid("\xE0\x9F\xBF"_sv);         // overlong 3-byte
+    check_invalid("\xF0\x80\x80\xAF"_sv);     // overlong 4-byte
+    check_invalid("\xF0\x8F\xBF\xBF"_sv);     // overlong 4-byte
+    check_invalid("\xED\xA0\x80"_sv);         // surrogate U+D800
+    check_invalid("\xED\xBF\xBF"_sv);         // surrogate U+DFFF
+    check_invalid("\xF4\x90\x80\x80"_sv);     // U+110000
+    check_invalid("\xF5\x80\x80\x80"_sv);     // invalid lead byte
+    check_invalid("\xFF"_sv);                 // invalid lead byte
+    check_invalid("\xC3"_sv);                 // truncated 2-byte
+    check_invalid("\xE2\x82"_sv);             // truncated 3-byte
+    check_invalid("\xF0\x9F\x98"_sv);         // truncated 4-byte
+    check_invalid("\xC3\x28"_sv);             // lead byte followed by ASCII
+    check_invalid("\xE2\x28\xA1"_sv);         // lead byte followed by ASCII
+
+    println(stdout, "OK.");
+
+    println(stdout, "Checking utf8_validate() against utf8_get_code() on random texts...");
+
+    const char *const fragments[] = {
+        "a", "Hello, World", "\n", "\xD0\x9F", "\xE3\x81\x93", "\xF0\x9F\x98\x82",
+        "\x80", "\xC3", "\xE2\x82", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xC0\xAF",
+    };
+    const size_t fragments_count = sizeof(fragments) / sizeof(fragments[0]);
+    // NOTE: the first 6 fragments are valid UTF-8 on their own
+    const size_t valid_fragments_count = 6;
+
+    char text[256];
+    for (int attempt = 0; attempt < 100000; ++attempt) {
+        size_t count = 0;
+        size_t target = random_u32() % (sizeof(text) - 16);
+        bool only_valid = random_u32() % 2 == 0;
+        while (count < target) {
+            const char *fragment = only_valid
+                                   ? fragments[random_u32() % valid_fragments_count]
+                                   : fragments[random_u32() % fragments_count];
+            size_t n = strlen(fragment);
+            memcpy(text + count, fragment, n);
+            count += n;
+        }
+
+        String_View view = {count, text};
+        bool expected = utf8_validate_by_codes(view);
+        if (only_valid && !expected) {
+            panic("FAILED: utf8_get_code() rejected valid text ", Hex_Bytes { view });
+        }
+        if (expected != utf8_validate(view)) {
+            panic("FAILED: utf8_validate() returned ", !expected, " for ", Hex_Bytes { view });
+        }
+    }
+
+    println(stdout, "OK.");
+
+    println(stdout, "Checking bulk transcoding of all code points...");
+
+    {
+        // NOTE: every code point is surrounded by ASCII runs of
+        // different lengths to exercise the ASCII fast paths
+        size_t codes_count = 0;
+        for (uint32_t code = UNICODE_LOW; code <= UNICODE_HIGH; ++code) {
+            if (SURROGATES_LOW <= code && code <= SURROGATES_HIGH) continue;
+            codes_count += 1 + code % 37;
+        }
+
+        uint32_t *codes = mtor.alloc<uint32_t>(codes_count);
+        defer(mtor.dealloc(codes, codes_count));
+        size_t k = 0;
+        for (uint32_t code = UNICODE_LOW; code <= UNICODE_HIGH; ++code) {
+            if (SURROGATES_LOW <= code && code <= SURROGATES_HIGH) continue;
+            codes[k++] = code;
+            for (uint32_t j = 0; j < code % 37; ++j) {
+                codes[k++] = 'a' + j % 26;
+            }
+        }
+
+        String_View utf8 = unwrap_or_panic(utf32_as_utf8(codes, codes_count),
+                                           "FAILED: could not convert UTF-32 to UTF-8");
+        defer(destroy(utf8));
+
+        if (!utf8_validate(utf8)) {
+            panic("FAILED: utf32_as_utf8() produced invalid UTF-8");
+        }
+
+        if (utf8_length_as_utf32(utf8) != codes_count) {
+            panic("FAILED: utf8_length_as_utf32() is ", utf8_length_as_utf32(utf8), " instead of ", codes_count);
+        }
+
+        size_t utf32_count = 0;
+        uint32_t *utf32 = unwrap_or_panic(utf8_as_utf32(utf8, &utf32_count),
+                                          "FAILED: could not convert UTF-8 to UTF-32");
+        defer(mtor.dealloc(utf32, utf32_count));
+
+        if (utf32_count != codes_count || memcmp(utf32, codes, codes_count * sizeof(uint32_t)) != 0) {
+            panic("FAILED: UTF-32 -> UTF-8 -> UTF-32 is not an identity");
+        }
+
+        size_t utf16_count = 0;
+        uint16_t *utf16 = unwrap_or_panic(utf8_as_utf16(utf8, &utf16_count),
+                                          "FAILED: could not convert UTF-8 to UTF-16");
+        defer(mtor.dealloc(utf16, utf16_count));
+
+        if (utf16_count != utf8_length_as_utf16(utf8)) {
+            panic("FAILED: utf8_length_as_utf16() is ", utf8_length_as_utf16(utf8), " instead of ", utf16_count);
+        }
+
+        if (utf16_length_as_utf8(utf16, utf16_count) != utf8.count) {
+            panic("FAILED: utf16_length_as_utf8() is ", utf16_length_as_utf8(utf16, utf16_count), " instead of ", utf8.count);
+        }
+
+        String_View back = unwrap_or_panic(utf16_as_utf8(utf16, utf16_count),
+                                           "FAILED: could not convert UTF-16 to UTF-8");
+        defer(destroy(back));
+
+        if (back != utf8) {
+            panic("FAILED: UTF-8 -> UTF-16 -> UTF-8 is not an identity");
+        }
+    }
+
+    {
+        char output[16];
+        const uint32_t surrogate[] = {'a', 0xD800};
+        const uint32_t too_big[] = {0x110000};
+        const uint16_t unpaired_high[] = {'a', 0xD800, 'b'};
+        const uint16_t unpaired_low[] = {0xDC00};
+
+        if (utf32_to_utf8(surrogate, 2, output).has_value) {
+            panic("FAILED: utf32_to_utf8() accepted a surrogate");
+        }
+        if (utf32_to_utf8(too_big, 1, output).has_value) {
+            panic("FAILED: utf32_to_utf8() accepted a code above 0x10FFFF");
+        }
+        if (utf16_to_utf8(unpaired_high, 3, output).has_value) {
+            panic("FAILED: utf16_to_utf8() accepted an unpaired high surrogate");
+        }
+        if (utf16_to_utf8(unpaired_low, 1, output).has_value) {
+            panic("FAILED: utf16_to_utf8() accepted an unpaired low surrogate");
+        }
+
+        uint32_t codes[16];
+        if (utf8_to_utf32("abc\xE2\x82"_sv, codes).has_value) {
+            panic("FAILED: utf8_to_utf32() accepted a truncated sequence");
+        }
+
+        size_t count = 69;
+        Empty_Is_Null_Ator ator = {};
+        if (!utf8_as_utf32(""_sv, &count, &ator).has_value || count != 0 ||
+            !utf8_as_utf16(""_sv, &count, &ator).has_value || count != 0 ||
+            !utf32_as_utf8(codes, 0, &ator).has_value ||
+            !utf16_as_utf8(nullptr, 0, &ator).has_value) {
+            panic("FAILED: an empty input is expected to be converted into an empty output");
+        }
+        if (utf8_as_utf32("abc\xE2\x82"_sv, &count, &ator).has_value) {
+            panic("FAILED: utf8_as_utf32() accepted a truncated sequence");
+        }
+    }
+
+    println(stdout, "OK.");
+
+    println(stdout, "Checking code point operations on String_View...");
+
+    {
+        String_View text = "Привет, 世界! 😂"_sv;
+        ASSERT_EQ((size_t) 13, utf8_length(text));
+        ASSERT_EQ("世界"_sv, utf8_subview(text, 8, 2));
+        ASSERT_EQ("Привет"_sv, utf8_chop_left(&text, 6));
+        ASSERT_EQ("😂"_sv, utf8_chop_right(&text, 1));
+        ASSERT_EQ(", 世界! "_sv, text);
+        ASSERT_EQ(", 世界! "_sv, utf8_chop_left(&text, 69));
+        ASSERT_EQ(""_sv, text);
+
+        // NOTE: the bytes of the ill-formed sequences count as
+        // separate code points
+        String_View broken = "a\x80\xE2\x82" "b"_sv;
+        ASSERT_EQ("b"_sv, utf8_chop_right(&broken, 1));
+        ASSERT_EQ("\x82"_sv, utf8_chop_right(&broken, 1));
+        ASSERT_EQ("a\x80"_sv, utf8_chop_left(&broken, 2));
+        ASSERT_EQ("\xE2"_sv, broken);
+    }
+
+    println(stdout, "OK.");
+
+    println(stdout, "Checking case mapping...");
+
+    {
+        ASSERT_EQ((uint32_t) 'A', unicode_to_upper('a'));
+        ASSERT_EQ((uint32_t) 0x041F, unicode_to_upper(0x043F)); // п -> П
+        ASSERT_EQ((uint32_t) 0x0178, unicode_to_upper(0x00FF)); // ÿ -> Ÿ
+        ASSERT_EQ((uint32_t) 0x2C6F, unicode_to_upper(0x0250)); // ɐ -> Ɐ
+        ASSERT_EQ((uint32_t) 0x00DF, unicode_to_upper(0x00DF)); // ß has no simple uppercase
+        ASSERT_EQ((uint32_t) 0x0101 - 1, unicode_to_upper(0x0101)); // ā -> Ā
+        ASSERT_EQ((uint32_t) 'k', unicode_fold_case(0x212A));   // Kelvin sign
+        ASSERT_EQ((uint32_t) 0x03C3, unicode_fold_case(0x03A3)); // Σ -> σ
+        ASSERT_EQ((uint32_t) 0x03C3, unicode_fold_case(0x03C2)); // ς -> σ
+        ASSERT_EQ((uint32_t) 0x4E16, unicode_fold_case(0x4E16)); // 世
+
+        String_View text = "The quick brown fox: Съешь же ещё этих мягких французских булок! ɐ"_sv;
+        String_View upper = unwrap_or_panic(utf8_as_upper(text), "FAILED: could not uppercase");
+        defer(destroy(upper));
+        ASSERT_EQ("THE QUICK BROWN FOX: СЪЕШЬ ЖЕ ЕЩЁ ЭТИХ МЯГКИХ ФРАНЦУЗСКИХ БУЛОК! Ɐ"_sv, upper);
+
+        String_View folded = unwrap_or_panic(utf8_as_folded(upper), "FAILED: could not fold");
+        defer(destroy(folded));
+        ASSERT_EQ("the quick brown fox: съешь же ещё этих мягких французских булок! ɐ"_sv, folded);
+
+        char output[16];
+        if (utf8_to_upper("abc\xE2\x82"_sv, output).has_value) {
+            panic("FAILED: utf8_to_upper() accepted a truncated sequence");
+        }
+
+        char buffer[256];
+        String_Buffer sbuffer = {sizeof(buffer), buffer, 0};
+        sprint(&sbuffer, Caps { "Привет, World!"_sv });
+        ASSERT_EQ("ПРИВЕТ, WORLD!"_sv, sbuffer.view());
     }
 
     println(stdout, "OK.");